@@ -70,26 +70,120 @@ constexpr OutIt copy_n_small(InIt first, Diff count, OutIt dest)
     return dest;
 }
 
+#pragma warning(push)
+#pragma warning(disable : 26429) // Symbol '...' is never tested for nullness, it can be marked as not_null (f.23).
+#pragma warning(disable : 26472) // Don't use a static_cast for arithmetic conversions. Use brace initialization, gsl::narrow_cast or gsl::narrow (type.1).
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+
+// Fills `charOffsets` with the successive offsets `ch`, `ch + 1`, ... for as long as `chars` is ASCII.
+// Returns the number of leading ASCII characters in `chars`, which is also the number of offsets written.
+// This is the fast path of ROW::WriteHelper::ReplaceText, as ASCII is always 1 column per character.
+static size_t replaceCharOffsetsASCII(const wchar_t* chars, uint16_t* charOffsets, const size_t count, const size_t ch) noexcept
+{
+    size_t i = 0;
+
+#if defined(TIL_SSE_INTRINSICS)
+    alignas(__m256i) static constexpr uint16_t offsetsData[]{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+
+    // A character is non-ASCII if any of the bits in 0xff80 are set.
+    if (__isa_available >= __ISA_AVAILABLE_AVX2 && count >= 16)
+    {
+        const auto nonASCII = _mm256_set1_epi16(static_cast<short>(0xff80));
+        const auto increment = _mm256_set1_epi16(16);
+        auto offsets = _mm256_add_epi16(_mm256_load_si256(reinterpret_cast<const __m256i*>(&offsetsData[0])), _mm256_set1_epi16(static_cast<short>(ch)));
+
+        for (const auto end = count & ~size_t{ 15 }; i < end; i += 16)
+        {
+            const auto wch = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(chars + i));
+            // testz returns 1 if (wch & nonASCII) == 0, i.e. if all 16 characters are ASCII.
+            if (!_mm256_testz_si256(wch, nonASCII))
+            {
+                break;
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(charOffsets + i), offsets);
+            offsets = _mm256_add_epi16(offsets, increment);
+        }
+    }
+
+    // This processes the 8-character remainder of the AVX2 loop, or everything if AVX2 isn't available.
+    {
+        const auto nonASCII = _mm_set1_epi16(static_cast<short>(0xff80));
+        const auto increment = _mm_set1_epi16(8);
+        const auto z = _mm_setzero_si128();
+        auto offsets = _mm_add_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(&offsetsData[0])), _mm_set1_epi16(static_cast<short>(ch + i)));
+
+        for (const auto end = count & ~size_t{ 7 }; i < end; i += 8)
+        {
+            const auto wch = _mm_loadu_si128(reinterpret_cast<const __m128i*>(chars + i));
+            const auto ascii = _mm_cmpeq_epi16(_mm_and_si128(wch, nonASCII), z);
+            if (_mm_movemask_epi8(ascii) != 0xffff)
+            {
+                break;
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(charOffsets + i), offsets);
+            offsets = _mm_add_epi16(offsets, increment);
+        }
+    }
+#elif defined(TIL_ARM_NEON_INTRINSICS)
+    alignas(uint16x8_t) static constexpr uint16_t offsetsData[]{ 0, 1, 2, 3, 4, 5, 6, 7 };
+
+    const auto increment = vdupq_n_u16(8);
+    auto offsets = vaddq_u16(vld1q_u16(&offsetsData[0]), vdupq_n_u16(static_cast<uint16_t>(ch)));
+
+    for (const auto end = count & ~size_t{ 7 }; i < end; i += 8)
+    {
+        const auto wch = vld1q_u16(chars + i);
+        if (vmaxvq_u16(wch) >= 0x80)
+        {
+            break;
+        }
+        vst1q_u16(charOffsets + i, offsets);
+        offsets = vaddq_u16(offsets, increment);
+    }
+#endif
+
+#pragma loop(no_vector)
+    for (; i < count && chars[i] < 0x80; ++i)
+    {
+        charOffsets[i] = static_cast<uint16_t>(ch + i);
+    }
+
+    return i;
+}
+
+#pragma warning(pop)
+
 // Routine Description:
 // - constructor
 // Arguments:
 // - rowWidth - the width of the row, cell elements
 // - fillAttribute - the default text attribute
+// - hyperlinkRefCounts - the table that tracks the hyperlink references of this row (optional)
 // Return Value:
 // - constructed object
-ROW::ROW(wchar_t* charsBuffer, uint16_t* charOffsetsBuffer, uint16_t rowWidth, const TextAttribute& fillAttribute) :
+ROW::ROW(wchar_t* charsBuffer, uint16_t* charOffsetsBuffer, uint16_t rowWidth, const TextAttribute& fillAttribute, HyperlinkRefCounts* hyperlinkRefCounts) :
     _charsBuffer{ charsBuffer },
     _chars{ charsBuffer, rowWidth },
     _charOffsets{ charOffsetsBuffer, ::base::strict_cast<size_t>(rowWidth) + 1u },
     _attr{ rowWidth, fillAttribute },
+    _hyperlinkRefCounts{ hyperlinkRefCounts },
     _columnCount{ rowWidth }
 {
     _init();
+    if (fillAttribute.IsHyperlink())
+    {
+        _acquireHyperlinks();
+    }
 }
 
 void ROW::SetWrapForced(const bool wrap) noexcept
 {
-    _wrapForced = wrap;
+    if (_wrapForced != wrap)
+    {
+        _wrapForced = wrap;
+        _textGeneration.bump();
+    }
 }
 
 bool ROW::WasWrapForced() const noexcept
@@ -123,6 +217,11 @@ uint16_t ROW::GetLineWidth() const noexcept
     return _columnCount >> scale;
 }
 
+til::generation_t ROW::GetTextGeneration() const noexcept
+{
+    return _textGeneration;
+}
+
 // Routine Description:
 // - Sets all properties of the ROW to default values
 // Arguments:
@@ -131,6 +230,7 @@ uint16_t ROW::GetLineWidth() const noexcept
 // - <none>
 void ROW::Reset(const TextAttribute& attr) noexcept
 {
+    _releaseHyperlinks();
     _charsHeap.reset();
     _chars = { _charsBuffer, _columnCount };
     // Constructing and then moving objects into place isn't free.
@@ -140,10 +240,60 @@ void ROW::Reset(const TextAttribute& attr) noexcept
     _wrapForced = false;
     _doubleBytePadded = false;
     _init();
+    if (attr.IsHyperlink())
+    {
+        _acquireHyperlinks();
+    }
+}
+
+// Adds a reference to _hyperlinkRefCounts for each run in _attr that has a hyperlink ID.
+// Must only be called when the current runs aren't referenced yet (i.e. after _releaseHyperlinks()).
+void ROW::_acquireHyperlinks() noexcept
+try
+{
+    if (!_hyperlinkRefCounts)
+    {
+        return;
+    }
+
+    for (const auto& run : _attr.runs())
+    {
+        if (run.value.IsHyperlink())
+        {
+            ++(*_hyperlinkRefCounts)[run.value.GetHyperlinkId()];
+            _hasHyperlinks = true;
+        }
+    }
+}
+CATCH_LOG()
+
+// Removes the references added by _acquireHyperlinks(). Call this before modifying _attr.
+void ROW::_releaseHyperlinks() noexcept
+{
+    if (!_hasHyperlinks)
+    {
+        return;
+    }
+
+    _hasHyperlinks = false;
+
+    for (const auto& run : _attr.runs())
+    {
+        if (run.value.IsHyperlink())
+        {
+            const auto it = _hyperlinkRefCounts->find(run.value.GetHyperlinkId());
+            if (it != _hyperlinkRefCounts->end() && --it->second == 0)
+            {
+                _hyperlinkRefCounts->erase(it);
+            }
+        }
+    }
 }
 
 void ROW::_init() noexcept
 {
+    _textGeneration.bump();
+
 #pragma warning(push)
 #pragma warning(disable : 26462) // The value pointed to by '...' is assigned only once, mark it as a pointer to const (con.4).
 #pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
@@ -259,6 +409,8 @@ void ROW::_init() noexcept
 
 void ROW::TransferAttributes(const til::small_rle<TextAttribute, uint16_t, 1>& attr, til::CoordType newWidth)
 {
+    _releaseHyperlinks();
+    auto acquire = wil::scope_exit([&]() { _acquireHyperlinks(); });
     _attr = attr;
     _attr.resize_trailing_extent(gsl::narrow<uint16_t>(newWidth));
 }
@@ -270,6 +422,7 @@ void ROW::CopyFrom(const ROW& source)
     TransferAttributes(source.Attributes(), _columnCount);
     _lineRendition = source._lineRendition;
     _wrapForced = source._wrapForced;
+    _textGeneration.bump();
 }
 
 // Returns the previous possible cursor position, preceding the given column.
@@ -335,6 +488,16 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const til::CoordType c
     // If we're given a right-side column limit, use it. Otherwise, the write limit is the final column index available in the char row.
     const auto finalColumnInRow = limitRight.value_or(size() - 1);
 
+    // The cells may carry arbitrary attributes, so we simply recount all runs afterwards if needed.
+    auto hyperlinks = _hasHyperlinks;
+    _releaseHyperlinks();
+    auto acquire = wil::scope_exit([&]() {
+        if (hyperlinks)
+        {
+            _acquireHyperlinks();
+        }
+    });
+
     auto currentColor = it->TextAttr();
     uint16_t colorUses = 0;
     auto colorStarts = gsl::narrow_cast<uint16_t>(columnBegin);
@@ -356,6 +519,7 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const til::CoordType c
                 // Otherwise, commit this color into the run and save off the new one.
                 // Now commit the new color runs into the attr row.
                 _attr.replace(colorStarts, currentIndex, currentColor);
+                hyperlinks |= currentColor.IsHyperlink();
                 currentColor = it->TextAttr();
                 colorUses = 1;
                 colorStarts = currentIndex;
@@ -436,6 +600,7 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const til::CoordType c
     if (colorUses)
     {
         _attr.replace(colorStarts, currentIndex, currentColor);
+        hyperlinks |= currentColor.IsHyperlink();
     }
 
     return it;
@@ -443,14 +608,43 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const til::CoordType c
 
 void ROW::SetAttrToEnd(const til::CoordType columnBegin, const TextAttribute attr)
 {
-    _attr.replace(_clampedColumnInclusive(columnBegin), _attr.size(), attr);
+    ReplaceAttributes(columnBegin, _attr.size(), attr);
 }
 
 void ROW::ReplaceAttributes(const til::CoordType beginIndex, const til::CoordType endIndex, const TextAttribute& newAttr)
 {
+    if (!_hasHyperlinks && !newAttr.IsHyperlink()) [[likely]]
+    {
+        _attr.replace(_clampedColumnInclusive(beginIndex), _clampedColumnInclusive(endIndex), newAttr);
+        return;
+    }
+
+    _releaseHyperlinks();
+    auto acquire = wil::scope_exit([&]() { _acquireHyperlinks(); });
     _attr.replace(_clampedColumnInclusive(beginIndex), _clampedColumnInclusive(endIndex), newAttr);
 }
 
+// Replaces the attributes in the range [beginIndex, endIndex) with the given runs,
+// which are usually a slice() of another row's Attributes(). The caller needs to ensure that
+// newAttrs.size() matches the length of the range, as the row would otherwise change its width.
+void ROW::ReplaceAttributes(const til::CoordType beginIndex, const til::CoordType endIndex, const til::small_rle<TextAttribute, uint16_t, 1>& newAttrs)
+{
+    const auto begin = _clampedColumnInclusive(beginIndex);
+    const auto end = _clampedColumnInclusive(endIndex);
+    assert(newAttrs.size() == end - begin);
+
+    const auto& runs = newAttrs.runs();
+    if (!_hasHyperlinks && std::none_of(runs.begin(), runs.end(), [](const auto& run) { return run.value.IsHyperlink(); })) [[likely]]
+    {
+        _attr.replace(begin, end, newAttrs);
+        return;
+    }
+
+    _releaseHyperlinks();
+    auto acquire = wil::scope_exit([&]() { _acquireHyperlinks(); });
+    _attr.replace(begin, end, newAttrs);
+}
+
 [[msvc::forceinline]] ROW::WriteHelper::WriteHelper(ROW& row, til::CoordType columnBegin, til::CoordType columnLimit, const std::wstring_view& chars) noexcept :
     row{ row },
     chars{ chars }
@@ -548,22 +742,16 @@ catch (...)
     //
     // We can infer the "end" from the amount of columns we're given (colLimit - colBeg),
     // because ASCII is always 1 column wide per character.
-    auto it = chars.begin();
-    const auto end = it + std::min<size_t>(chars.size(), colLimit - colBeg);
-    size_t ch = chBeg;
+    const auto count = std::min<size_t>(chars.size(), colLimit - colBeg);
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+    const auto ascii = replaceCharOffsetsASCII(chars.data(), row._charOffsets.data() + colEnd, count, chBeg);
+    const auto ch = chBeg + ascii;
+    colEnd = gsl::narrow_cast<uint16_t>(colEnd + ascii);
 
-    while (it != end)
+    if (ascii != count) [[unlikely]]
     {
-        if (*it >= 0x80) [[unlikely]]
-        {
-            _replaceTextUnicode(ch, it);
-            return;
-        }
-
-        til::at(row._charOffsets, colEnd) = gsl::narrow_cast<uint16_t>(ch);
-        ++colEnd;
-        ++ch;
-        ++it;
+        _replaceTextUnicode(ch, chars.begin() + ascii);
+        return;
     }
 
     colEndDirty = colEnd;
@@ -727,6 +915,8 @@ catch (...)
 
 [[msvc::forceinline]] void ROW::WriteHelper::Finish()
 {
+    row._textGeneration.bump();
+
     colEndDirty = row._adjustForward(colEndDirty);
 
     const uint16_t trailingSpaces = colEndDirty - colEnd;
@@ -807,11 +997,6 @@ void ROW::_resizeChars(uint16_t colEndDirty, uint16_t chBegDirty, size_t chEndDi
     }
 }
 
-til::small_rle<TextAttribute, uint16_t, 1>& ROW::Attributes() noexcept
-{
-    return _attr;
-}
-
 const til::small_rle<TextAttribute, uint16_t, 1>& ROW::Attributes() const noexcept
 {
     return _attr;
@@ -947,6 +1132,13 @@ std::wstring_view ROW::GetText() const noexcept
     return { _chars.data(), _charSize() };
 }
 
+// Returns the offset into GetText() of the glyph in each column, followed by the length of the text.
+// The offsets of the trailing halves of wide glyphs are those of their leading halves, with CharOffsetsTrailer set.
+std::span<const uint16_t> ROW::CharOffsets() const noexcept
+{
+    return _charOffsets;
+}
+
 std::wstring_view ROW::GetText(til::CoordType columnBegin, til::CoordType columnEnd) const noexcept
 {
     const til::CoordType columns = _columnCount;
@@ -958,6 +1150,28 @@ std::wstring_view ROW::GetText(til::CoordType columnBegin, til::CoordType column
     return { _chars.data() + chBeg, chEnd - chBeg };
 }
 
+// Returns the first column of the glyph that contains the character at the given offset into GetText().
+til::CoordType ROW::GetLeadingColumnAtCharOffset(const ptrdiff_t offset) const noexcept
+{
+    const auto off = gsl::narrow_cast<uint16_t>(std::clamp<ptrdiff_t>(offset, 0, _charSize()));
+    const auto beg = _charOffsets.begin();
+    // The masked char offsets are sorted, with trailers sharing the offset of their leading column.
+    // --> Find the first column past the offset and step back to the leading column of the glyph before it.
+    const auto it = std::upper_bound(beg, beg + _columnCount, off, [](const uint16_t value, const uint16_t element) {
+        return value < (element & CharOffsetsMask);
+    });
+    const auto column = gsl::narrow_cast<uint16_t>(std::max<ptrdiff_t>(0, it - beg - 1));
+    return _adjustBackward(column);
+}
+
+// Returns the last column of the glyph that contains the character at the given offset into GetText().
+// For wide glyphs this is the column of their trailing half.
+til::CoordType ROW::GetTrailingColumnAtCharOffset(const ptrdiff_t offset) const noexcept
+{
+    const auto column = gsl::narrow_cast<uint16_t>(GetLeadingColumnAtCharOffset(offset));
+    return _adjustForward(column + 1) - 1;
+}
+
 DelimiterClass ROW::DelimiterClassAt(til::CoordType column, const std::wstring_view& wordDelimiters) const noexcept
 {
     const auto col = _clampedColumn(column);
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <til/generational.h>
 #include <til/rle.h>
 
 #include "LineRendition.hpp"
@@ -12,6 +13,10 @@
 class ROW;
 class TextBuffer;
 
+// Maps hyperlink IDs to the number of attribute runs referencing them across all ROWs of a TextBuffer.
+// TextBuffer uses this to tell whether a hyperlink is still in use, without having to scan the entire buffer.
+using HyperlinkRefCounts = std::unordered_map<uint16_t, uint32_t>;
+
 enum class DelimiterClass
 {
     ControlChar,
@@ -68,6 +73,12 @@ struct RowCopyTextFromState
 class ROW final
 {
 public:
+    // To simplify the detection of wide glyphs, we don't just store the simple character offset as described
+    // for _charOffsets. Instead we use the most significant bit to indicate whether any column is the
+    // trailing half of a wide glyph. This simplifies many implementation details via _uncheckedIsTrailer.
+    static constexpr uint16_t CharOffsetsTrailer = 0x8000;
+    static constexpr uint16_t CharOffsetsMask = 0x7fff;
+
     // The implicit agreement between ROW and TextBuffer is that the `charsBuffer` and `charOffsetsBuffer`
     // arrays have a minimum alignment of 16 Bytes and a size of `rowWidth+1`. The former is used to
     // implement Reset() efficiently via SIMD and the latter is used to store the past-the-end offset
@@ -92,7 +103,7 @@ public:
     }
 
     ROW() = default;
-    ROW(wchar_t* charsBuffer, uint16_t* charOffsetsBuffer, uint16_t rowWidth, const TextAttribute& fillAttribute);
+    ROW(wchar_t* charsBuffer, uint16_t* charOffsetsBuffer, uint16_t rowWidth, const TextAttribute& fillAttribute, HyperlinkRefCounts* hyperlinkRefCounts = nullptr);
 
     ROW(const ROW& other) = delete;
     ROW& operator=(const ROW& other) = delete;
@@ -107,6 +118,7 @@ public:
     void SetLineRendition(const LineRendition lineRendition) noexcept;
     LineRendition GetLineRendition() const noexcept;
     uint16_t GetLineWidth() const noexcept;
+    til::generation_t GetTextGeneration() const noexcept;
 
     void Reset(const TextAttribute& attr) noexcept;
     void TransferAttributes(const til::small_rle<TextAttribute, uint16_t, 1>& attr, til::CoordType newWidth);
@@ -119,11 +131,11 @@ public:
     OutputCellIterator WriteCells(OutputCellIterator it, til::CoordType columnBegin, std::optional<bool> wrap = std::nullopt, std::optional<til::CoordType> limitRight = std::nullopt);
     void SetAttrToEnd(til::CoordType columnBegin, TextAttribute attr);
     void ReplaceAttributes(til::CoordType beginIndex, til::CoordType endIndex, const TextAttribute& newAttr);
+    void ReplaceAttributes(til::CoordType beginIndex, til::CoordType endIndex, const til::small_rle<TextAttribute, uint16_t, 1>& newAttrs);
     void ReplaceCharacters(til::CoordType columnBegin, til::CoordType width, const std::wstring_view& chars);
     void ReplaceText(RowWriteState& state);
     void CopyTextFrom(RowCopyTextFromState& state);
 
-    til::small_rle<TextAttribute, uint16_t, 1>& Attributes() noexcept;
     const til::small_rle<TextAttribute, uint16_t, 1>& Attributes() const noexcept;
     TextAttribute GetAttrByColumn(til::CoordType column) const;
     std::vector<uint16_t> GetHyperlinks() const;
@@ -136,6 +148,9 @@ public:
     DbcsAttribute DbcsAttrAt(til::CoordType column) const noexcept;
     std::wstring_view GetText() const noexcept;
     std::wstring_view GetText(til::CoordType columnBegin, til::CoordType columnEnd) const noexcept;
+    std::span<const uint16_t> CharOffsets() const noexcept;
+    til::CoordType GetLeadingColumnAtCharOffset(ptrdiff_t offset) const noexcept;
+    til::CoordType GetTrailingColumnAtCharOffset(ptrdiff_t offset) const noexcept;
     DelimiterClass DelimiterClassAt(til::CoordType column, const std::wstring_view& wordDelimiters) const noexcept;
 
     auto AttrBegin() const noexcept { return _attr.begin(); }
@@ -193,12 +208,6 @@ private:
         size_t charsConsumed;
     };
 
-    // To simplify the detection of wide glyphs, we don't just store the simple character offset as described
-    // for _charOffsets. Instead we use the most significant bit to indicate whether any column is the
-    // trailing half of a wide glyph. This simplifies many implementation details via _uncheckedIsTrailer.
-    static constexpr uint16_t CharOffsetsTrailer = 0x8000;
-    static constexpr uint16_t CharOffsetsMask = 0x7fff;
-
     template<typename T>
     static constexpr uint16_t _clampedUint16(T v) noexcept;
     template<typename T>
@@ -215,6 +224,8 @@ private:
     bool _uncheckedIsTrailer(size_t col) const noexcept;
 
     void _init() noexcept;
+    void _acquireHyperlinks() noexcept;
+    void _releaseHyperlinks() noexcept;
     void _resizeChars(uint16_t colEndDirty, uint16_t chBegDirty, size_t chEndDirty, uint16_t chEndDirtyOld);
 
     // These fields are a bit "wasteful", but it makes all this a bit more robust against
@@ -260,6 +271,14 @@ private:
     // _attr is a run-length-encoded vector of TextAttribute with a decompressed
     // length equal to _columnCount (= 1 TextAttribute per column).
     til::small_rle<TextAttribute, uint16_t, 1> _attr;
+    // The hyperlink reference counts of the TextBuffer this ROW belongs to. Every run in _attr with
+    // a hyperlink ID holds 1 reference, which is why all modifications of _attr need to be bracketed
+    // by _releaseHyperlinks() and _acquireHyperlinks(). This is nullptr for the scratchpad row.
+    HyperlinkRefCounts* _hyperlinkRefCounts = nullptr;
+    // Bumped whenever the text or the wrap flag of this row changes. It's never reset, which allows
+    // TextBuffer to cache results derived from the row's text (like pattern matches) for as long
+    // as the ROW object lives. Attribute-only changes don't affect it.
+    til::generation_t _textGeneration;
     // The width of the row in visual columns.
     uint16_t _columnCount = 0;
     // Stores double-width/height (DECSWL/DECDWL/DECDHL) attributes.
@@ -268,6 +287,9 @@ private:
     bool _wrapForced = false;
     // Occurs when the user runs out of text to support a double byte character and we're forced to the next line
     bool _doubleBytePadded = false;
+    // True if _attr currently holds references in _hyperlinkRefCounts.
+    // This allows us to skip the reference counting for the vast majority of rows.
+    bool _hasHyperlinks = false;
 };
 
 #ifdef UNIT_TESTING
@@ -5,12 +5,7 @@
 
 #include "search.h"
 
-#include <til/unicode.h>
-
 #include "textBuffer.hpp"
-#include "../types/inc/GlyphWidth.hpp"
-
-using namespace Microsoft::Console::Types;
 
 // Routine Description:
 // - Constructs a Search object.
@@ -22,23 +17,21 @@ using namespace Microsoft::Console::Types;
 // - str - The search term you want to find (the "needle")
 // - direction - The direction to search (upward or downward)
 // - sensitivity - Whether or not you care about case
+// - mode - Whether str is a literal string or a regular expression
 Search::Search(Microsoft::Console::Render::IRenderData& renderData,
                const std::wstring_view str,
                const Direction direction,
-               const Sensitivity sensitivity) :
-    _direction(direction),
-    _sensitivity(sensitivity),
-    _needle(s_CreateNeedleFromString(str)),
-    _renderData(renderData),
-    _coordAnchor(s_GetInitialAnchor(renderData, direction))
+               const Sensitivity sensitivity,
+               const Mode mode) :
+    Search(renderData, str, direction, sensitivity, s_GetInitialAnchor(renderData, direction), mode)
 {
-    _coordNext = _coordAnchor;
 }
 
 // Routine Description:
 // - Constructs a Search object.
 // - Make a Search object then call .FindNext() to locate items.
 // - Once you've found something, you can perform actions like .Select() or .Color()
+// - All matches are located up front by TextBuffer::SearchText(), in a single pass over the buffer.
 // Arguments:
 // - textBuffer - The screen text buffer to search through (the "haystack")
 // - renderData - The IRenderData type reference, it is for providing selection methods
@@ -46,18 +39,53 @@ Search::Search(Microsoft::Console::Render::IRenderData& renderData,
 // - direction - The direction to search (upward or downward)
 // - sensitivity - Whether or not you care about case
 // - anchor - starting search location in screenInfo
+// - mode - Whether str is a literal string or a regular expression
 Search::Search(Microsoft::Console::Render::IRenderData& renderData,
                const std::wstring_view str,
                const Direction direction,
                const Sensitivity sensitivity,
-               const til::point anchor) :
+               const til::point anchor,
+               const Mode mode) :
     _direction(direction),
     _sensitivity(sensitivity),
-    _needle(s_CreateNeedleFromString(str)),
+    _mode(mode),
+    _needle(str),
     _coordAnchor(anchor),
     _renderData(renderData)
 {
-    _coordNext = _coordAnchor;
+    const auto& textBuffer = renderData.GetTextBuffer();
+    const auto rowEnd = renderData.GetTextBufferEndPosition().y + 1;
+
+    if (_mode == Mode::RegularExpression)
+    {
+        // The pattern is compiled once and then used for the entire buffer.
+        // A pattern that is invalid, or that exceeds the complexity or stack limits of
+        // std::regex while matching, doesn't match anything. Callers can tell that apart
+        // from an ordinary search without results via IsPatternValid().
+        auto flags = std::regex_constants::ECMAScript | std::regex_constants::optimize;
+        if (_sensitivity == Sensitivity::CaseInsensitive)
+        {
+            flags |= std::regex_constants::icase;
+        }
+
+        try
+        {
+            const std::wregex regex{ _needle, flags };
+            _results = textBuffer.SearchRegex(regex, 0, rowEnd);
+        }
+        catch (const std::regex_error&)
+        {
+            _results.clear();
+            _patternValid = false;
+        }
+    }
+    else
+    {
+        _results = textBuffer.SearchText(_needle, _sensitivity == Sensitivity::CaseInsensitive, 0, rowEnd);
+    }
+
+    _textBuffer = &textBuffer;
+    _lastMutationId = textBuffer.GetLastMutationId();
 }
 
 // Routine Description
@@ -69,28 +97,56 @@ Search::Search(Microsoft::Console::Render::IRenderData& renderData,
 // - NOTE: You can FindNext() again after False to go around the buffer again.
 bool Search::FindNext()
 {
-    if (_reachedEnd)
+    if (_results.empty())
     {
-        _reachedEnd = false;
         return false;
     }
 
-    do
+    if (_visited == _results.size())
     {
-        if (_FindNeedleInHaystackAt(_coordNext, _coordSelStart, _coordSelEnd))
-        {
-            _UpdateNextPosition();
-            _reachedEnd = _coordNext == _coordAnchor;
-            return true;
-        }
-        else
-        {
-            _UpdateNextPosition();
-        }
+        _visited = 0;
+        _index = -1;
+        return false;
+    }
 
-    } while (_coordNext != _coordAnchor);
+    MoveToNextResult(_direction);
+    _visited++;
+    return true;
+}
+
+// Routine Description
+// - Moves to the next (or previous) search result, wrapping around at either end of the buffer.
+// - Unlike FindNext() this never reports that the end of the buffer has been reached,
+//   which makes it suitable for repeatedly stepping through the results of a single search.
+// Arguments:
+// - direction - The direction to move into
+// Return Value:
+// - True if there is any result to move to. False if the search didn't find anything.
+bool Search::MoveToNextResult(const Direction direction)
+{
+    if (_results.empty())
+    {
+        return false;
+    }
+
+    const auto count = gsl::narrow_cast<ptrdiff_t>(_results.size());
+    auto index = _index;
+
+    if (index < 0)
+    {
+        index = _GetInitialResultIndex();
+    }
+    else if (direction == Direction::Forward)
+    {
+        index = (index + 1) % count;
+    }
+    else
+    {
+        index = (index + count - 1) % count;
+    }
 
-    return false;
+    _SetCurrentResult(index);
+    return true;
 }
 
 // Routine Description:
@@ -128,6 +184,88 @@ std::pair<til::point, til::point> Search::GetFoundLocation() const noexcept
     return { _coordSelStart, _coordSelEnd };
 }
 
+// Routine Description:
+// - Returns all matches that were found in the buffer, sorted by their position.
+//   The end of each span is inclusive.
+const std::vector<til::point_span>& Search::Results() const noexcept
+{
+    return _results;
+}
+
+// Routine Description:
+// - Returns the index of the current result in Results(), or -1 if no result has been visited yet.
+ptrdiff_t Search::CurrentResultIndex() const noexcept
+{
+    return _index;
+}
+
+// Routine Description:
+// - Returns false if this is a regular expression search and the needle
+//   couldn't be compiled or failed to run over the buffer (for instance due
+//   to catastrophic backtracking). Such a search never has any results.
+// Arguments:
+// - <none>
+// Return Value:
+// - True for all literal searches and valid regular expressions.
+bool Search::IsPatternValid() const noexcept
+{
+    return _patternValid;
+}
+
+// Routine Description:
+// - Checks whether this search needs to be redone, because it was constructed with a different
+//   needle, sensitivity or buffer, or because the buffer contents changed since then.
+// Arguments:
+// - renderData - The IRenderData that would be searched
+// - str - The search term that would be used
+// - sensitivity - The case sensitivity that would be used
+// - mode - The search mode that would be used
+// Return Value:
+// - True if the results of this Search cannot be reused.
+bool Search::IsStale(const Microsoft::Console::Render::IRenderData& renderData, const std::wstring_view str, const Sensitivity sensitivity, const Mode mode) const noexcept
+{
+    const auto& textBuffer = renderData.GetTextBuffer();
+    return _textBuffer != &textBuffer ||
+           _lastMutationId != textBuffer.GetLastMutationId() ||
+           _sensitivity != sensitivity ||
+           _mode != mode ||
+           _needle != str;
+}
+
+// Routine Description:
+// - Finds the index of the result we should start at, based on the anchor and search direction.
+//   Searching forward picks the first result starting at or after the anchor,
+//   searching backward the last one starting at or before it. Both wrap around.
+ptrdiff_t Search::_GetInitialResultIndex() const noexcept
+{
+    const auto count = gsl::narrow_cast<ptrdiff_t>(_results.size());
+
+    if (_direction == Direction::Forward)
+    {
+        const auto it = std::lower_bound(_results.begin(), _results.end(), _coordAnchor, [](const til::point_span& span, const til::point& pos) {
+            return span.start < pos;
+        });
+        const auto index = it - _results.begin();
+        return index < count ? index : 0;
+    }
+    else
+    {
+        const auto it = std::upper_bound(_results.begin(), _results.end(), _coordAnchor, [](const til::point& pos, const til::point_span& span) {
+            return pos < span.start;
+        });
+        const auto index = it - _results.begin() - 1;
+        return index >= 0 ? index : count - 1;
+    }
+}
+
+void Search::_SetCurrentResult(const ptrdiff_t index) noexcept
+{
+    const auto& result = til::at(_results, index);
+    _index = index;
+    _coordSelStart = result.start;
+    _coordSelEnd = result.end;
+}
+
 // Routine Description:
 // - Finds the anchor position where we will start searches from.
 // - This position will represent the "wrap around" point in the buffer or where
@@ -175,169 +313,3 @@ til::point Search::s_GetInitialAnchor(const Microsoft::Console::Render::IRenderD
         }
     }
 }
-
-// Routine Description:
-// - Attempts to compare the search term (the needle) to the screen buffer (the haystack)
-//   at the given coordinate position of the screen buffer.
-// - Performs one comparison. Call again with new positions to check other spots.
-// Arguments:
-// - pos - The position in the haystack (screen buffer) to compare
-// - start - If we found it, this is filled with the coordinate of the first character of the needle.
-// - end - If we found it, this is filled with the coordinate of the last character of the needle.
-// Return Value:
-// - True if we found it. False if not.
-bool Search::_FindNeedleInHaystackAt(const til::point pos, til::point& start, til::point& end) const
-{
-    start = {};
-    end = {};
-
-    auto bufferPos = pos;
-
-    for (const auto& needleChars : _needle)
-    {
-        // Haystack is the buffer. Needle is the string we were given.
-        const auto hayIter = _renderData.GetTextBuffer().GetTextDataAt(bufferPos);
-        const auto hayChars = *hayIter;
-
-        // If we didn't match at any point of the needle, return false.
-        if (!_CompareChars(hayChars, needleChars))
-        {
-            return false;
-        }
-
-        _IncrementCoord(bufferPos);
-    }
-
-    _DecrementCoord(bufferPos);
-
-    // If we made it the whole way through the needle, then it was in the haystack.
-    // Fill out the span that we found the result at and return true.
-    start = pos;
-    end = bufferPos;
-
-    return true;
-}
-
-// Routine Description:
-// - Provides an abstraction for comparing two spans of text.
-// - Internally handles case sensitivity based on object construction.
-// Arguments:
-// - one - String view representing the first string of text
-// - two - String view representing the second string of text
-// Return Value:
-// - True if they are the same. False otherwise.
-bool Search::_CompareChars(const std::wstring_view one, const std::wstring_view two) const noexcept
-{
-    if (one.size() != two.size())
-    {
-        return false;
-    }
-
-    for (size_t i = 0; i < one.size(); i++)
-    {
-        if (_ApplySensitivity(one.at(i)) != _ApplySensitivity(two.at(i)))
-        {
-            return false;
-        }
-    }
-
-    return true;
-}
-
-// Routine Description:
-// - Provides an abstraction for conditionally applying case sensitivity
-//   based on object construction
-// Arguments:
-// - wch - Character to adjust if necessary
-// Return Value:
-// - Adjusted value (or not).
-wchar_t Search::_ApplySensitivity(const wchar_t wch) const noexcept
-{
-    if (_sensitivity == Sensitivity::CaseInsensitive)
-    {
-        return ::towlower(wch);
-    }
-    else
-    {
-        return wch;
-    }
-}
-
-// Routine Description:
-// - Helper to increment a coordinate in respect to the associated screen buffer
-// Arguments
-// - coord - Updated by function to increment one position (will wrap X and Y direction)
-void Search::_IncrementCoord(til::point& coord) const noexcept
-{
-    _renderData.GetTextBuffer().GetSize().IncrementInBoundsCircular(coord);
-}
-
-// Routine Description:
-// - Helper to decrement a coordinate in respect to the associated screen buffer
-// Arguments
-// - coord - Updated by function to decrement one position (will wrap X and Y direction)
-void Search::_DecrementCoord(til::point& coord) const noexcept
-{
-    _renderData.GetTextBuffer().GetSize().DecrementInBoundsCircular(coord);
-}
-
-// Routine Description:
-// - Helper to update the coordinate position to the next point to be searched
-// Return Value:
-// - True if we haven't reached the end of the buffer. False otherwise.
-void Search::_UpdateNextPosition()
-{
-    if (_direction == Direction::Forward)
-    {
-        _IncrementCoord(_coordNext);
-    }
-    else if (_direction == Direction::Backward)
-    {
-        _DecrementCoord(_coordNext);
-    }
-    else
-    {
-        THROW_HR(E_NOTIMPL);
-    }
-
-    // To reduce wrap-around time, if the next position is larger than
-    // the end position of the written text
-    // We put the next position to:
-    // Forward: (0, 0)
-    // Backward: the position of the end of the text buffer
-    const auto bufferEndPosition = _renderData.GetTextBufferEndPosition();
-
-    if (_coordNext.y > bufferEndPosition.y ||
-        (_coordNext.y == bufferEndPosition.y && _coordNext.x > bufferEndPosition.x))
-    {
-        if (_direction == Direction::Forward)
-        {
-            _coordNext = {};
-        }
-        else
-        {
-            _coordNext = bufferEndPosition;
-        }
-    }
-}
-
-// Routine Description:
-// - Creates a "needle" of the correct format for comparison to the screen buffer text data
-//   that we can use for our search
-// Arguments:
-// - wstr - String that will be our search term
-// Return Value:
-// - Structured text data for comparison to screen buffer text data.
-std::vector<std::wstring> Search::s_CreateNeedleFromString(const std::wstring_view wstr)
-{
-    std::vector<std::wstring> cells;
-    for (const auto& chars : til::utf16_iterator{ wstr })
-    {
-        if (IsGlyphFullWidth(chars))
-        {
-            cells.emplace_back(chars);
-        }
-        cells.emplace_back(chars);
-    }
-    return cells;
-}
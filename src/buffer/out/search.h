@@ -39,46 +39,60 @@ public:
         CaseSensitive
     };
 
+    enum class Mode
+    {
+        Literal,
+        RegularExpression
+    };
+
     Search(Microsoft::Console::Render::IRenderData& renderData,
            const std::wstring_view str,
            const Direction dir,
-           const Sensitivity sensitivity);
+           const Sensitivity sensitivity,
+           const Mode mode = Mode::Literal);
 
     Search(Microsoft::Console::Render::IRenderData& renderData,
            const std::wstring_view str,
            const Direction dir,
            const Sensitivity sensitivity,
-           const til::point anchor);
+           const til::point anchor,
+           const Mode mode = Mode::Literal);
 
     bool FindNext();
+    bool MoveToNextResult(const Direction dir);
     void Select() const;
     void Color(const TextAttribute attr) const;
 
     std::pair<til::point, til::point> GetFoundLocation() const noexcept;
+    const std::vector<til::point_span>& Results() const noexcept;
+    ptrdiff_t CurrentResultIndex() const noexcept;
+    bool IsPatternValid() const noexcept;
+    bool IsStale(const Microsoft::Console::Render::IRenderData& renderData, const std::wstring_view str, const Sensitivity sensitivity, const Mode mode = Mode::Literal) const noexcept;
 
 private:
-    wchar_t _ApplySensitivity(const wchar_t wch) const noexcept;
-    bool _FindNeedleInHaystackAt(const til::point pos, til::point& start, til::point& end) const;
-    bool _CompareChars(const std::wstring_view one, const std::wstring_view two) const noexcept;
-    void _UpdateNextPosition();
-
-    void _IncrementCoord(til::point& coord) const noexcept;
-    void _DecrementCoord(til::point& coord) const noexcept;
+    ptrdiff_t _GetInitialResultIndex() const noexcept;
+    void _SetCurrentResult(const ptrdiff_t index) noexcept;
 
     static til::point s_GetInitialAnchor(const Microsoft::Console::Render::IRenderData& renderData, const Direction dir);
 
-    static std::vector<std::wstring> s_CreateNeedleFromString(const std::wstring_view wstr);
-
-    bool _reachedEnd = false;
-    til::point _coordNext;
+    // All matches in the buffer, sorted by their start position. They're found in a single
+    // pass over the buffer on construction. FindNext() and MoveToNextResult() only step through them.
+    std::vector<til::point_span> _results;
+    ptrdiff_t _index = -1;
+    size_t _visited = 0;
+    bool _patternValid = true;
     til::point _coordSelStart;
     til::point _coordSelEnd;
 
     const til::point _coordAnchor;
-    const std::vector<std::wstring> _needle;
+    const std::wstring _needle;
     const Direction _direction;
     const Sensitivity _sensitivity;
+    const Mode _mode;
     Microsoft::Console::Render::IRenderData& _renderData;
+    // Used by IsStale() to determine whether the buffer contents changed since we searched it.
+    const TextBuffer* _textBuffer = nullptr;
+    uint64_t _lastMutationId = 0;
 
 #ifdef UNIT_TESTING
     friend class SearchTests;
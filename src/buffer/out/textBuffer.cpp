@@ -35,6 +35,7 @@ TextBuffer::TextBuffer(til::size screenBufferSize,
                        const bool isActiveBuffer,
                        Microsoft::Console::Render::Renderer& renderer) :
     _renderer{ renderer },
+    _hyperlinkRefCounts{ std::make_unique<HyperlinkRefCounts>() },
     _currentAttributes{ defaultAttributes },
     _cursor{ cursorSize, *this },
     _isActiveBuffer{ isActiveBuffer }
@@ -98,6 +99,9 @@ void TextBuffer::_reserve(til::size screenBufferSize, const TextAttribute& defau
     _bufferOffsetCharOffsets = rowSize + charsBufferSize;
     _width = w;
     _height = h;
+
+    _rowIndices.resize(h);
+    std::iota(_rowIndices.begin(), _rowIndices.end(), uint16_t{ 0 });
 }
 
 // MEM_COMMITs the memory and constructs all ROWs up to and including the given row pointer.
@@ -123,9 +127,14 @@ __declspec(noinline) void TextBuffer::_commit(const std::byte* row)
 // You can use this (or rather the Reset() method) to fully clear the TextBuffer.
 void TextBuffer::_decommit() noexcept
 {
+    _lastMutationId++;
+    _patternCache.clear();
     _destroy();
+    _hyperlinkRefCounts->clear();
     VirtualFree(_buffer.get(), 0, MEM_DECOMMIT);
     _commitWatermark = _buffer.get();
+    // _estimateOffsetOfLastCommittedRow() relies on rows being committed in the order of their offset.
+    std::iota(_rowIndices.begin(), _rowIndices.end(), uint16_t{ 0 });
 }
 
 // Constructs ROWs up to (excluding) the ROW pointed to by `until`.
@@ -136,7 +145,9 @@ void TextBuffer::_construct(const std::byte* until) noexcept
         const auto row = reinterpret_cast<ROW*>(_commitWatermark);
         const auto chars = reinterpret_cast<wchar_t*>(_commitWatermark + _bufferOffsetChars);
         const auto indices = reinterpret_cast<uint16_t*>(_commitWatermark + _bufferOffsetCharOffsets);
-        std::construct_at(row, chars, indices, _width, _initialAttributes);
+        // The scratchpad row (the first one) doesn't participate in hyperlink reference counting.
+        const auto hyperlinkRefCounts = _commitWatermark == _buffer.get() ? nullptr : _hyperlinkRefCounts.get();
+        std::construct_at(row, chars, indices, _width, _initialAttributes, hyperlinkRefCounts);
     }
 }
 
@@ -185,12 +196,24 @@ const ROW& TextBuffer::GetRowByOffset(const til::CoordType index) const
 {
     // The const_cast is safe because "const" never had any meaning in C++ in the first place.
 #pragma warning(suppress : 26492) // Don't use const_cast to cast away const or volatile (type.3).
-    return const_cast<TextBuffer*>(this)->GetRowByOffset(index);
+    return const_cast<TextBuffer*>(this)->_getRowByOffset(index);
 }
 
 // Retrieves a row from the buffer by its offset from the first row of the text buffer
 // (what corresponds to the top row of the screen buffer).
 ROW& TextBuffer::GetRowByOffset(const til::CoordType index)
+{
+    return _getRowByOffset(index);
+}
+
+ROW& TextBuffer::_getRowByOffset(const til::CoordType index)
+{
+    // We add 1 to the row offset, because row "0" is the one returned by GetScratchpadRow().
+    return _getRowByOffsetDirect(::base::strict_cast<size_t>(til::at(_rowIndices, _circularRowIndex(index))) + 1);
+}
+
+// Translates an offset from the first row of the text buffer into an index into _rowIndices.
+size_t TextBuffer::_circularRowIndex(const til::CoordType index) const noexcept
 {
     // Rows are stored circularly, so the index you ask for is offset by the start position and mod the total of rows.
     auto offset = (_firstRow + index) % _height;
@@ -202,8 +225,36 @@ ROW& TextBuffer::GetRowByOffset(const til::CoordType index)
         offset += _height;
     }
 
-    // We add 1 to the row offset, because row "0" is the one returned by GetScratchpadRow().
-    return _getRowByOffsetDirect(gsl::narrow_cast<size_t>(offset) + 1);
+    return gsl::narrow_cast<size_t>(offset);
+}
+
+// Rotates the rows in the range [begin, end) by `shift` rows (positive is down, negative is up),
+// similar to std::rotate. Rows that get shifted past one end of the range reappear at the other end.
+// Only _rowIndices is modified, the ROWs themselves stay where they are.
+void TextBuffer::_rotateRows(const til::CoordType begin, const til::CoordType end, const til::CoordType shift)
+{
+    const auto count = gsl::narrow_cast<size_t>(end - begin);
+    const auto first = _circularRowIndex(begin);
+    // std::rotate() wants to know the element that will become the new first one.
+    const auto middle = gsl::narrow_cast<size_t>(shift < 0 ? -shift : gsl::narrow_cast<til::CoordType>(count) - shift);
+    const auto indices = _rowIndices.begin();
+
+    if (first + count <= _rowIndices.size())
+    {
+        std::rotate(indices + first, indices + first + middle, indices + first + count);
+        return;
+    }
+
+    // The range wraps around the end of our circular buffer.
+    // This is rare enough that we can afford a temporary copy.
+    const auto head = _rowIndices.size() - first;
+    std::vector<uint16_t> tmp;
+    tmp.reserve(count);
+    tmp.insert(tmp.end(), indices + first, _rowIndices.end());
+    tmp.insert(tmp.end(), indices, indices + (count - head));
+    std::rotate(tmp.begin(), tmp.begin() + middle, tmp.end());
+    std::copy_n(tmp.begin(), head, indices + first);
+    std::copy(tmp.begin() + head, tmp.end(), indices);
 }
 
 // Returns a row filled with whitespace and the current attributes, for you to freely use.
@@ -513,6 +564,81 @@ void TextBuffer::FillRect(const til::rect& rect, const std::wstring_view& fill,
     }
 }
 
+// Copies the contents of the source rectangle to the one that starts at target.
+// The two rectangles may overlap. Unlike copying individual cells via GetCellDataAt() and WriteLine(),
+// this copies entire row spans at once, using CopyTextFrom() for the text and slices of the attribute runs.
+// Wide glyphs that get cut in half by either edge of the source are replaced with whitespace.
+// If clipToLineWidth is true, source cells outside of the GetLineWidth() of double-width rows
+// are skipped, leaving the corresponding target cells untouched (like DECCRA requires).
+void TextBuffer::CopyRectangle(const til::rect& source, const til::point target, const bool clipToLineWidth)
+{
+    if (!source || source.origin() == target)
+    {
+        return;
+    }
+
+    const auto width = GetSize().Width();
+    const auto deltaX = target.x - source.left;
+    const auto deltaY = target.y - source.top;
+    // When moving down we need to go from the bottom to the top,
+    // so that we don't overwrite source rows before we've read them.
+    const auto step = deltaY > 0 ? -1 : 1;
+    auto srcY = deltaY > 0 ? source.bottom - 1 : source.top;
+
+    for (auto i = source.top; i < source.bottom; ++i, srcY += step)
+    {
+        const auto dstY = srcY + deltaY;
+        auto& dstRow = GetRowByOffset(dstY);
+        const ROW* srcRow = &GetRowByOffset(srcY);
+
+        // CopyTextFrom() can't copy a row into itself. Horizontal moves
+        // within the same row thus take a detour through the scratchpad.
+        if (srcRow == &dstRow)
+        {
+            auto& scratchpad = GetScratchpadRow();
+            scratchpad.CopyFrom(*srcRow);
+            srcRow = &scratchpad;
+        }
+
+        auto srcBeg = source.left;
+        auto srcEnd = std::min(source.right, width - deltaX);
+        if (clipToLineWidth)
+        {
+            srcEnd = std::min<til::CoordType>(srcEnd, srcRow->GetLineWidth());
+        }
+        if (srcBeg >= srcEnd)
+        {
+            continue;
+        }
+
+        auto dstBeg = srcBeg + deltaX;
+        const auto dstEnd = srcEnd + deltaX;
+
+        dstRow.ReplaceAttributes(dstBeg, dstEnd, srcRow->Attributes().slice(srcBeg, srcEnd));
+
+        // CopyTextFrom() refuses to start copying in the middle of a wide glyph.
+        // The trailing half that got cut off turns into a space, just like the leading half at the right edge.
+        if (srcRow->DbcsAttrAt(srcBeg) == DbcsAttribute::Trailing)
+        {
+            dstRow.ReplaceCharacters(dstBeg, 1, L" ");
+            ++srcBeg;
+            ++dstBeg;
+        }
+
+        RowCopyTextFromState state{
+            .source = *srcRow,
+            .columnBegin = dstBeg,
+            .columnLimit = dstEnd,
+            .sourceColumnBegin = srcBeg,
+            .sourceColumnLimit = srcEnd,
+        };
+        dstRow.CopyTextFrom(state);
+
+        // Overwriting half of a wide glyph may have cleared its other half just outside the target range.
+        TriggerRedraw(Viewport::FromExclusive({ std::max(0, target.x - 1), dstY, std::min(width, dstEnd + 1), dstY + 1 }));
+    }
+}
+
 // Routine Description:
 // - Writes cells to the output buffer. Writes at the cursor.
 // Arguments:
@@ -619,6 +745,7 @@ void TextBuffer::InsertCharacter(const std::wstring_view chars,
 
     // Get the row associated with the given logical position
     auto& Row = GetRowByOffset(iRow);
+    _lastMutationId++;
 
     // Store character and double byte data
     switch (dbcsAttribute)
@@ -679,6 +806,7 @@ void TextBuffer::_AdjustWrapOnCurrentRow(const bool fSet)
 
     // Set the wrap status as appropriate
     GetRowByOffset(uiCurrentRowOffset).SetWrapForced(fSet);
+    _lastMutationId++;
 }
 
 //Routine Description:
@@ -755,6 +883,7 @@ void TextBuffer::IncrementCircularBuffer(const TextAttribute& fillAttributes)
 
     // Second, clean out the old "first row" as it will become the "last row" of the buffer after the circle is performed.
     GetRowByOffset(0).Reset(fillAttributes);
+    _lastMutationId++;
     {
         // Now proceed to increment.
         // Incrementing it will cause the next line down to become the new "top" of the window (the new "0" in logical coordinates)
@@ -866,6 +995,8 @@ void TextBuffer::ScrollRows(const til::CoordType firstRow, til::CoordType size,
         return;
     }
 
+    _lastMutationId++;
+
     // Since the for() loop uses !=, we must ensure that size is positive.
     // A negative size doesn't make any sense anyways.
     size = std::max(0, size);
@@ -923,6 +1054,29 @@ void TextBuffer::ScrollRows(const til::CoordType firstRow, til::CoordType size,
         step = -1;
     }
 
+    const auto absoluteDelta = std::abs(delta);
+
+    // If the source and target ranges overlap we don't need to copy any row contents around. Instead we rotate
+    // the affected range [A, C) in _rowIndices, which moves the rows [B, C) into place. Rotating the range
+    // moves the target rows that got overwritten into the area that got uncovered by the scroll. But this
+    // function is supposed to leave the uncovered area untouched, so we then copy the original rows back into
+    // that area. That's only |delta| many rows instead of `size` many, which for typical scroll operations
+    // (1 row up or down inside margins, IL/DL, etc.) makes this function run in O(1) instead of O(rows).
+    if (absoluteDelta < size && size + absoluteDelta <= _height)
+    {
+        const auto begin = std::min(firstRow, firstRow + delta);
+        const auto limit = std::max(firstRow, firstRow + delta) + size;
+        _rotateRows(begin, limit, delta);
+
+        // The uncovered rows [firstRow, firstRow + delta) or [firstRow + size + delta, firstRow + size).
+        const auto uncoveredBegin = delta < 0 ? firstRow + size + delta : firstRow;
+        for (auto i = uncoveredBegin; i < uncoveredBegin + absoluteDelta; ++i)
+        {
+            GetRowByOffset(i).CopyFrom(GetRowByOffset(i + delta));
+        }
+        return;
+    }
+
     for (; y != end; y += step)
     {
         GetRowByOffset(y + delta).CopyFrom(GetRowByOffset(y));
@@ -952,6 +1106,7 @@ void TextBuffer::SetCurrentAttributes(const TextAttribute& currentAttributes) no
 void TextBuffer::SetWrapForced(const til::CoordType y, bool wrap)
 {
     GetRowByOffset(y).SetWrapForced(wrap);
+    _lastMutationId++;
 }
 
 void TextBuffer::SetCurrentLineRendition(const LineRendition lineRendition, const TextAttribute& fillAttributes)
@@ -985,6 +1140,7 @@ void TextBuffer::ResetLineRenditionRange(const til::CoordType startRow, const ti
     {
         GetRowByOffset(row).SetLineRendition(LineRendition::SingleWidth);
     }
+    _lastMutationId++;
 }
 
 LineRendition TextBuffer::GetLineRendition(const til::CoordType row) const
@@ -1073,8 +1229,14 @@ void TextBuffer::Reset() noexcept
         _bufferOffsetCharOffsets = newBuffer._bufferOffsetCharOffsets;
         _width = newBuffer._width;
         _height = newBuffer._height;
+        _rowIndices = std::move(newBuffer._rowIndices);
+        // The new ROWs refer to the reference counts of newBuffer. Our old ROWs (and with them
+        // their references) are gone, so we can just swap tables and let newBuffer dispose ours.
+        std::swap(_hyperlinkRefCounts, newBuffer._hyperlinkRefCounts);
 
         _SetFirstRowIndex(0);
+        _patternCache.clear();
+        _lastMutationId++;
     }
     CATCH_RETURN();
 
@@ -1098,6 +1260,10 @@ Microsoft::Console::Render::Renderer& TextBuffer::GetRenderer() noexcept
 
 void TextBuffer::TriggerRedraw(const Viewport& viewport)
 {
+    // Everyone who modifies ROWs has to tell the renderer about it, including
+    // callers outside of TextBuffer that edit them via GetRowByOffset() directly.
+    _lastMutationId++;
+
     if (_isActiveBuffer)
     {
         _renderer.TriggerRedraw(viewport);
@@ -1415,45 +1581,21 @@ til::point TextBuffer::_GetWordEndForSelection(const til::point target, const st
 void TextBuffer::_PruneHyperlinks()
 {
     // Check the old first row for hyperlink references
-    // If there are any, search the entire buffer for the same reference
-    // If the buffer does not contain the same reference, we can remove that hyperlink from our map
+    // If the rest of the buffer does not contain the same reference, we can remove that hyperlink from our map
     // This way, obsolete hyperlink references are cleared from our hyperlink map instead of hanging around
-    // Get all the hyperlink references in the row we're erasing
+    // Get all the hyperlink references in the row we're erasing (1 entry per attribute run)
     const auto hyperlinks = GetRowByOffset(0).GetHyperlinks();
 
-    if (!hyperlinks.empty())
+    for (const auto id : hyperlinks)
     {
-        // Move to unordered set so we can use hashed lookup of IDs instead of linear search.
-        // Only make it an unordered set now because set always heap allocates but vector
-        // doesn't when the set is empty (saving an allocation in the common case of no links.)
-        std::unordered_set<uint16_t> firstRowRefs{ hyperlinks.cbegin(), hyperlinks.cend() };
-
-        const auto total = TotalRowCount();
-        // Loop through all the rows in the buffer except the first row -
-        // we have found all hyperlink references in the first row and put them in refs,
-        // now we need to search the rest of the buffer (i.e. all the rows except the first)
-        // to see if those references are anywhere else
-        for (til::CoordType i = 1; i < total; ++i)
-        {
-            const auto nextRowRefs = GetRowByOffset(i).GetHyperlinks();
-            for (auto id : nextRowRefs)
-            {
-                if (firstRowRefs.find(id) != firstRowRefs.end())
-                {
-                    firstRowRefs.erase(id);
-                }
-            }
-            if (firstRowRefs.empty())
-            {
-                // No more hyperlink references left to search for, terminate early
-                break;
-            }
-        }
-
-        // Now delete obsolete references from our map
-        for (auto hyperlinkReference : firstRowRefs)
+        // _hyperlinkRefCounts counts the runs referencing an ID across all rows.
+        // If all of them are in the first row, the ID is about to become obsolete.
+        const auto it = _hyperlinkRefCounts->find(id);
+        const auto total = it != _hyperlinkRefCounts->end() ? it->second : 0;
+        const auto local = gsl::narrow_cast<uint32_t>(std::count(hyperlinks.begin(), hyperlinks.end(), id));
+        if (total <= local)
         {
-            RemoveHyperlinkFromMap(hyperlinkReference);
+            RemoveHyperlinkFromMap(id);
         }
     }
 }
@@ -1836,60 +1978,81 @@ const TextBuffer::TextAndColor TextBuffer::GetText(const bool includeCRLF,
     data.text.reserve(rows);
     if (copyTextColor)
     {
-        data.FgAttr.reserve(rows);
-        data.BkAttr.reserve(rows);
+        data.colors.reserve(rows);
     }
 
     // for each row in the selection
     for (size_t i = 0; i < rows; i++)
     {
-        const auto iRow = selectionRects.at(i).top;
-
-        const auto highlight = Viewport::FromInclusive(selectionRects.at(i));
+        const auto& selectionRect = selectionRects.at(i);
+        const auto iRow = selectionRect.top;
+        const auto& row = GetRowByOffset(iRow);
+        const auto rowText = row.GetText();
+        const auto charOffsets = row.CharOffsets();
+        const auto columns = gsl::narrow_cast<til::CoordType>(charOffsets.size() - 1);
+
+        // Returns the offset into rowText of the first glyph starting at or after the given column.
+        // Glyphs belong to their leading column: A selection starting on the trailing half of a
+        // wide glyph doesn't include it, but one ending on its leading half does.
+        const auto glyphOffset = [&](til::CoordType column) {
+            column = std::clamp(column, 0, columns);
+            while (column < columns && WI_IsFlagSet(til::at(charOffsets, column), ROW::CharOffsetsTrailer))
+            {
+                ++column;
+            }
+            return gsl::narrow_cast<size_t>(til::at(charOffsets, column) & ROW::CharOffsetsMask);
+        };
 
-        // retrieve the data from the screen buffer
-        auto it = GetCellDataAt(highlight.Origin(), highlight);
+        const auto columnBegin = selectionRect.left;
+        const auto columnEnd = selectionRect.right + 1;
+        const auto textBegin = glyphOffset(columnBegin);
+        const auto textEnd = glyphOffset(columnEnd);
 
         // allocate a string buffer
         std::wstring selectionText;
-        std::vector<COLORREF> selectionFgAttr;
-        std::vector<COLORREF> selectionBkAttr;
+        std::vector<TextAndColor::ColorRun> selectionColors;
 
         // preallocate to avoid reallocs
-        selectionText.reserve(gsl::narrow<size_t>(highlight.Width()) + 2); // + 2 for \r\n if we munged it
-        if (copyTextColor)
-        {
-            selectionFgAttr.reserve(gsl::narrow<size_t>(highlight.Width()) + 2);
-            selectionBkAttr.reserve(gsl::narrow<size_t>(highlight.Width()) + 2);
-        }
+        selectionText.reserve(textEnd - textBegin + 2); // + 2 for \r\n if we munged it
+        selectionText.append(rowText.substr(textBegin, textEnd - textBegin));
 
-        // copy char data into the string buffer, skipping trailing bytes
-        while (it)
+        // Walk the attribute runs of the row instead of its cells,
+        // so that we only need to resolve the colors once per run.
+        if (copyTextColor)
         {
-            const auto& cell = *it;
-
-            if (cell.DbcsAttr() != DbcsAttribute::Trailing)
+            til::CoordType runBegin = 0;
+            for (const auto& run : row.Attributes().runs())
             {
-                const auto chars = cell.Chars();
-                selectionText.append(chars);
+                const auto runEnd = runBegin + run.length;
+                const auto begin = std::max(runBegin, columnBegin);
+                const auto end = std::min(runEnd, columnEnd);
 
-                if (copyTextColor)
+                if (begin < end)
                 {
-                    const auto cellData = cell.TextAttr();
-                    const auto [CellFgAttr, CellBkAttr] = GetAttributeColors(cellData);
-                    for (size_t j = 0; j < chars.size(); ++j)
+                    if (const auto length = glyphOffset(end) - glyphOffset(begin))
                     {
-                        selectionFgAttr.push_back(CellFgAttr);
-                        selectionBkAttr.push_back(CellBkAttr);
+                        const auto [fg, bg] = GetAttributeColors(run.value);
+                        if (!selectionColors.empty() && selectionColors.back().foreground == fg && selectionColors.back().background == bg)
+                        {
+                            selectionColors.back().length += length;
+                        }
+                        else
+                        {
+                            selectionColors.push_back({ length, fg, bg });
+                        }
                     }
                 }
-            }
 
-            ++it;
+                if (runEnd >= columnEnd)
+                {
+                    break;
+                }
+                runBegin = runEnd;
+            }
         }
 
         // We apply formatting to rows if the row was NOT wrapped or formatting of wrapped rows is allowed
-        const auto shouldFormatRow = formatWrappedRows || !GetRowByOffset(iRow).WasWrapForced();
+        const auto shouldFormatRow = formatWrappedRows || !row.WasWrapForced();
 
         if (trimTrailingWhitespace)
         {
@@ -1899,10 +2062,9 @@ const TextBuffer::TextAndColor TextBuffer::GetText(const bool includeCRLF,
                 while (!selectionText.empty() && selectionText.back() == UNICODE_SPACE)
                 {
                     selectionText.pop_back();
-                    if (copyTextColor)
+                    if (copyTextColor && --selectionColors.back().length == 0)
                     {
-                        selectionFgAttr.pop_back();
-                        selectionBkAttr.pop_back();
+                        selectionColors.pop_back();
                     }
                 }
             }
@@ -1922,10 +2084,7 @@ const TextBuffer::TextAndColor TextBuffer::GetText(const bool includeCRLF,
                 {
                     // can't see CR/LF so just use black FG & BK
                     const auto Blackness = RGB(0x00, 0x00, 0x00);
-                    selectionFgAttr.push_back(Blackness);
-                    selectionFgAttr.push_back(Blackness);
-                    selectionBkAttr.push_back(Blackness);
-                    selectionBkAttr.push_back(Blackness);
+                    selectionColors.push_back({ 2, Blackness, Blackness });
                 }
             }
         }
@@ -1933,8 +2092,7 @@ const TextBuffer::TextAndColor TextBuffer::GetText(const bool includeCRLF,
         data.text.emplace_back(std::move(selectionText));
         if (copyTextColor)
         {
-            data.FgAttr.emplace_back(std::move(selectionFgAttr));
-            data.BkAttr.emplace_back(std::move(selectionBkAttr));
+            data.colors.emplace_back(std::move(selectionColors));
         }
     }
 
@@ -1978,6 +2136,30 @@ std::wstring TextBuffer::GetPlainText(const til::point& start, const til::point&
     return text;
 }
 
+// Routine Description:
+// - Calls func(text, foreground, background) for each run of identically
+//   colored text in the given row, up to the first CR or LF (if any).
+template<typename T>
+static void ForEachColorRun(const TextBuffer::TextAndColor& rows, const size_t row, T&& func)
+{
+    const std::wstring_view text{ rows.text.at(row) };
+    // do not include \r nor \n as they don't have color attributes.
+    const auto textEnd = std::min(text.size(), text.find_first_of(L"\r\n"));
+
+    size_t offset = 0;
+    for (const auto& run : rows.colors.at(row))
+    {
+        if (offset >= textEnd)
+        {
+            break;
+        }
+
+        const auto length = std::min(run.length, textEnd - offset);
+        func(text.substr(offset, length), run.foreground, run.background);
+        offset += length;
+    }
+}
+
 // Routine Description:
 // - Generates a CF_HTML compliant structure based on the passed in text and color data
 // Arguments:
@@ -1994,44 +2176,59 @@ std::string TextBuffer::GenHTML(const TextAndColor& rows,
 {
     try
     {
-        std::ostringstream htmlBuilder;
+        std::string htmlBuilder;
+        // Reusable scratch buffer for converting text to UTF-8.
+        std::string utf8;
+
+        const auto appendColor = [&](const COLORREF color) {
+            fmt::format_to(std::back_inserter(htmlBuilder), FMT_COMPILE("#{:02X}{:02X}{:02X}"), GetRValue(color), GetGValue(color), GetBValue(color));
+        };
+
+        // Most of the output is the text itself, with a span for every color change.
+        size_t expectedSize = 512;
+        for (size_t row = 0; row < rows.text.size(); row++)
+        {
+            expectedSize += rows.text.at(row).size() + rows.colors.at(row).size() * 64;
+        }
+        htmlBuilder.reserve(expectedSize);
 
         // First we have to add some standard
         // HTML boiler plate required for CF_HTML
         // as part of the HTML Clipboard format
-        const std::string htmlHeader =
+        constexpr std::string_view htmlHeader =
             "<!DOCTYPE><HTML><HEAD></HEAD><BODY>";
-        htmlBuilder << htmlHeader;
+        htmlBuilder.append(htmlHeader);
 
-        htmlBuilder << "<!--StartFragment -->";
+        htmlBuilder.append("<!--StartFragment -->");
 
         // apply global style in div element
         {
-            htmlBuilder << "<DIV STYLE=\"";
-            htmlBuilder << "display:inline-block;";
-            htmlBuilder << "white-space:pre;";
-
-            htmlBuilder << "background-color:";
-            htmlBuilder << Utils::ColorToHexString(backgroundColor);
-            htmlBuilder << ";";
-
-            htmlBuilder << "font-family:";
-            htmlBuilder << "'";
-            htmlBuilder << ConvertToA(CP_UTF8, fontFaceName);
-            htmlBuilder << "',";
+            htmlBuilder.append("<DIV STYLE=\"");
+            htmlBuilder.append("display:inline-block;");
+            htmlBuilder.append("white-space:pre;");
+
+            htmlBuilder.append("background-color:");
+            appendColor(backgroundColor);
+            htmlBuilder.append(";");
+
+            htmlBuilder.append("font-family:");
+            htmlBuilder.append("'");
+            THROW_IF_FAILED(til::u16u8(fontFaceName, utf8));
+            htmlBuilder.append(utf8);
+            htmlBuilder.append("',");
             // even with different font, add monospace as fallback
-            htmlBuilder << "monospace;";
+            htmlBuilder.append("monospace;");
 
-            htmlBuilder << "font-size:";
-            htmlBuilder << fontHeightPoints;
-            htmlBuilder << "pt;";
+            htmlBuilder.append("font-size:");
+            fmt::format_to(std::back_inserter(htmlBuilder), FMT_COMPILE("{}"), fontHeightPoints);
+            htmlBuilder.append("pt;");
 
             // note: MS Word doesn't support padding (in this way at least)
-            htmlBuilder << "padding:";
-            htmlBuilder << 4; // todo: customizable padding
-            htmlBuilder << "px;";
+            htmlBuilder.append("padding:");
+            htmlBuilder.append("4"); // todo: customizable padding
+            htmlBuilder.append("px;");
 
-            htmlBuilder << "\">";
+            htmlBuilder.append("\">");
         }
 
         // copy text and info color from buffer
@@ -2040,125 +2237,96 @@ std::string TextBuffer::GenHTML(const TextAndColor& rows,
         std::optional<COLORREF> bkColor = std::nullopt;
         for (size_t row = 0; row < rows.text.size(); row++)
         {
-            size_t startOffset = 0;
-
             if (row != 0)
             {
-                htmlBuilder << "<BR>";
+                htmlBuilder.append("<BR>");
             }
 
-            for (size_t col = 0; col < rows.text.at(row).length(); col++)
-            {
-                const auto writeAccumulatedChars = [&](bool includeCurrent) {
-                    if (col >= startOffset)
-                    {
-                        const auto unescapedText = ConvertToA(CP_UTF8, std::wstring_view(rows.text.at(row)).substr(startOffset, col - startOffset + includeCurrent));
-                        for (const auto c : unescapedText)
-                        {
-                            switch (c)
-                            {
-                            case '<':
-                                htmlBuilder << "&lt;";
-                                break;
-                            case '>':
-                                htmlBuilder << "&gt;";
-                                break;
-                            case '&':
-                                htmlBuilder << "&amp;";
-                                break;
-                            default:
-                                htmlBuilder << c;
-                            }
-                        }
-
-                        startOffset = col;
-                    }
-                };
-
-                if (rows.text.at(row).at(col) == '\r' || rows.text.at(row).at(col) == '\n')
-                {
-                    // do not include \r nor \n as they don't have color attributes
-                    // and are not HTML friendly. For line break use '<BR>' instead.
-                    writeAccumulatedChars(false);
-                    break;
-                }
-
-                auto colorChanged = false;
-                if (!fgColor.has_value() || rows.FgAttr.at(row).at(col) != fgColor.value())
-                {
-                    fgColor = rows.FgAttr.at(row).at(col);
-                    colorChanged = true;
-                }
-
-                if (!bkColor.has_value() || rows.BkAttr.at(row).at(col) != bkColor.value())
-                {
-                    bkColor = rows.BkAttr.at(row).at(col);
-                    colorChanged = true;
-                }
-
-                if (colorChanged)
+            ForEachColorRun(rows, row, [&](const std::wstring_view text, const COLORREF fg, const COLORREF bk) {
+                if (fgColor != fg || bkColor != bk)
                 {
-                    writeAccumulatedChars(false);
+                    fgColor = fg;
+                    bkColor = bk;
 
                     if (hasWrittenAnyText)
                     {
-                        htmlBuilder << "</SPAN>";
+                        htmlBuilder.append("</SPAN>");
                     }
 
-                    htmlBuilder << "<SPAN STYLE=\"";
-                    htmlBuilder << "color:";
-                    htmlBuilder << Utils::ColorToHexString(fgColor.value());
-                    htmlBuilder << ";";
-                    htmlBuilder << "background-color:";
-                    htmlBuilder << Utils::ColorToHexString(bkColor.value());
-                    htmlBuilder << ";";
-                    htmlBuilder << "\">";
+                    htmlBuilder.append("<SPAN STYLE=\"");
+                    htmlBuilder.append("color:");
+                    appendColor(fg);
+                    htmlBuilder.append(";");
+                    htmlBuilder.append("background-color:");
+                    appendColor(bk);
+                    htmlBuilder.append(";");
+                    htmlBuilder.append("\">");
                 }
 
                 hasWrittenAnyText = true;
 
-                // if this is the last character in the row, flush the whole row
-                if (col == rows.text.at(row).length() - 1)
+                THROW_IF_FAILED(til::u16u8(text, utf8));
+                for (const auto c : utf8)
                 {
-                    writeAccumulatedChars(true);
+                    switch (c)
+                    {
+                    case '<':
+                        htmlBuilder.append("&lt;");
+                        break;
+                    case '>':
+                        htmlBuilder.append("&gt;");
+                        break;
+                    case '&':
+                        htmlBuilder.append("&amp;");
+                        break;
+                    default:
+                        htmlBuilder.push_back(c);
+                    }
                 }
-            }
+            });
         }
 
         if (hasWrittenAnyText)
         {
             // last opened span wasn't closed in loop above, so close it now
-            htmlBuilder << "</SPAN>";
+            htmlBuilder.append("</SPAN>");
         }
 
-        htmlBuilder << "</DIV>";
+        htmlBuilder.append("</DIV>");
 
-        htmlBuilder << "<!--EndFragment -->";
+        htmlBuilder.append("<!--EndFragment -->");
 
         constexpr std::string_view HtmlFooter = "</BODY></HTML>";
-        htmlBuilder << HtmlFooter;
+        htmlBuilder.append(HtmlFooter);
 
         // once filled with values, there will be exactly 157 bytes in the clipboard header
         constexpr size_t ClipboardHeaderSize = 157;
 
         // these values are byte offsets from start of clipboard
         const auto htmlStartPos = ClipboardHeaderSize;
-        const auto htmlEndPos = ClipboardHeaderSize + gsl::narrow<size_t>(htmlBuilder.tellp());
-        const auto fragStartPos = ClipboardHeaderSize + gsl::narrow<size_t>(htmlHeader.length());
-        const auto fragEndPos = htmlEndPos - HtmlFooter.length();
+        const auto htmlEndPos = ClipboardHeaderSize + htmlBuilder.size();
+        const auto fragStartPos = ClipboardHeaderSize + htmlHeader.size();
+        const auto fragEndPos = htmlEndPos - HtmlFooter.size();
 
         // header required by HTML 0.9 format
-        std::ostringstream clipHeaderBuilder;
-        clipHeaderBuilder << "Version:0.9\r\n";
-        clipHeaderBuilder << std::setfill('0');
-        clipHeaderBuilder << "StartHTML:" << std::setw(10) << htmlStartPos << "\r\n";
-        clipHeaderBuilder << "EndHTML:" << std::setw(10) << htmlEndPos << "\r\n";
-        clipHeaderBuilder << "StartFragment:" << std::setw(10) << fragStartPos << "\r\n";
-        clipHeaderBuilder << "EndFragment:" << std::setw(10) << fragEndPos << "\r\n";
-        clipHeaderBuilder << "StartSelection:" << std::setw(10) << fragStartPos << "\r\n";
-        clipHeaderBuilder << "EndSelection:" << std::setw(10) << fragEndPos << "\r\n";
-
-        return clipHeaderBuilder.str() + htmlBuilder.str();
+        std::string clipboard;
+        clipboard.reserve(ClipboardHeaderSize + htmlBuilder.size());
+        fmt::format_to(std::back_inserter(clipboard),
+                       FMT_COMPILE("Version:0.9\r\n"
+                                   "StartHTML:{:010}\r\n"
+                                   "EndHTML:{:010}\r\n"
+                                   "StartFragment:{:010}\r\n"
+                                   "EndFragment:{:010}\r\n"
+                                   "StartSelection:{:010}\r\n"
+                                   "EndSelection:{:010}\r\n"),
+                       htmlStartPos,
+                       htmlEndPos,
+                       fragStartPos,
+                       fragEndPos,
+                       fragStartPos,
+                       fragEndPos);
+        clipboard.append(htmlBuilder);
+        return clipboard;
     }
     catch (...)
     {
@@ -2182,10 +2350,10 @@ std::string TextBuffer::GenRTF(const TextAndColor& rows, const int fontHeightPoi
 {
     try
     {
-        std::ostringstream rtfBuilder;
+        std::string rtfBuilder;
 
         // start rtf
-        rtfBuilder << "{";
+        rtfBuilder.append("{");
 
         // Standard RTF header.
         // This is similar to the header generated by WordPad.
@@ -2193,10 +2361,12 @@ std::string TextBuffer::GenRTF(const TextAndColor& rows, const int fontHeightPoi
         // \ansicpg1252 - represents the ANSI code page which is used to perform the Unicode to ANSI conversion when writing RTF text
         // \deff0 - specifies that the default font for the document is the one at index 0 in the font table
         // \nouicompat - ?
-        rtfBuilder << "\\rtf1\\ansi\\ansicpg1252\\deff0\\nouicompat";
+        rtfBuilder.append("\\rtf1\\ansi\\ansicpg1252\\deff0\\nouicompat");
 
         // font table
-        rtfBuilder << "{\\fonttbl{\\f0\\fmodern\\fcharset0 " << ConvertToA(CP_UTF8, fontFaceName) << ";}}";
+        rtfBuilder.append("{\\fonttbl{\\f0\\fmodern\\fcharset0 ");
+        rtfBuilder.append(til::u16u8(fontFaceName));
+        rtfBuilder.append(";}}");
 
         // map to keep track of colors:
         // keys are colors represented by COLORREF
@@ -2205,133 +2375,79 @@ std::string TextBuffer::GenRTF(const TextAndColor& rows, const int fontHeightPoi
         auto nextColorIndex = 1; // leave 0 for the default color and start from 1.
 
         // RTF color table
-        std::ostringstream colorTableBuilder;
-        colorTableBuilder << "{\\colortbl ;";
-        colorTableBuilder << "\\red" << static_cast<int>(GetRValue(backgroundColor))
-                          << "\\green" << static_cast<int>(GetGValue(backgroundColor))
-                          << "\\blue" << static_cast<int>(GetBValue(backgroundColor))
-                          << ";";
-        colorMap[backgroundColor] = nextColorIndex++;
+        std::string colorTableBuilder;
+        colorTableBuilder.append("{\\colortbl ;");
+
+        // Returns the index of the given color in the color table, adding it if necessary.
+        const auto getColorIndex = [&](const COLORREF color) {
+            const auto [it, inserted] = colorMap.emplace(color, nextColorIndex);
+            if (inserted)
+            {
+                fmt::format_to(std::back_inserter(colorTableBuilder),
+                               FMT_COMPILE("\\red{}\\green{}\\blue{};"),
+                               GetRValue(color),
+                               GetGValue(color),
+                               GetBValue(color));
+                nextColorIndex++;
+            }
+            return it->second;
+        };
+        getColorIndex(backgroundColor);
 
         // content
-        std::ostringstream contentBuilder;
-        contentBuilder << "\\viewkind4\\uc4";
+        std::string contentBuilder;
+        {
+            size_t expectedSize = 64;
+            for (size_t row = 0; row < rows.text.size(); row++)
+            {
+                expectedSize += rows.text.at(row).size() + rows.colors.at(row).size() * 24;
+            }
+            contentBuilder.reserve(expectedSize);
+        }
+        contentBuilder.append("\\viewkind4\\uc4");
 
         // paragraph styles
         // \fs specifies font size in half-points i.e. \fs20 results in a font size
         // of 10 pts. That's why, font size is multiplied by 2 here.
-        contentBuilder << "\\pard\\slmult1\\f0\\fs" << std::to_string(2 * fontHeightPoints)
-                       << "\\highlight1"
-                       << " ";
+        fmt::format_to(std::back_inserter(contentBuilder), FMT_COMPILE("\\pard\\slmult1\\f0\\fs{}\\highlight1 "), 2 * fontHeightPoints);
 
         std::optional<COLORREF> fgColor = std::nullopt;
         std::optional<COLORREF> bkColor = std::nullopt;
         for (size_t row = 0; row < rows.text.size(); ++row)
         {
-            size_t startOffset = 0;
-
             if (row != 0)
             {
-                contentBuilder << "\\line "; // new line
+                contentBuilder.append("\\line "); // new line
             }
 
-            for (size_t col = 0; col < rows.text.at(row).length(); ++col)
-            {
-                const auto writeAccumulatedChars = [&](bool includeCurrent) {
-                    if (col >= startOffset)
-                    {
-                        const auto text = std::wstring_view{ rows.text.at(row) }.substr(startOffset, col - startOffset + includeCurrent);
-                        _AppendRTFText(contentBuilder, text);
-
-                        startOffset = col;
-                    }
-                };
-
-                if (rows.text.at(row).at(col) == '\r' || rows.text.at(row).at(col) == '\n')
-                {
-                    // do not include \r nor \n as they don't have color attributes.
-                    // For line break use \line instead.
-                    writeAccumulatedChars(false);
-                    break;
-                }
-
-                auto colorChanged = false;
-                if (!fgColor.has_value() || rows.FgAttr.at(row).at(col) != fgColor.value())
-                {
-                    fgColor = rows.FgAttr.at(row).at(col);
-                    colorChanged = true;
-                }
-
-                if (!bkColor.has_value() || rows.BkAttr.at(row).at(col) != bkColor.value())
-                {
-                    bkColor = rows.BkAttr.at(row).at(col);
-                    colorChanged = true;
-                }
-
-                if (colorChanged)
+            ForEachColorRun(rows, row, [&](const std::wstring_view text, const COLORREF fg, const COLORREF bk) {
+                if (fgColor != fg || bkColor != bk)
                 {
-                    writeAccumulatedChars(false);
-
-                    auto bkColorIndex = 0;
-                    if (colorMap.find(bkColor.value()) != colorMap.end())
-                    {
-                        // color already exists in the map, just retrieve the index
-                        bkColorIndex = colorMap[bkColor.value()];
-                    }
-                    else
-                    {
-                        // color not present in the map, so add it
-                        colorTableBuilder << "\\red" << static_cast<int>(GetRValue(bkColor.value()))
-                                          << "\\green" << static_cast<int>(GetGValue(bkColor.value()))
-                                          << "\\blue" << static_cast<int>(GetBValue(bkColor.value()))
-                                          << ";";
-                        colorMap[bkColor.value()] = nextColorIndex;
-                        bkColorIndex = nextColorIndex++;
-                    }
-
-                    auto fgColorIndex = 0;
-                    if (colorMap.find(fgColor.value()) != colorMap.end())
-                    {
-                        // color already exists in the map, just retrieve the index
-                        fgColorIndex = colorMap[fgColor.value()];
-                    }
-                    else
-                    {
-                        // color not present in the map, so add it
-                        colorTableBuilder << "\\red" << static_cast<int>(GetRValue(fgColor.value()))
-                                          << "\\green" << static_cast<int>(GetGValue(fgColor.value()))
-                                          << "\\blue" << static_cast<int>(GetBValue(fgColor.value()))
-                                          << ";";
-                        colorMap[fgColor.value()] = nextColorIndex;
-                        fgColorIndex = nextColorIndex++;
-                    }
+                    fgColor = fg;
+                    bkColor = bk;
 
-                    contentBuilder << "\\highlight" << bkColorIndex
-                                   << "\\cf" << fgColorIndex
-                                   << " ";
+                    const auto bkColorIndex = getColorIndex(bk);
+                    const auto fgColorIndex = getColorIndex(fg);
+                    fmt::format_to(std::back_inserter(contentBuilder), FMT_COMPILE("\\highlight{}\\cf{} "), bkColorIndex, fgColorIndex);
                 }
 
-                // if this is the last character in the row, flush the whole row
-                if (col == rows.text.at(row).length() - 1)
-                {
-                    writeAccumulatedChars(true);
-                }
-            }
+                _AppendRTFText(contentBuilder, text);
+            });
         }
 
         // end colortbl
-        colorTableBuilder << "}";
+        colorTableBuilder.append("}");
 
         // add color table to the final RTF
-        rtfBuilder << colorTableBuilder.str();
+        rtfBuilder.append(colorTableBuilder);
 
         // add the text content to the final RTF
-        rtfBuilder << contentBuilder.str();
+        rtfBuilder.append(contentBuilder);
 
         // end rtf
-        rtfBuilder << "}";
+        rtfBuilder.append("}");
 
-        return rtfBuilder.str();
+        return rtfBuilder;
     }
     catch (...)
     {
@@ -2340,7 +2456,7 @@ std::string TextBuffer::GenRTF(const TextAndColor& rows, const int fontHeightPoi
     }
 }
 
-void TextBuffer::_AppendRTFText(std::ostringstream& contentBuilder, const std::wstring_view& text)
+void TextBuffer::_AppendRTFText(std::string& contentBuilder, const std::wstring_view& text)
 {
     for (const auto codeUnit : text)
     {
@@ -2351,16 +2467,17 @@ void TextBuffer::_AppendRTFText(std::ostringstream& contentBuilder, const std::w
             case L'\\':
             case L'{':
             case L'}':
-                contentBuilder << "\\" << gsl::narrow<char>(codeUnit);
+                contentBuilder.push_back('\\');
+                contentBuilder.push_back(gsl::narrow<char>(codeUnit));
                 break;
             default:
-                contentBuilder << gsl::narrow<char>(codeUnit);
+                contentBuilder.push_back(gsl::narrow<char>(codeUnit));
             }
         }
         else
         {
             // Windows uses unsigned wchar_t - RTF uses signed ones.
-            contentBuilder << "\\u" << std::to_string(til::bit_cast<int16_t>(codeUnit)) << "?";
+            fmt::format_to(std::back_inserter(contentBuilder), FMT_COMPILE("\\u{}?"), til::bit_cast<int16_t>(codeUnit));
         }
     }
 }
@@ -2398,6 +2515,10 @@ try
 
     const auto cOldRowsTotal = cOldLastChar.y + 1;
 
+    // newBuffer usually replaces oldBuffer, possibly at the same address.
+    // Make sure that anyone holding on to the old mutation ID notices.
+    newBuffer._lastMutationId = oldBuffer._lastMutationId + 1;
+
     til::point cNewCursorPos;
     auto fFoundCursorPos = false;
     auto foundOldMutable = false;
@@ -2444,25 +2565,72 @@ try
             }
         }
 
-        // Loop through every character in the current row (up to
-        // the "right" boundary, which is one past the final valid
-        // character)
+        // Copy the current row (up to the "right" boundary, which is one past the final
+        // valid character) in as few pieces as possible: One per row of the new buffer
+        // it spans. This behaves exactly like inserting the characters one by one would,
+        // including the wrap flags and the padding of wide glyphs at the end of a row.
         til::CoordType iOldCol = 0;
         const auto copyRight = iRight;
-        for (; iOldCol < copyRight; iOldCol++)
+        while (iOldCol < copyRight)
         {
-            if (iOldCol == cOldCursorPos.x && iOldRow == cOldCursorPos.y)
+            const auto newPos = newCursor.GetPosition();
+            auto& newRow = newBuffer.GetRowByOffset(newPos.y);
+            const auto newWidth = newBuffer.GetLineWidth(newPos.y);
+
+            RowCopyTextFromState state{
+                .source = row,
+                .columnBegin = newPos.x,
+                .columnLimit = newWidth,
+                .sourceColumnBegin = iOldCol,
+                .sourceColumnLimit = copyRight,
+            };
+            newRow.CopyTextFrom(state);
+            const auto iOldColEnd = std::clamp(state.sourceColumnEnd, iOldCol, copyRight);
+            // state.columnEnd can't be used here: CopyTextFrom() reports the columnLimit whenever it
+            // didn't consume the source row up to its very end, just like ReplaceText() would.
+            // Since columns map 1:1 between the two rows, we compute it from the source side instead.
+            const auto newColEnd = newPos.x + (iOldColEnd - iOldCol);
+
+            if (iOldRow == cOldCursorPos.y && cOldCursorPos.x >= iOldCol && cOldCursorPos.x < iOldColEnd)
             {
-                cNewCursorPos = newCursor.GetPosition();
+                cNewCursorPos = { newPos.x + cOldCursorPos.x - iOldCol, newPos.y };
                 fFoundCursorPos = true;
             }
 
-            // TODO: MSFT: 19446208 - this should just use an iterator and the inserter...
-            const auto glyph = row.GlyphAt(iOldCol);
-            const auto dbcsAttr = row.DbcsAttrAt(iOldCol);
-            const auto textAttr = row.GetAttrByColumn(iOldCol);
+            if (iOldColEnd > iOldCol)
+            {
+                // Like InsertCharacter(), the attribute of the last character extends to the end of the row.
+                newRow.ReplaceAttributes(newPos.x, newColEnd, row.Attributes().slice(iOldCol, iOldColEnd));
+                newRow.SetAttrToEnd(newColEnd, row.GetAttrByColumn(iOldColEnd - 1));
+            }
+            else if (newPos.x == 0)
+            {
+                // The glyph is wider than the entire row. Drop it instead of looping forever.
+                iOldCol = row.NavigateToNext(iOldCol);
+                continue;
+            }
+
+            iOldCol = iOldColEnd;
+            newCursor.SetXPosition(newColEnd);
+
+            // If the row is full, or the next glyph doesn't fit, continue on the next one.
+            if (newColEnd >= newWidth || iOldCol < copyRight)
+            {
+                // A wide glyph that doesn't fit into the last column gets
+                // moved onto the next row, leaving a padding space behind.
+                if (newColEnd < newWidth)
+                {
+                    if (iOldRow == cOldCursorPos.y && cOldCursorPos.x == iOldCol)
+                    {
+                        cNewCursorPos = newCursor.GetPosition();
+                        fFoundCursorPos = true;
+                    }
+                    newRow.SetDoubleBytePadded(true);
+                }
 
-            newBuffer.InsertCharacter(glyph, dbcsAttr, textAttr);
+                newRow.SetWrapForced(true);
+                newBuffer.NewlineCursor();
+            }
         }
 
         // GH#32: Copy the attributes from the rest of the row into this new buffer.
@@ -2487,17 +2655,15 @@ try
         //     move on.
         const auto newRowY = newCursor.GetPosition().y;
         auto& newRow = newBuffer.GetRowByOffset(newRowY);
-        auto newAttrColumn = newCursor.GetPosition().x;
+        const auto newAttrColumn = newCursor.GetPosition().x;
         const auto newWidth = newBuffer.GetLineWidth(newRowY);
         // Stop when we get to the end of the buffer width, or the new position
         // for inserting an attr would be past the right of the new buffer.
-        for (auto copyAttrCol = iOldCol;
-             copyAttrCol < cOldColsTotal && newAttrColumn < newWidth;
-             copyAttrCol++, newAttrColumn++)
+        const auto copyAttrCount = std::min(cOldColsTotal - iOldCol, newWidth - newAttrColumn);
+        if (copyAttrCount > 0)
         {
-            // TODO: MSFT: 19446208 - this should just use an iterator and the inserter...
-            const auto textAttr = row.GetAttrByColumn(copyAttrCol);
-            newRow.SetAttrToEnd(newAttrColumn, textAttr);
+            newRow.ReplaceAttributes(newAttrColumn, newAttrColumn + copyAttrCount, row.Attributes().slice(iOldCol, iOldCol + copyAttrCount));
+            newRow.SetAttrToEnd(newAttrColumn + copyAttrCount, row.GetAttrByColumn(iOldCol + copyAttrCount - 1));
         }
 
         // If we found the old row that the caller was interested in, set the
@@ -2773,14 +2939,17 @@ void TextBuffer::CopyHyperlinkMaps(const TextBuffer& other)
 // Method Description:
 // - Adds a regex pattern we should search for
 // - The searching does not happen here, we only search when asked to by TerminalCore
+// - The pattern is compiled once here, so that GetPatterns() doesn't have to
 // Arguments:
 // - The regex pattern
 // Return value:
 // - An ID that the caller should associate with the given pattern
 const size_t TextBuffer::AddPatternRecognizer(const std::wstring_view regexString)
 {
+    std::wregex regex{ regexString.begin(), regexString.end(), std::regex_constants::ECMAScript | std::regex_constants::optimize };
     ++_currentPatternId;
-    _idsAndPatterns.emplace(std::make_pair(_currentPatternId, regexString));
+    _patternRecognizers.emplace_back(PatternRecognizer{ _currentPatternId, std::move(regex) });
+    _patternCache.clear();
     return _currentPatternId;
 }
 
@@ -2788,7 +2957,8 @@ const size_t TextBuffer::AddPatternRecognizer(const std::wstring_view regexStrin
 // - Clears the patterns we know of and resets the pattern ID counter
 void TextBuffer::ClearPatternRecognizers() noexcept
 {
-    _idsAndPatterns.clear();
+    _patternRecognizers.clear();
+    _patternCache.clear();
     _currentPatternId = 0;
 }
 
@@ -2798,12 +2968,16 @@ void TextBuffer::ClearPatternRecognizers() noexcept
 // - The other buffer
 void TextBuffer::CopyPatterns(const TextBuffer& OtherBuffer)
 {
-    _idsAndPatterns = OtherBuffer._idsAndPatterns;
+    _patternRecognizers = OtherBuffer._patternRecognizers;
+    _patternCache.clear();
     _currentPatternId = OtherBuffer._currentPatternId;
 }
 
 // Method Description:
 // - Finds patterns within the requested region of the text buffer
+// - The region is split up into logical lines (rows joined by WasWrapForced()) and
+//   the matches of each line are cached. Only lines with rows whose text changed
+//   since the last call (according to ROW::GetTextGeneration()) are searched again.
 // Arguments:
 // - The firstRow to start searching from
 // - The lastRow to search
@@ -2813,6 +2987,62 @@ PointTree TextBuffer::GetPatterns(const til::CoordType firstRow, const til::Coor
 {
     PointTree::interval_vector intervals;
 
+    if (_patternRecognizers.empty())
+    {
+        return {};
+    }
+
+    decltype(PatternCacheEntry::rows) rows;
+
+    for (auto y = firstRow; y <= lastRow;)
+    {
+        const auto lineFirstRow = y;
+
+        rows.clear();
+        for (;;)
+        {
+            const auto& row = GetRowByOffset(y);
+            rows.emplace_back(&row, row.GetTextGeneration());
+            ++y;
+            if (!row.WasWrapForced() || y > lastRow)
+            {
+                break;
+            }
+        }
+
+        auto& entry = _patternCache[rows.front().first];
+        if (entry.rows != rows)
+        {
+            entry.rows = rows;
+            entry.matches.clear();
+            _FindPatternsInRows(lineFirstRow, y - 1, entry.matches);
+        }
+
+        // NOTE: these intervals are relative to the VIEWPORT not the buffer
+        // Keeping these relative to the viewport for now because its the renderer
+        // that actually uses these locations and the renderer works relative to
+        // the viewport
+        const auto offset = lineFirstRow - firstRow;
+        for (auto interval : entry.matches)
+        {
+            interval.start.y += offset;
+            interval.stop.y += offset;
+            intervals.emplace_back(std::move(interval));
+        }
+    }
+
+    PointTree result(std::move(intervals));
+    return result;
+}
+
+// Method Description:
+// - Runs all pattern recognizers over the given rows and appends the matches to intervals.
+// Arguments:
+// - The firstRow to start searching from
+// - The lastRow to search
+// - The vector the matches are appended to. Their coordinates are relative to firstRow.
+void TextBuffer::_FindPatternsInRows(const til::CoordType firstRow, const til::CoordType lastRow, PointTree::interval_vector& intervals) const
+{
     std::wstring concatAll;
     const auto rowSize = GetRowByOffset(0).size();
     concatAll.reserve(gsl::narrow_cast<size_t>(rowSize) * gsl::narrow_cast<size_t>(lastRow - firstRow + 1));
@@ -2826,12 +3056,10 @@ PointTree TextBuffer::GetPatterns(const til::CoordType firstRow, const til::Coor
     }
 
     // for each pattern we know of, iterate through the string
-    for (const auto& idAndPattern : _idsAndPatterns)
+    for (const auto& recognizer : _patternRecognizers)
     {
-        std::wregex regexObj{ idAndPattern.second };
-
         // search through the run with our regex object
-        auto words_begin = std::wsregex_iterator(concatAll.begin(), concatAll.end(), regexObj);
+        auto words_begin = std::wsregex_iterator(concatAll.begin(), concatAll.end(), recognizer.regex);
         auto words_end = std::wsregex_iterator();
 
         til::CoordType lenUpToThis = 0;
@@ -2858,14 +3086,259 @@ PointTree TextBuffer::GetPatterns(const til::CoordType firstRow, const til::Coor
             const til::point startCoord{ start % rowSize, start / rowSize };
             const til::point endCoord{ end % rowSize, end / rowSize };
 
-            // store the intervals
-            // NOTE: these intervals are relative to the VIEWPORT not the buffer
-            // Keeping these relative to the viewport for now because its the renderer
-            // that actually uses these locations and the renderer works relative to
-            // the viewport
-            intervals.push_back(PointTree::interval(startCoord, endCoord, idAndPattern.first));
+            intervals.push_back(PointTree::interval(startCoord, endCoord, recognizer.id));
         }
     }
-    PointTree result(std::move(intervals));
-    return result;
+}
+
+uint64_t TextBuffer::GetLastMutationId() const noexcept
+{
+    return _lastMutationId;
+}
+
+#pragma warning(push)
+#pragma warning(disable : 26429) // Symbol '...' is never tested for nullness, it can be marked as not_null (f.23).
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+
+// Returns the offset of the first occurrence of needle in haystack at or after offset, or npos.
+// needle must not be empty. The SIMD loop compares the first and last character of the needle against
+// 8 positions at once and only calls wmemcmp() for the rest of the needle if both of them match.
+static size_t findSubstring(const std::wstring_view& haystack, const std::wstring_view& needle, size_t offset) noexcept
+{
+    if (haystack.size() < needle.size())
+    {
+        return std::wstring_view::npos;
+    }
+
+    const auto h = haystack.data();
+    const auto n = needle.data();
+    const auto len = needle.size();
+    // The last offset at which the needle still fits into the haystack.
+    const auto last = haystack.size() - len;
+
+#if defined(TIL_SSE_INTRINSICS)
+    if (len >= 2)
+    {
+        const auto first = _mm_set1_epi16(static_cast<short>(n[0]));
+        const auto final = _mm_set1_epi16(static_cast<short>(n[len - 1]));
+
+        // Both loads read 8 characters, the second one up to h[offset + len - 1 + 7].
+        // --> offset + 7 must be <= last for that to stay within the haystack.
+        for (; offset + 8 <= last + 1; offset += 8)
+        {
+            const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + offset));
+            const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + offset + len - 1));
+            auto mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi16(a, first), _mm_cmpeq_epi16(b, final))));
+
+            while (mask)
+            {
+                unsigned long bit;
+                _BitScanForward(&bit, mask);
+                const auto pos = offset + bit / 2;
+                if (wmemcmp(h + pos + 1, n + 1, len - 2) == 0)
+                {
+                    return pos;
+                }
+                // Each character produces 2 bits in the mask.
+                mask &= ~(3u << bit);
+            }
+        }
+    }
+#endif
+
+    for (; offset <= last; ++offset)
+    {
+        if (h[offset] == n[0] && wmemcmp(h + offset + 1, n + 1, len - 1) == 0)
+        {
+            return offset;
+        }
+    }
+
+    return std::wstring_view::npos;
+}
+
+#pragma warning(pop)
+
+// Lowercases the given string in place, the same way Search always did, one UTF-16 code unit at a time.
+static void foldCase(const std::span<wchar_t> str) noexcept
+{
+    for (auto& ch : str)
+    {
+        if (ch < 0x80)
+        {
+            ch = static_cast<wchar_t>(ch - L'A') < 26 ? static_cast<wchar_t>(ch | 0x20) : ch;
+        }
+        else
+        {
+            ch = ::towlower(ch);
+        }
+    }
+}
+
+std::vector<til::point_span> TextBuffer::SearchText(const std::wstring_view& needle, const bool caseInsensitive) const
+{
+    return SearchText(needle, caseInsensitive, 0, _height);
+}
+
+// Finds all occurrences of needle in the rows [rowBeg, rowEnd), including overlapping ones.
+// Rows that have been soft-wrapped (ROW::WasWrapForced) are joined with the following one,
+// so that matches that span soft line breaks are found as well. The resulting spans are
+// sorted and their end is inclusive, pointing at the last column of the last matched glyph.
+std::vector<til::point_span> TextBuffer::SearchText(const std::wstring_view& needle, const bool caseInsensitive, til::CoordType rowBeg, til::CoordType rowEnd) const
+{
+    std::vector<til::point_span> results;
+
+    rowBeg = std::max(0, rowBeg);
+    rowEnd = std::min<til::CoordType>(_height, rowEnd);
+    if (needle.empty() || rowBeg >= rowEnd)
+    {
+        return results;
+    }
+
+    std::wstring foldedNeedle;
+    auto needleView = needle;
+    if (caseInsensitive)
+    {
+        foldedNeedle = needle;
+        foldCase(foldedNeedle);
+        needleView = foldedNeedle;
+    }
+
+    // A logical line consisting of multiple rows (or any line when we're folding
+    // its case) is copied into this buffer. rowStarts holds the offset at which
+    // each of these rows begins in the buffer, plus the end offset of the last one.
+    std::wstring buffer;
+    til::small_vector<size_t, 4> rowStarts;
+
+    for (auto y = rowBeg; y < rowEnd;)
+    {
+        const auto lineBeg = y;
+        std::wstring_view haystack;
+
+        rowStarts.clear();
+        rowStarts.push_back(0);
+
+        const auto& firstRow = GetRowByOffset(y++);
+        if (!caseInsensitive && (!firstRow.WasWrapForced() || y >= rowEnd))
+        {
+            haystack = firstRow.GetText();
+            rowStarts.push_back(haystack.size());
+        }
+        else
+        {
+            buffer.clear();
+            for (auto row = &firstRow;; row = &GetRowByOffset(y++))
+            {
+                // A wide glyph that didn't fit at the end of a wrapped row leaves
+                // behind a padding whitespace that isn't actually part of the text.
+                const auto columns = row->size() - (row->WasDoubleBytePadded() ? 1 : 0);
+                buffer.append(row->GetText(0, columns));
+                rowStarts.push_back(buffer.size());
+                if (!row->WasWrapForced() || y >= rowEnd)
+                {
+                    break;
+                }
+            }
+            if (caseInsensitive)
+            {
+                foldCase(buffer);
+            }
+            haystack = buffer;
+        }
+
+        const auto offsetToPoint = [&](const size_t offset, const bool trailing) {
+            const auto it = std::upper_bound(rowStarts.begin(), rowStarts.end(), offset);
+            const auto index = std::max<ptrdiff_t>(0, it - rowStarts.begin() - 1);
+            const auto& row = GetRowByOffset(lineBeg + gsl::narrow_cast<til::CoordType>(index));
+            const auto charOffset = gsl::narrow_cast<ptrdiff_t>(offset - til::at(rowStarts, index));
+            const auto x = trailing ? row.GetTrailingColumnAtCharOffset(charOffset) : row.GetLeadingColumnAtCharOffset(charOffset);
+            return til::point{ x, lineBeg + gsl::narrow_cast<til::CoordType>(index) };
+        };
+
+        for (auto offset = findSubstring(haystack, needleView, 0); offset != std::wstring_view::npos; offset = findSubstring(haystack, needleView, offset + 1))
+        {
+            results.emplace_back(offsetToPoint(offset, false), offsetToPoint(offset + needleView.size() - 1, true));
+        }
+    }
+
+    return results;
+}
+
+// Returns the number of columns the given text occupies, the same way _FindPatternsInRows() measures it.
+static til::CoordType measureColumns(const std::wstring_view& str)
+{
+    til::CoordType columns = 0;
+    for (const auto& glyph : til::utf16_iterator{ str })
+    {
+        columns += IsGlyphFullWidth(glyph) ? 2 : 1;
+    }
+    return columns;
+}
+
+// Finds all non-empty matches of regex in the rows [rowBeg, rowEnd). Just like SearchText(), rows that
+// have been soft-wrapped are joined with the following one, so that matches can span soft line breaks.
+// The match offsets are mapped back to columns the same way _FindPatternsInRows() does it.
+std::vector<til::point_span> TextBuffer::SearchRegex(const std::wregex& regex, til::CoordType rowBeg, til::CoordType rowEnd) const
+{
+    std::vector<til::point_span> results;
+
+    rowBeg = std::max(0, rowBeg);
+    rowEnd = std::min<til::CoordType>(_height, rowEnd);
+    if (rowBeg >= rowEnd)
+    {
+        return results;
+    }
+
+    const til::CoordType rowSize = _width;
+    std::wstring buffer;
+
+    for (auto y = rowBeg; y < rowEnd;)
+    {
+        const auto lineBeg = y;
+        std::wstring_view haystack;
+
+        const auto& firstRow = GetRowByOffset(y++);
+        if (!firstRow.WasWrapForced() || y >= rowEnd)
+        {
+            haystack = firstRow.GetText();
+        }
+        else
+        {
+            buffer.clear();
+            for (auto row = &firstRow;; row = &GetRowByOffset(y++))
+            {
+                buffer.append(row->GetText());
+                if (!row->WasWrapForced() || y >= rowEnd)
+                {
+                    break;
+                }
+            }
+            haystack = buffer;
+        }
+
+        // The match positions are measured incrementally, starting at the end of the previous match.
+        size_t lastOffset = 0;
+        til::CoordType lastColumn = 0;
+
+        const auto end = std::wcregex_iterator{};
+        for (auto it = std::wcregex_iterator{ haystack.data(), haystack.data() + haystack.size(), regex }; it != end; ++it)
+        {
+            const auto offset = gsl::narrow_cast<size_t>(it->position());
+            const auto length = gsl::narrow_cast<size_t>(it->length());
+            if (length == 0)
+            {
+                continue;
+            }
+
+            const auto start = lastColumn + measureColumns(haystack.substr(lastOffset, offset - lastOffset));
+            const auto stop = start + measureColumns(haystack.substr(offset, length)) - 1;
+            lastOffset = offset + length;
+            lastColumn = stop + 1;
+
+            results.emplace_back(til::point{ start % rowSize, lineBeg + start / rowSize }, til::point{ stop % rowSize, lineBeg + stop / rowSize });
+        }
+    }
+
+    return results;
 }
@@ -51,6 +51,8 @@ filling in the last row, and updating the screen.
 
 #include <vector>
 
+#include <til/small_vector.h>
+
 #include "cursor.h"
 #include "Row.hpp"
 #include "TextAttribute.hpp"
@@ -100,6 +102,7 @@ public:
     static void ConsumeGrapheme(std::wstring_view& chars) noexcept;
     void Write(til::CoordType row, const TextAttribute& attributes, RowWriteState& state);
     void FillRect(const til::rect& rect, const std::wstring_view& fill, const TextAttribute& attributes);
+    void CopyRectangle(const til::rect& source, til::point target, bool clipToLineWidth = false);
 
     OutputCellIterator Write(const OutputCellIterator givenIt);
 
@@ -187,9 +190,16 @@ public:
     class TextAndColor
     {
     public:
+        // A run of consecutive UTF-16 code units in a row of text sharing the same colors.
+        struct ColorRun
+        {
+            size_t length;
+            COLORREF foreground;
+            COLORREF background;
+        };
+
         std::vector<std::wstring> text;
-        std::vector<std::vector<COLORREF>> FgAttr;
-        std::vector<std::vector<COLORREF>> BkAttr;
+        std::vector<std::vector<ColorRun>> colors;
     };
 
     size_t SpanLength(const til::point coordStart, const til::point coordEnd) const;
@@ -228,6 +238,11 @@ public:
     void CopyPatterns(const TextBuffer& OtherBuffer);
     interval_tree::IntervalTree<til::point, size_t> GetPatterns(const til::CoordType firstRow, const til::CoordType lastRow) const;
 
+    uint64_t GetLastMutationId() const noexcept;
+    std::vector<til::point_span> SearchText(const std::wstring_view& needle, bool caseInsensitive) const;
+    std::vector<til::point_span> SearchText(const std::wstring_view& needle, bool caseInsensitive, til::CoordType rowBeg, til::CoordType rowEnd) const;
+    std::vector<til::point_span> SearchRegex(const std::wregex& regex, til::CoordType rowBeg, til::CoordType rowEnd) const;
+
 private:
     void _reserve(til::size screenBufferSize, const TextAttribute& defaultAttributes);
     void _commit(const std::byte* row);
@@ -235,6 +250,9 @@ private:
     void _construct(const std::byte* until) noexcept;
     void _destroy() const noexcept;
     ROW& _getRowByOffsetDirect(size_t offset);
+    ROW& _getRowByOffset(til::CoordType index);
+    size_t _circularRowIndex(til::CoordType index) const noexcept;
+    void _rotateRows(til::CoordType begin, til::CoordType end, til::CoordType shift);
     til::CoordType _estimateOffsetOfLastCommittedRow() const noexcept;
 
     void _SetFirstRowIndex(const til::CoordType FirstRowIndex) noexcept;
@@ -251,17 +269,40 @@ private:
     til::point _GetWordEndForAccessibility(const til::point target, const std::wstring_view wordDelimiters, const til::point limit) const;
     til::point _GetWordEndForSelection(const til::point target, const std::wstring_view wordDelimiters) const;
     void _PruneHyperlinks();
+    void _FindPatternsInRows(til::CoordType firstRow, til::CoordType lastRow, std::vector<interval_tree::Interval<til::point, size_t>>& intervals) const;
 
-    static void _AppendRTFText(std::ostringstream& contentBuilder, const std::wstring_view& text);
+    static void _AppendRTFText(std::string& contentBuilder, const std::wstring_view& text);
 
     Microsoft::Console::Render::Renderer& _renderer;
 
     std::unordered_map<uint16_t, std::wstring> _hyperlinkMap;
     std::unordered_map<std::wstring, uint16_t> _hyperlinkCustomIdMap;
+    // Our ROWs hold a pointer to this table, which is why it's allocated on the heap:
+    // ResizeTraditional() can then simply take ownership of the table of the new buffer.
+    std::unique_ptr<HyperlinkRefCounts> _hyperlinkRefCounts;
     uint16_t _currentHyperlinkId = 1;
 
-    std::unordered_map<size_t, std::wstring> _idsAndPatterns;
+    struct PatternRecognizer
+    {
+        size_t id;
+        std::wregex regex;
+    };
+
+    // Pattern matches of a single logical line (a run of rows joined by WasWrapForced()),
+    // relative to the line's first row. The ROW pointers and their text generations
+    // are used to tell whether the cached matches are still valid.
+    struct PatternCacheEntry
+    {
+        til::small_vector<std::pair<const ROW*, til::generation_t>, 2> rows;
+        std::vector<interval_tree::Interval<til::point, size_t>> matches;
+    };
+
+    std::vector<PatternRecognizer> _patternRecognizers;
     size_t _currentPatternId = 0;
+    // Keyed by the first ROW of each logical line. Since ROWs are never moved during their lifetime, this
+    // only needs to be cleared when the ROWs get destroyed (_decommit, ResizeTraditional) or the set of
+    // recognizers changes. Its size is bounded by the number of rows in the buffer.
+    mutable std::unordered_map<const ROW*, PatternCacheEntry> _patternCache;
 
     // This block describes the state of the underlying virtual memory buffer that holds all ROWs, text and attributes.
     // Initially memory is only allocated with MEM_RESERVE to reduce the private working set of conhost.
@@ -315,10 +356,17 @@ private:
     size_t _bufferRowStride = 0;
     size_t _bufferOffsetChars = 0;
     size_t _bufferOffsetCharOffsets = 0;
+    // Maps the circular row index (that is: _firstRow + offset, modulo _height) to the index of the
+    // ROW in our memory arena (minus 1 for the scratchpad row). It starts out as the identity mapping.
+    // ScrollRows() then permutes this table instead of copying the contents of ROWs around.
+    std::vector<uint16_t> _rowIndices;
     // The width of the buffer in columns.
     uint16_t _width = 0;
     // The height of the buffer in rows, excluding the scratchpad row.
     uint16_t _height = 0;
+    // Incremented whenever the contents of the buffer might have changed. Code that edits ROWs directly is covered by
+    // TriggerRedraw(). This allows callers like Search to cheaply check whether their cached results are still valid.
+    uint64_t _lastMutationId = 0;
 
     TextAttribute _currentAttributes;
     til::CoordType _firstRow = 0; // indexes top row (not necessarily 0)
@@ -634,6 +634,44 @@ namespace
                     { 0, 4 } },
             },
         },
+        TestCase{
+            L"SBCS, short lines that aren't wrapped keep their line breaks",
+            {
+                TestBuffer{
+                    { 6, 5 },
+                    {
+                        { L"AB    ", false },
+                        { L"CDEFGH", false },
+                        { L"$     ", false },
+                        { L"      ", false },
+                        { L"      ", false },
+                    },
+                    { 0, 2 } // cursor on $
+                },
+                TestBuffer{
+                    { 4, 5 }, // reduce width by 2
+                    {
+                        { L"AB  ", false },
+                        { L"CDEF", true },
+                        { L"GH  ", false },
+                        { L"$   ", false },
+                        { L"    ", false },
+                    },
+                    { 0, 3 } // cursor on $
+                },
+                TestBuffer{
+                    { 8, 5 }, // grow width beyond the original
+                    {
+                        { L"AB      ", false },
+                        { L"CDEFGH  ", false },
+                        { L"$       ", false },
+                        { L"        ", false },
+                        { L"        ", false },
+                    },
+                    { 0, 2 } // cursor on $
+                },
+            },
+        },
     };
 
 #pragma region TAEF hookup for the test case array above
@@ -840,6 +878,82 @@ class ReflowTests
             _compareTextBufferAgainstTestBuffer(*textBuffer, testBuffer);
         }
     }
+
+    TEST_METHOD(ReflowShortLineAttributes)
+    {
+        const TextAttribute red{ FOREGROUND_RED | BACKGROUND_BLUE };
+        auto textBuffer = std::make_unique<TextBuffer>(til::size{ 6, 3 }, TextAttribute{ 0x7 }, 0, false, renderer);
+
+        auto& row = textBuffer->GetRowByOffset(0);
+        RowWriteState state{ .text = L"AB", .columnLimit = 6 };
+        row.ReplaceText(state);
+        row.ReplaceAttributes(0, 2, red);
+        textBuffer->GetCursor().SetPosition({ 0, 1 });
+
+        for (const auto width : { 4, 8 })
+        {
+            Log::Comment(NoThrowString().Format(L"Resizing to %d columns", width));
+            auto newBuffer = std::make_unique<TextBuffer>(til::size{ width, 3 }, TextAttribute{ 0x7 }, 0, false, renderer);
+            VERIFY_SUCCEEDED(TextBuffer::Reflow(*textBuffer, *newBuffer, std::nullopt, std::nullopt));
+            std::swap(textBuffer, newBuffer);
+
+            const auto& newRow = textBuffer->GetRowByOffset(0);
+            VERIFY_IS_FALSE(newRow.WasWrapForced());
+            VERIFY_ARE_EQUAL(width, gsl::narrow_cast<til::CoordType>(newRow.Attributes().size()));
+            VERIFY_ARE_EQUAL(red, newRow.GetAttrByColumn(0));
+            VERIFY_ARE_EQUAL(red, newRow.GetAttrByColumn(1));
+        }
+    }
+
+    // Simulates dragging the window edge with a large scrollback:
+    // A 100k row buffer gets reflowed through 10 different widths.
+    TEST_METHOD(ReflowPerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        static constexpr til::CoordType height = 100000;
+        static constexpr std::array widths{ 100, 80, 60, 40, 61, 81, 101, 121, 160, 120 };
+
+        auto textBuffer = std::make_unique<TextBuffer>(til::size{ 120, height }, TextAttribute{ 0x7 }, 0, false, renderer);
+
+        // Fill the buffer with lines of varying length, colors and wide glyphs.
+        // Every 4th line is long enough to wrap onto the next row.
+        const std::wstring text = L"The quick brown fox jumps over the lazy dog. \x30ab\x30bf\x30ab\x30ca ";
+        for (til::CoordType y = 0; y < height; ++y)
+        {
+            auto& row = textBuffer->GetRowByOffset(y);
+            std::wstring line;
+            const auto length = y % 4 == 0 ? 120 : (y * 37) % 120;
+            while (gsl::narrow_cast<til::CoordType>(line.size()) < length)
+            {
+                line.append(text);
+            }
+
+            RowWriteState state{ .text = line, .columnLimit = length };
+            row.ReplaceText(state);
+            row.ReplaceAttributes(0, 10, TextAttribute{ gsl::narrow_cast<WORD>(y % 16) });
+            row.SetWrapForced(y % 4 == 0);
+        }
+        textBuffer->GetCursor().SetPosition({ 0, height - 1 });
+
+        Log::Comment(L"Working. Please wait...");
+        long long total = 0;
+        for (const auto width : widths)
+        {
+            auto newBuffer = std::make_unique<TextBuffer>(til::size{ width, height }, TextAttribute{ 0x7 }, 0, false, renderer);
+
+            const auto start = std::chrono::steady_clock::now();
+            VERIFY_SUCCEEDED(TextBuffer::Reflow(*textBuffer, *newBuffer, std::nullopt, std::nullopt));
+            const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+            Log::Comment(NoThrowString().Format(L"Reflow to %d columns took %lld us", width, delta));
+            total += delta;
+            std::swap(textBuffer, newBuffer);
+        }
+        Log::Comment(NoThrowString().Format(L"%zu reflows took %lld us. Avg %lld us per reflow", widths.size(), total, total / gsl::narrow_cast<long long>(widths.size())));
+    }
 };
 
 DummyRenderer ReflowTests::renderer{};
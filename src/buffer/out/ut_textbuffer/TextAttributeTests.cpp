@@ -5,6 +5,7 @@
 #include "WexTestClass.h"
 #include "../../inc/consoletaeftemplates.hpp"
 #include "../../../renderer/inc/RenderSettings.hpp"
+#include "../../../types/inc/ColorFix.hpp"
 
 #include "../TextAttribute.hpp"
 
@@ -25,6 +26,11 @@ class TextAttributeTests
     TEST_METHOD(TestReverseDefaultColors);
     TEST_METHOD(TestRoundtripDefaultColors);
     TEST_METHOD(TestIntenseAsBright);
+    TEST_METHOD(TestPerceivableColorCache);
+
+    BEGIN_TEST_METHOD(PerceivableColorCachePerf)
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD()
 
     RenderSettings _renderSettings;
     const COLORREF _defaultFg = RGB(1, 2, 3);
@@ -325,3 +331,106 @@ void TextAttributeTests::TestIntenseAsBright()
     // Restore the default IntenseIsBright mode.
     _renderSettings.SetRenderMode(RenderSettings::Mode::IntenseIsBright, true);
 }
+
+void TextAttributeTests::TestPerceivableColorCache()
+{
+    if constexpr (!Feature_AdjustIndistinguishableText::IsEnabled())
+    {
+        Log::Comment(L"Indistinguishable text isn't adjusted in this build.");
+        return;
+    }
+
+    RenderSettings renderSettings;
+    renderSettings.SetRenderMode(RenderSettings::Mode::AlwaysDistinguishableColors, true);
+
+    const auto verifyColors = [&](const COLORREF fg, const COLORREF bg) {
+        TextAttribute attr{};
+        attr.SetForeground(fg);
+        attr.SetBackground(bg);
+        const auto expected = std::make_pair(ColorFix::GetPerceivableColor(fg, bg, 0.5f * 0.5f), bg);
+        // The second call is answered from the cache.
+        VERIFY_ARE_EQUAL(expected, renderSettings.GetAttributeColors(attr));
+        VERIFY_ARE_EQUAL(expected, renderSettings.GetAttributeColors(attr));
+    };
+
+    Log::Comment(L"Cached colors should match the uncached ones.");
+    verifyColors(RGB(0x10, 0x10, 0x10), RGB(0x00, 0x00, 0x00));
+    verifyColors(RGB(0x00, 0x00, 0x00), RGB(0x10, 0x10, 0x10));
+    verifyColors(RGB(0x80, 0x80, 0x80), RGB(0x88, 0x80, 0x80));
+
+    Log::Comment(L"Pairs that map to the same slot shouldn't be confused.");
+    for (auto i = 0; i < 1024; ++i)
+    {
+        const auto bg = RGB(i & 0xff, (i >> 8) * 0x20, 0x40);
+        verifyColors(bg ^ 0x020202, bg);
+    }
+
+    Log::Comment(L"Changing the color table shouldn't affect the results.");
+    renderSettings.SetColorTableEntry(TextColor::DARK_RED, RGB(0x10, 0x10, 0x10));
+    verifyColors(RGB(0x10, 0x10, 0x10), RGB(0x00, 0x00, 0x00));
+    renderSettings.ResetColorTable();
+    verifyColors(RGB(0x10, 0x10, 0x10), RGB(0x00, 0x00, 0x00));
+
+    Log::Comment(L"Copies should produce the same results.");
+    const auto copy = renderSettings;
+    TextAttribute attr{};
+    attr.SetForeground(RGB(0x10, 0x10, 0x10));
+    attr.SetBackground(RGB(0x00, 0x00, 0x00));
+    VERIFY_ARE_EQUAL(renderSettings.GetAttributeColors(attr), copy.GetAttributeColors(attr));
+}
+
+void TextAttributeTests::PerceivableColorCachePerf()
+{
+    // This simulates a colortool-style screen: every one of the 256 indexed
+    // colors as a background, with a few different foregrounds on top of it.
+    static constexpr auto frames = 100;
+
+    RenderSettings renderSettings;
+    renderSettings.SetRenderMode(RenderSettings::Mode::AlwaysDistinguishableColors, true);
+
+    std::vector<TextAttribute> runs;
+    for (BYTE bg = 0; bg < 16; ++bg)
+    {
+        for (size_t i = 0; i < 16; ++i)
+        {
+            TextAttribute attr{};
+            attr.SetIndexedBackground256(gsl::narrow_cast<BYTE>(bg * 16 + i));
+            attr.SetIndexedForeground(bg);
+            runs.emplace_back(attr);
+            attr.SetIndexedForeground256(gsl::narrow_cast<BYTE>(bg * 16 + i + 1));
+            runs.emplace_back(attr);
+            attr.SetIndexedForeground(TextColor::DARK_WHITE);
+            runs.emplace_back(attr);
+        }
+    }
+
+    const auto measure = [&](auto&& getColor) {
+        const auto start = std::chrono::steady_clock::now();
+        COLORREF checksum = 0;
+        for (auto frame = 0; frame < frames; ++frame)
+        {
+            for (const auto& attr : runs)
+            {
+                checksum ^= getColor(attr);
+            }
+        }
+        return std::make_pair(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start), checksum);
+    };
+
+    const auto [uncached, uncachedChecksum] = measure([&](const TextAttribute& attr) {
+        const auto& colorTable = renderSettings.GetColorTable();
+        const auto fg = attr.GetForeground().GetColor(colorTable, renderSettings.GetColorAliasIndex(ColorAlias::DefaultForeground));
+        const auto bg = attr.GetBackground().GetColor(colorTable, renderSettings.GetColorAliasIndex(ColorAlias::DefaultBackground));
+        return fg != bg ? ColorFix::GetPerceivableColor(fg, bg, 0.5f * 0.5f) : fg;
+    });
+    const auto [cached, cachedChecksum] = measure([&](const TextAttribute& attr) {
+        return renderSettings.GetAttributeColors(attr).first;
+    });
+
+    Log::Comment(String().Format(L"%zu runs, %d frames: %.2f ms uncached, %.2f ms cached",
+                                 runs.size(),
+                                 frames,
+                                 uncached.count(),
+                                 cached.count()));
+    VERIFY_ARE_EQUAL(uncachedChecksum, cachedChecksum);
+}
@@ -690,6 +690,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         // cleartype -> grayscale if the BG is transparent / acrylic.
         if (_renderEngine)
         {
+            const auto lock = _terminal->LockForWriting();
+            const auto engineLock = _renderer->LockEngines();
             _renderEngine->EnableTransparentBackground(_isBackgroundTransparent());
             _renderer->NotifyPaintFrame();
         }
@@ -702,6 +704,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     {
         const auto path = _settings->PixelShaderPath();
         auto lock = _terminal->LockForWriting();
+        const auto engineLock = _renderer->LockEngines();
         // Originally, this action could be used to enable the retro effects
         // even when they're set to `false` in the settings. If the user didn't
         // specify a custom pixel shader, manually enable the legacy retro
@@ -829,10 +832,13 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             return;
         }
 
-        _renderEngine->SetForceFullRepaintRendering(_settings->ForceFullRepaintRendering());
-        _renderEngine->SetSoftwareRendering(_settings->SoftwareRendering());
-        // Inform the renderer of our opacity
-        _renderEngine->EnableTransparentBackground(_isBackgroundTransparent());
+        {
+            const auto engineLock = _renderer->LockEngines();
+            _renderEngine->SetForceFullRepaintRendering(_settings->ForceFullRepaintRendering());
+            _renderEngine->SetSoftwareRendering(_settings->SoftwareRendering());
+            // Inform the renderer of our opacity
+            _renderEngine->EnableTransparentBackground(_isBackgroundTransparent());
+        }
 
         // Trigger a redraw to repaint the window background and tab colors.
         _renderer->TriggerRedrawAll(true, true);
@@ -859,6 +865,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         if (_renderEngine)
         {
             // Update DxEngine settings under the lock
+            const auto engineLock = _renderer->LockEngines();
             _renderEngine->SetSelectionBackground(til::color{ newAppearance->SelectionBackground() });
             _renderEngine->SetRetroTerminalEffect(newAppearance->RetroTerminalEffect());
             _renderEngine->SetPixelShaderPath(newAppearance->PixelShaderPath());
@@ -883,6 +890,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             break;
         }
 
+        const auto engineLock = _renderer->LockEngines();
         _renderEngine->SetAntialiasingMode(mode);
     }
 
@@ -927,6 +935,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
             // TODO: MSFT:20895307 If the font doesn't exist, this doesn't
             //      actually fail. We need a way to gracefully fallback.
+            const auto engineLock = _renderer->LockEngines();
             LOG_IF_FAILED(_renderEngine->UpdateDpi(newDpi));
             LOG_IF_FAILED(_renderEngine->UpdateFont(_desiredFont, _actualFont, featureMap, axesMap));
         }
@@ -1029,12 +1038,14 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         // Convert our new dimensions to characters
         const auto viewInPixels = Viewport::FromDimensions({ 0, 0 }, { cx, cy });
+        auto engineLock = _renderer->LockEngines();
         const auto vp = _renderEngine->GetViewportInCharacters(viewInPixels);
 
         _terminal->ClearSelection();
 
         // Tell the dx engine that our window is now the new size.
         THROW_IF_FAILED(_renderEngine->SetWindowSize({ cx, cy }));
+        engineLock.unlock();
 
         // Invalidate everything
         _renderer->TriggerRedrawAll();
@@ -1530,15 +1541,19 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     // Method Description:
     // - Search text in text buffer. This is triggered if the user click
     //   search button or press enter.
+    // - The buffer is only scanned once for all matches. As long as the query and
+    //   the buffer contents don't change, repeated calls just step through those results.
     // Arguments:
     // - text: the text to search
     // - goForward: boolean that represents if the current search direction is forward
     // - caseSensitive: boolean that represents if the current search is case sensitive
+    // - regularExpression: boolean that represents if the text is a regular expression
     // Return Value:
     // - <none>
     void ControlCore::Search(const winrt::hstring& text,
                              const bool goForward,
-                             const bool caseSensitive)
+                             const bool caseSensitive,
+                             const bool regularExpression)
     {
         if (text.size() == 0)
         {
@@ -1553,13 +1568,27 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                                      Search::Sensitivity::CaseSensitive :
                                      Search::Sensitivity::CaseInsensitive;
 
-        ::Search search(*GetRenderData(), text.c_str(), direction, sensitivity);
+        const auto mode = regularExpression ?
+                              Search::Mode::RegularExpression :
+                              Search::Mode::Literal;
+
         auto lock = _terminal->LockForWriting();
-        const auto foundMatch{ search.FindNext() };
+
+        bool foundMatch;
+        if (!_searcher || _searcher->IsStale(*GetRenderData(), text, sensitivity, mode))
+        {
+            _searcher = std::make_unique<::Search>(*GetRenderData(), text, direction, sensitivity, mode);
+            foundMatch = _searcher->FindNext();
+        }
+        else
+        {
+            foundMatch = _searcher->MoveToNextResult(direction);
+        }
+
         if (foundMatch)
         {
             _terminal->SetBlockSelection(false);
-            search.Select();
+            _searcher->Select();
 
             // this is used for search,
             // DO NOT call _updateSelectionUI() here.
@@ -1570,7 +1599,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         // Raise a FoundMatch event, which the control will use to notify
         // narrator if there was any results in the buffer
-        auto foundResults = winrt::make_self<implementation::FoundResultsArgs>(foundMatch);
+        const auto totalMatches = gsl::narrow_cast<int32_t>(_searcher->Results().size());
+        const auto currentMatch = gsl::narrow_cast<int32_t>(_searcher->CurrentResultIndex());
+        const auto invalidPattern = !_searcher->IsPatternValid();
+        auto foundResults = winrt::make_self<implementation::FoundResultsArgs>(foundMatch, totalMatches, currentMatch, invalidPattern);
         _FoundMatchHandlers(*this, *foundResults);
     }
 
@@ -1979,7 +2011,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         _terminal->ApplyScheme(scheme);
 
-        _renderEngine->SetSelectionBackground(til::color{ _settings->SelectionBackground() });
+        {
+            const auto engineLock = _renderer->LockEngines();
+            _renderEngine->SetSelectionBackground(til::color{ _settings->SelectionBackground() });
+        }
 
         _renderer->TriggerRedrawAll(true);
     }
@@ -196,7 +196,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         void Search(const winrt::hstring& text,
                     const bool goForward,
-                    const bool caseSensitive);
+                    const bool caseSensitive,
+                    const bool regularExpression);
 
         void LeftClickOnTerminal(const til::point terminalPosition,
                                  const int numberOfClicks,
@@ -308,6 +309,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         bool _isReadOnly{ false };
 
+        // The results of the last Search() call. They're reused by subsequent
+        // calls with the same query, as long as the buffer didn't change.
+        std::unique_ptr<::Search> _searcher;
+
         std::optional<interval_tree::IntervalTree<til::point, size_t>::interval> _lastHoveredInterval{ std::nullopt };
 
         // These members represent the size of the surface that we should be
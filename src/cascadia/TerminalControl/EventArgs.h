@@ -150,12 +150,18 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     struct FoundResultsArgs : public FoundResultsArgsT<FoundResultsArgs>
     {
     public:
-        FoundResultsArgs(const bool foundMatch) :
-            _FoundMatch(foundMatch)
+        FoundResultsArgs(const bool foundMatch, const int32_t totalMatches, const int32_t currentMatch, const bool invalidPattern) :
+            _FoundMatch(foundMatch),
+            _TotalMatches(totalMatches),
+            _CurrentMatch(currentMatch),
+            _InvalidPattern(invalidPattern)
         {
         }
 
         WINRT_PROPERTY(bool, FoundMatch);
+        WINRT_PROPERTY(int32_t, TotalMatches);
+        WINRT_PROPERTY(int32_t, CurrentMatch);
+        WINRT_PROPERTY(bool, InvalidPattern);
     };
 
     struct ShowWindowArgs : public ShowWindowArgsT<ShowWindowArgs>
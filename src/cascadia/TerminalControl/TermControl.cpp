@@ -368,7 +368,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         }
         else
         {
-            _core.Search(_searchBox->TextBox().Text(), goForward, false);
+            _core.Search(_searchBox->TextBox().Text(), goForward, false, false);
         }
     }
 
@@ -399,7 +399,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                               const bool goForward,
                               const bool caseSensitive)
     {
-        _core.Search(text, goForward, caseSensitive);
+        _core.Search(text, goForward, caseSensitive, false);
     }
 
     // Method Description:
@@ -3354,9 +3354,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     // - Called when the core raises a FoundMatch event. That's done in response
     //   to us starting a search query with ControlCore::Search.
     // - The args will tell us if there were or were not any results for that
-    //   particular search. We'll use that to control what to announce to
-    //   Narrator. When we have more elaborate search information to report, we
-    //   may want to report that here. (see GH #3920)
+    //   particular search, and which of them is selected. We'll use that to
+    //   control what to announce to Narrator. (see GH #3920)
     // Arguments:
     // - args: contains information about the results that were or were not found.
     // Return Value:
@@ -3365,10 +3364,24 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     {
         if (auto automationPeer{ Automation::Peers::FrameworkElementAutomationPeer::FromElement(*this) })
         {
+            // CurrentMatch is a zero-based index into the results.
+            winrt::hstring announcement;
+            if (args.InvalidPattern())
+            {
+                announcement = RS_(L"SearchBox_InvalidPattern");
+            }
+            else if (args.FoundMatch())
+            {
+                announcement = winrt::hstring{ fmt::format(std::wstring_view{ RS_(L"SearchBox_MatchIndex") }, args.CurrentMatch() + 1, args.TotalMatches()) };
+            }
+            else
+            {
+                announcement = RS_(L"SearchBox_NoMatches");
+            }
             automationPeer.RaiseNotificationEvent(
                 Automation::Peers::AutomationNotificationKind::ActionCompleted,
                 Automation::Peers::AutomationNotificationProcessing::ImportantMostRecent,
-                args.FoundMatch() ? RS_(L"SearchBox_MatchesAvailable") : RS_(L"SearchBox_NoMatches"), // what to announce if results were found
+                announcement,
                 L"SearchBoxResultAnnouncement" /* unique name for this group of notifications */);
         }
     }
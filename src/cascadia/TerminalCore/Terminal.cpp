@@ -808,6 +808,39 @@ void Terminal::FocusChanged(const bool focused)
     _handleTerminalInputResult(_terminalInput.HandleFocus(focused));
 }
 
+// Method Description:
+// - Flattens _patternIntervalTree into the per-row column boundaries returned by
+//   GetPatternBoundaries. The set of patterns at a position can only change where
+//   an interval starts or stops, so those are the only boundaries the renderer needs.
+void Terminal::_UpdatePatternBoundaries()
+{
+    std::vector<til::point> points;
+    _patternIntervalTree.visit_all([&](const PointTree::interval& interval) {
+        points.emplace_back(interval.start);
+        points.emplace_back(interval.stop);
+    });
+    std::sort(points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+
+    _patternBoundaries.clear();
+    _patternBoundaryRows.clear();
+
+    for (const auto& point : points)
+    {
+        // Rows without boundaries point at the same offset as the row after them.
+        while (gsl::narrow_cast<til::CoordType>(_patternBoundaryRows.size()) <= point.y)
+        {
+            _patternBoundaryRows.emplace_back(_patternBoundaries.size());
+        }
+        _patternBoundaries.emplace_back(point.x);
+    }
+
+    if (!_patternBoundaries.empty())
+    {
+        _patternBoundaryRows.emplace_back(_patternBoundaries.size());
+    }
+}
+
 // Method Description:
 // - Invalidates the regions described in the given pattern tree for the rendering purposes
 // Arguments:
@@ -1210,6 +1243,7 @@ void Terminal::UpdatePatternsUnderLock()
 {
     auto oldTree = _patternIntervalTree;
     _patternIntervalTree = _activeBuffer().GetPatterns(_VisibleStartIndex(), _VisibleEndIndex());
+    _UpdatePatternBoundaries();
     _InvalidatePatternTree(oldTree);
     _InvalidatePatternTree(_patternIntervalTree);
 }
@@ -1222,6 +1256,7 @@ void Terminal::ClearPatternTree()
 {
     auto oldTree = _patternIntervalTree;
     _patternIntervalTree = {};
+    _UpdatePatternBoundaries();
     _InvalidatePatternTree(oldTree);
 }
 
@@ -186,6 +186,7 @@ public:
     const std::wstring GetHyperlinkUri(uint16_t id) const override;
     const std::wstring GetHyperlinkCustomId(uint16_t id) const override;
     const std::vector<size_t> GetPatternId(const til::point location) const override;
+    std::span<const til::CoordType> GetPatternBoundaries(const til::CoordType row) const noexcept override;
 
     std::pair<COLORREF, COLORREF> GetAttributeColors(const TextAttribute& attr) const noexcept override;
     std::vector<Microsoft::Console::Types::Viewport> GetSelectionRects() noexcept override;
@@ -382,6 +383,11 @@ private:
     //      Either way, we should make this behavior controlled by a setting.
 
     interval_tree::IntervalTree<til::point, size_t> _patternIntervalTree;
+    // The start and stop columns of all intervals in _patternIntervalTree, sorted by row and column.
+    // The boundaries of row y are _patternBoundaries[_patternBoundaryRows[y]] up to _patternBoundaries[_patternBoundaryRows[y + 1]].
+    std::vector<til::CoordType> _patternBoundaries;
+    std::vector<size_t> _patternBoundaryRows;
+    void _UpdatePatternBoundaries();
     void _InvalidatePatternTree(const interval_tree::IntervalTree<til::point, size_t>& tree);
     void _InvalidateFromCoords(const til::point start, const til::point end);
 
@@ -457,6 +457,7 @@ void Terminal::NotifyBufferRotation(const int delta)
 
     // manually erase our pattern intervals since the locations have changed now
     _patternIntervalTree = {};
+    _UpdatePatternBoundaries();
 
     const auto hasScrollMarks = _scrollMarks.size() > 0;
     if (hasScrollMarks)
@@ -123,6 +123,25 @@ const std::vector<size_t> Terminal::GetPatternId(const til::point location) cons
     return {};
 }
 
+// Method Description:
+// - Gets the columns at which regex patterns begin or end in the given viewport row.
+//   Unlike GetPatternId this doesn't allocate and the renderer calls it once per row.
+// Arguments:
+// - The viewport row
+// Return value:
+// - The sorted pattern boundaries in that row
+std::span<const til::CoordType> Terminal::GetPatternBoundaries(const til::CoordType row) const noexcept
+{
+    const auto y = gsl::narrow_cast<size_t>(row);
+    if (row < 0 || y + 1 >= _patternBoundaryRows.size())
+    {
+        return {};
+    }
+    const auto data = _patternBoundaries.data();
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+    return { data + til::at(_patternBoundaryRows, y), data + til::at(_patternBoundaryRows, y + 1) };
+}
+
 std::pair<COLORREF, COLORREF> Terminal::GetAttributeColors(const TextAttribute& attr) const noexcept
 {
     return _renderSettings.GetAttributeColors(attr);
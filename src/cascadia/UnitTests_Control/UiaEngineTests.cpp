@@ -0,0 +1,165 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "../../renderer/uia/UiaRenderer.hpp"
+
+using namespace Microsoft::Console::Render;
+using namespace Microsoft::Console::Types;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using namespace WEX::Common;
+
+namespace
+{
+    // Records the notifications the UiaEngine raises.
+    class MockUiaEventDispatcher final : public IUiaEventDispatcher
+    {
+    public:
+        void SignalSelectionChanged() override {}
+        void SignalTextChanged() override {}
+        void SignalCursorChanged() override {}
+        void NotifyNewOutput(std::wstring_view newOutput) override
+        {
+            notifications.emplace_back(newOutput);
+        }
+
+        std::vector<std::wstring> notifications;
+    };
+}
+
+namespace ControlUnitTests
+{
+    class UiaEngineTests
+    {
+        TEST_CLASS(UiaEngineTests);
+
+        TEST_METHOD(TestPendingOutputLimit);
+        TEST_METHOD(TestCollapseIdenticalLines);
+        TEST_METHOD(TestPendingOutputPerformance);
+
+        // Runs a single frame, the same way the Renderer does.
+        static void _paintFrame(UiaEngine& engine)
+        {
+            if (engine.StartPaint() == S_OK)
+            {
+                VERIFY_SUCCEEDED(engine.EndPaint());
+                VERIFY_SUCCEEDED(engine.Present());
+            }
+        }
+    };
+
+    void UiaEngineTests::TestPendingOutputLimit()
+    {
+        MockUiaEventDispatcher dispatcher;
+        UiaEngine engine{ &dispatcher };
+        engine.SetPendingOutputLimit(12);
+
+        Log::Comment(L"Output within the limit is announced as is.");
+        VERIFY_SUCCEEDED(engine.NotifyNewText(L"aaaa"));
+        VERIFY_SUCCEEDED(engine.NotifyNewText(L"bbbb"));
+        _paintFrame(engine);
+        VERIFY_ARE_EQUAL(1u, dispatcher.notifications.size());
+        VERIFY_ARE_EQUAL(L"aaaa\nbbbb\n", dispatcher.notifications.back());
+
+        Log::Comment(L"The oldest lines are dropped first.");
+        VERIFY_SUCCEEDED(engine.NotifyNewText(L"cccc"));
+        VERIFY_SUCCEEDED(engine.NotifyNewText(L"dddd"));
+        VERIFY_SUCCEEDED(engine.NotifyNewText(L"eeee"));
+        _paintFrame(engine);
+        VERIFY_ARE_EQUAL(2u, dispatcher.notifications.size());
+        VERIFY_ARE_EQUAL(L"dddd\neeee\n", dispatcher.notifications.back());
+
+        Log::Comment(L"A single line longer than the limit is cut.");
+        VERIFY_SUCCEEDED(engine.NotifyNewText(L"0123456789abcdef"));
+        _paintFrame(engine);
+        VERIFY_ARE_EQUAL(3u, dispatcher.notifications.size());
+        VERIFY_ARE_EQUAL(L"56789abcdef\n", dispatcher.notifications.back());
+
+        Log::Comment(L"A limit of 0 disables the limit.");
+        engine.SetPendingOutputLimit(0);
+        const std::wstring line(100, L'x');
+        for (auto i = 0; i < 10; ++i)
+        {
+            VERIFY_SUCCEEDED(engine.NotifyNewText(line));
+            VERIFY_SUCCEEDED(engine.NotifyNewText(L"y"));
+        }
+        _paintFrame(engine);
+        VERIFY_ARE_EQUAL(5u, dispatcher.notifications.size());
+        VERIFY_ARE_EQUAL(30u, dispatcher.notifications.back().size());
+    }
+
+    void UiaEngineTests::TestCollapseIdenticalLines()
+    {
+        MockUiaEventDispatcher dispatcher;
+        UiaEngine engine{ &dispatcher };
+
+        for (auto i = 0; i < 100; ++i)
+        {
+            VERIFY_SUCCEEDED(engine.NotifyNewText(L"Loading..."));
+        }
+        VERIFY_SUCCEEDED(engine.NotifyNewText(L"Done"));
+        VERIFY_SUCCEEDED(engine.NotifyNewText(L"Done"));
+        VERIFY_SUCCEEDED(engine.NotifyNewText(L"one"));
+        _paintFrame(engine);
+
+        VERIFY_ARE_EQUAL(1u, dispatcher.notifications.size());
+        VERIFY_ARE_EQUAL(L"Loading...\nDone\none\n", dispatcher.notifications.back());
+
+        Log::Comment(L"Identical lines are announced again in the next frame.");
+        VERIFY_SUCCEEDED(engine.NotifyNewText(L"one"));
+        _paintFrame(engine);
+        VERIFY_ARE_EQUAL(2u, dispatcher.notifications.size());
+        VERIFY_ARE_EQUAL(L"one\n", dispatcher.notifications.back());
+    }
+
+    // Simulates `cat bigfile` with a screen reader attached: 1M lines of
+    // output with a frame every 10k lines. Memory must stay flat and
+    // each frame must only announce a bounded amount of text.
+    void UiaEngineTests::TestPendingOutputPerformance()
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        MockUiaEventDispatcher dispatcher;
+        UiaEngine engine{ &dispatcher };
+
+        static constexpr auto lineCount = 1000000;
+        static constexpr auto linesPerFrame = 10000;
+
+        std::wstring line(80, L'x');
+        size_t peakCapacity = 0;
+        long long frameTime = 0;
+        size_t maxNotificationsPerFrame = 0;
+
+        Log::Comment(L"Working. Please wait...");
+        const auto start = std::chrono::steady_clock::now();
+
+        for (auto i = 0; i < lineCount; ++i)
+        {
+            // Make every line unique, so that none of them get collapsed.
+            line[i % line.size()]++;
+            VERIFY_SUCCEEDED(engine.NotifyNewText(line));
+            peakCapacity = std::max(peakCapacity, engine._newOutput.capacity());
+
+            if ((i + 1) % linesPerFrame == 0)
+            {
+                const auto notificationsBefore = dispatcher.notifications.size();
+                const auto frameStart = std::chrono::steady_clock::now();
+                _paintFrame(engine);
+                frameTime = std::max(frameTime, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - frameStart).count());
+                maxNotificationsPerFrame = std::max(maxNotificationsPerFrame, dispatcher.notifications.size() - notificationsBefore);
+                dispatcher.notifications.clear();
+            }
+        }
+
+        const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        Log::Comment(NoThrowString().Format(L"%d lines took %lld us. Avg %lld ns per line", lineCount, delta, delta * 1000 / lineCount));
+        Log::Comment(NoThrowString().Format(L"Slowest frame took %lld us and raised %zu notifications", frameTime, maxNotificationsPerFrame));
+        Log::Comment(NoThrowString().Format(L"Peak pending output capacity: %zu characters", peakCapacity));
+
+        VERIFY_IS_LESS_THAN_OR_EQUAL(maxNotificationsPerFrame, UiaEngine::DefaultPendingOutputLimit / UiaEngine::SapiLimit);
+        VERIFY_IS_LESS_THAN_OR_EQUAL(peakCapacity, 4 * UiaEngine::DefaultPendingOutputLimit);
+    }
+}
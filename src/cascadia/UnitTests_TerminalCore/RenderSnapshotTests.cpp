@@ -0,0 +1,288 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include <WexTestClass.h>
+
+#include "../renderer/base/Renderer.hpp"
+#include "../renderer/inc/RenderEngineBase.hpp"
+
+#include "../cascadia/TerminalCore/Terminal.hpp"
+#include "consoletaeftemplates.hpp"
+#include "../../inc/TestUtils.h"
+
+using namespace Microsoft::Terminal::Core;
+using namespace Microsoft::Console::Render;
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+namespace
+{
+    // Records the text and colors of each painted row, so that
+    // two engines painted from the same state can be compared.
+    class MockPaintEngine final : public RenderEngineBase
+    {
+    public:
+        MockPaintEngine(const bool supportsSnapshotPainting, const bool continuousRedraw, const til::size size) :
+            _supportsSnapshotPainting{ supportsSnapshotPainting },
+            _continuousRedraw{ continuousRedraw },
+            _dirtyArea{ til::point{}, size },
+            rows(gsl::narrow_cast<size_t>(size.height)),
+            colors(gsl::narrow_cast<size_t>(size.height))
+        {
+        }
+
+        bool SupportsSnapshotPainting() const noexcept override { return _supportsSnapshotPainting; }
+        bool RequiresContinuousRedraw() noexcept override { return _continuousRedraw; }
+        void WaitUntilCanRender() noexcept override {}
+
+        HRESULT StartPaint() noexcept override
+        {
+            for (auto& row : rows)
+            {
+                row.clear();
+            }
+            for (auto& row : colors)
+            {
+                row.clear();
+            }
+            underlines.clear();
+            return S_OK;
+        }
+        HRESULT EndPaint() noexcept override
+        {
+            frames++;
+            return S_OK;
+        }
+        HRESULT Present() noexcept override { return S_OK; }
+        HRESULT PrepareForTeardown(_Out_ bool* pForcePaint) noexcept override
+        {
+            *pForcePaint = false;
+            return S_OK;
+        }
+        HRESULT ScrollFrame() noexcept override { return S_OK; }
+        HRESULT Invalidate(const til::rect* /*psrRegion*/) noexcept override { return S_OK; }
+        HRESULT InvalidateCursor(const til::rect* /*psrRegion*/) noexcept override { return S_OK; }
+        HRESULT InvalidateSystem(const til::rect* /*prcDirtyClient*/) noexcept override { return S_OK; }
+        HRESULT InvalidateSelection(const std::vector<til::rect>& /*rectangles*/) noexcept override { return S_OK; }
+        HRESULT InvalidateScroll(const til::point* /*pcoordDelta*/) noexcept override { return S_OK; }
+        HRESULT InvalidateAll() noexcept override { return S_OK; }
+        HRESULT PaintBackground() noexcept override { return S_OK; }
+        HRESULT PaintBufferLine(std::span<const Cluster> clusters, til::point coord, bool /*fTrimLeft*/, bool /*lineWrapped*/) noexcept override
+        try
+        {
+            auto& row = rows.at(gsl::narrow_cast<size_t>(coord.y));
+            for (const auto& cluster : clusters)
+            {
+                row.append(cluster.GetText());
+            }
+            colors.at(gsl::narrow_cast<size_t>(coord.y)).emplace_back(_foreground);
+            return S_OK;
+        }
+        CATCH_RETURN()
+        HRESULT PaintBufferGridLines(GridLineSet lines, COLORREF /*color*/, size_t /*cchLine*/, til::point coordTarget) noexcept override
+        try
+        {
+            if (lines.test(GridLines::Underline))
+            {
+                underlines.emplace_back(coordTarget);
+            }
+            return S_OK;
+        }
+        CATCH_RETURN()
+        HRESULT PaintSelection(const til::rect& /*rect*/) noexcept override { return S_OK; }
+        HRESULT PaintCursor(const CursorOptions& options) noexcept override
+        {
+            cursor = options.coordCursor;
+            return S_OK;
+        }
+        HRESULT UpdateDrawingBrushes(const TextAttribute& textAttributes, const RenderSettings& renderSettings, gsl::not_null<IRenderData*> /*pData*/, bool /*usingSoftFont*/, bool /*isSettingDefaultBrushes*/) noexcept override
+        {
+            _foreground = renderSettings.GetAttributeColors(textAttributes).first;
+            return S_OK;
+        }
+        HRESULT UpdateFont(const FontInfoDesired& /*FontInfoDesired*/, _Out_ FontInfo& /*FontInfo*/) noexcept override { return S_OK; }
+        HRESULT UpdateDpi(int /*iDpi*/) noexcept override { return S_OK; }
+        HRESULT UpdateViewport(const til::inclusive_rect& /*srNewViewport*/) noexcept override { return S_OK; }
+        HRESULT GetProposedFont(const FontInfoDesired& /*FontInfoDesired*/, _Out_ FontInfo& /*FontInfo*/, int /*iDpi*/) noexcept override { return S_OK; }
+        HRESULT GetDirtyArea(std::span<const til::rect>& area) noexcept override
+        {
+            area = { &_dirtyArea, 1 };
+            return S_OK;
+        }
+        HRESULT GetFontSize(_Out_ til::size* /*pFontSize*/) noexcept override { return S_OK; }
+        HRESULT IsGlyphWideByFont(std::wstring_view /*glyph*/, _Out_ bool* /*pResult*/) noexcept override { return S_OK; }
+
+        std::vector<std::wstring> rows;
+        std::vector<std::vector<COLORREF>> colors;
+        std::vector<til::point> underlines;
+        til::point cursor;
+        std::atomic<size_t> frames{ 0 };
+
+    protected:
+        HRESULT _DoUpdateTitle(const std::wstring_view /*newTitle*/) noexcept override { return S_OK; }
+
+    private:
+        bool _supportsSnapshotPainting;
+        bool _continuousRedraw;
+        til::rect _dirtyArea;
+        COLORREF _foreground = 0;
+    };
+}
+
+namespace TerminalCoreUnitTests
+{
+    class RenderSnapshotTests;
+};
+using namespace TerminalCoreUnitTests;
+
+class TerminalCoreUnitTests::RenderSnapshotTests final
+{
+    static constexpr til::CoordType TerminalViewWidth = 120;
+    static constexpr til::CoordType TerminalViewHeight = 30;
+    static constexpr til::CoordType TerminalHistoryLength = 9001;
+
+    TEST_CLASS(RenderSnapshotTests);
+
+    TEST_METHOD(SnapshotPaintMatchesLockedPaint);
+    TEST_METHOD(HoveredPatternEndsAtItsStop);
+
+    BEGIN_TEST_METHOD(WriteThroughputWhileRendering)
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD()
+
+private:
+    static std::wstring _makeOutput(size_t lines)
+    {
+        std::wstring output;
+        for (size_t i = 0; i < lines; ++i)
+        {
+            output.append(L"\x1b[3");
+            output.append(std::to_wstring(i % 8));
+            output.append(L"mline ");
+            output.append(std::to_wstring(i));
+            output.append(L"\x1b[m the quick brown fox \x1b[1;4mjumps\x1b[m over the lazy dog\r\n");
+        }
+        return output;
+    }
+
+    static double _measureWriteThroughput(const bool supportsSnapshotPainting, const std::wstring_view output, size_t& frames);
+};
+
+void RenderSnapshotTests::SnapshotPaintMatchesLockedPaint()
+{
+    Terminal term;
+    Renderer renderer{ term.GetRenderSettings(), &term, nullptr, 0, nullptr };
+    term.Create({ TerminalViewWidth, TerminalViewHeight }, TerminalHistoryLength, renderer);
+
+    MockPaintEngine lockedEngine{ false, false, { TerminalViewWidth, TerminalViewHeight } };
+    MockPaintEngine snapshotEngine{ true, false, { TerminalViewWidth, TerminalViewHeight } };
+    renderer.AddRenderEngine(&lockedEngine);
+    renderer.AddRenderEngine(&snapshotEngine);
+    renderer.EnablePainting();
+
+    // Enough output to scroll the viewport down into the scrollback,
+    // so that the snapshot rows are offset from the buffer rows.
+    term.Write(_makeOutput(100));
+    term.Write(L"\x1b[42m\u304b\u304b\x1b[m tail");
+
+    Log::Comment(L"Painting both engines. The second one is painted outside of the console lock.");
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+    VERIFY_ARE_EQUAL(size_t{ 1 }, lockedEngine.frames.load());
+    VERIFY_ARE_EQUAL(size_t{ 1 }, snapshotEngine.frames.load());
+    VERIFY_ARE_EQUAL(lockedEngine.cursor, snapshotEngine.cursor);
+
+    for (size_t y = 0; y < lockedEngine.rows.size(); ++y)
+    {
+        VERIFY_ARE_EQUAL(lockedEngine.rows[y], snapshotEngine.rows[y]);
+        VERIFY_IS_TRUE(lockedEngine.colors[y] == snapshotEngine.colors[y]);
+    }
+
+    Log::Comment(L"Calls that arrive while an engine is painted from a snapshot are replayed on the next frame.");
+    term.Write(L"\r\nmore");
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+    VERIFY_ARE_EQUAL(lockedEngine.cursor, snapshotEngine.cursor);
+    for (size_t y = 0; y < lockedEngine.rows.size(); ++y)
+    {
+        VERIFY_ARE_EQUAL(lockedEngine.rows[y], snapshotEngine.rows[y]);
+    }
+}
+
+void RenderSnapshotTests::HoveredPatternEndsAtItsStop()
+{
+    Terminal term;
+    Renderer renderer{ term.GetRenderSettings(), &term, nullptr, 0, nullptr };
+    term.Create({ TerminalViewWidth, TerminalViewHeight }, TerminalHistoryLength, renderer);
+
+    MockPaintEngine lockedEngine{ false, false, { TerminalViewWidth, TerminalViewHeight } };
+    MockPaintEngine snapshotEngine{ true, false, { TerminalViewWidth, TerminalViewHeight } };
+    renderer.AddRenderEngine(&lockedEngine);
+    renderer.AddRenderEngine(&snapshotEngine);
+    renderer.EnablePainting();
+
+    const auto id = term.GetTextBuffer().AddPatternRecognizer(LR"(\bhttps?://[A-Za-z0-9./]*[A-Za-z0-9/])");
+    term.Write(L"see http://a.com next");
+    term.UpdatePatternsUnderLock();
+
+    Log::Comment(L"Hovering the link in columns [4, 16). The run starting at its stop must not be underlined.");
+    renderer.UpdateLastHoveredInterval(interval_tree::IntervalTree<til::point, size_t>::interval{ { 4, 0 }, { 16, 0 }, id });
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+    for (const auto engine : { &lockedEngine, &snapshotEngine })
+    {
+        VERIFY_ARE_EQUAL(size_t{ 1 }, engine->underlines.size());
+        VERIFY_ARE_EQUAL(til::point(4, 0), engine->underlines[0]);
+    }
+}
+
+double RenderSnapshotTests::_measureWriteThroughput(const bool supportsSnapshotPainting, const std::wstring_view output, size_t& frames)
+{
+    Terminal term;
+    auto thread = std::make_unique<RenderThread>();
+    auto* const localPointerToThread = thread.get();
+    MockPaintEngine engine{ supportsSnapshotPainting, true, { TerminalViewWidth, TerminalViewHeight } };
+
+    {
+        Renderer renderer{ term.GetRenderSettings(), &term, nullptr, 0, std::move(thread) };
+        term.Create({ TerminalViewWidth, TerminalViewHeight }, TerminalHistoryLength, renderer);
+        renderer.AddRenderEngine(&engine);
+        VERIFY_SUCCEEDED(localPointerToThread->Initialize(&renderer));
+        renderer.EnablePainting();
+
+        // Write in chunks about the size of what a connection hands us at once.
+        static constexpr size_t chunkSize = 4096;
+
+        const auto beg = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < output.size(); i += chunkSize)
+        {
+            term.Write(output.substr(i, chunkSize));
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        frames = engine.frames.load();
+        renderer.WaitForPaintCompletionAndDisable(INFINITE);
+
+        const auto seconds = std::chrono::duration<double>(end - beg).count();
+        return output.size() * sizeof(wchar_t) / seconds / (1024.0 * 1024.0);
+    }
+}
+
+void RenderSnapshotTests::WriteThroughputWhileRendering()
+{
+    const auto output = _makeOutput(100000);
+
+    size_t lockedFrames = 0;
+    size_t snapshotFrames = 0;
+    const auto locked = _measureWriteThroughput(false, output, lockedFrames);
+    const auto snapshot = _measureWriteThroughput(true, output, snapshotFrames);
+
+    Log::Comment(String().Format(L"Painting under the console lock: %.1f MB/s (%zu frames)", locked, lockedFrames));
+    Log::Comment(String().Format(L"Painting from a snapshot: %.1f MB/s (%zu frames)", snapshot, snapshotFrames));
+
+    VERIFY_IS_GREATER_THAN(lockedFrames, size_t{ 0 });
+    VERIFY_IS_GREATER_THAN(snapshotFrames, size_t{ 0 });
+}
@@ -41,6 +41,8 @@ namespace TerminalCoreUnitTests
 
         TEST_METHOD(SetTaskbarProgress);
         TEST_METHOD(SetWorkingDirectory);
+
+        TEST_METHOD(GetPatternBoundaries);
     };
 };
 
@@ -476,3 +478,33 @@ void TerminalCoreUnitTests::TerminalApiTest::SetWorkingDirectory()
     stateMachine.ProcessString(L"\x1b]9;9;D:\\中文\x1b\\");
     VERIFY_ARE_EQUAL(term.GetWorkingDirectory(), L"D:\\中文");
 }
+
+void TerminalCoreUnitTests::TerminalApiTest::GetPatternBoundaries()
+{
+    Terminal term;
+    DummyRenderer renderer{ &term };
+    term.Create({ 100, 100 }, 0, renderer);
+
+    auto& tbi = *(term._mainBuffer);
+    auto& stateMachine = *(term._stateMachine);
+
+    tbi.AddPatternRecognizer(LR"(\bhttps?://[A-Za-z0-9./]*[A-Za-z0-9/])");
+    stateMachine.ProcessString(L"see http://a.com and http://b.org\r\n\r\nhttps://c.net");
+    term.UpdatePatternsUnderLock();
+
+    const auto verifyBoundaries = [&](til::CoordType row, std::initializer_list<til::CoordType> expected) {
+        const auto actual = term.GetPatternBoundaries(row);
+        VERIFY_ARE_EQUAL(expected.size(), actual.size());
+        VERIFY_IS_TRUE(std::equal(expected.begin(), expected.end(), actual.begin(), actual.end()));
+    };
+
+    verifyBoundaries(-1, {});
+    verifyBoundaries(0, { 4, 16, 21, 33 });
+    verifyBoundaries(1, {});
+    verifyBoundaries(2, { 0, 13 });
+    verifyBoundaries(3, {});
+    verifyBoundaries(99, {});
+
+    term.ClearPatternTree();
+    verifyBoundaries(0, {});
+}
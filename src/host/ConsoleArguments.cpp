@@ -20,6 +20,7 @@ const std::wstring_view ConsoleArguments::WIDTH_ARG = L"--width";
 const std::wstring_view ConsoleArguments::HEIGHT_ARG = L"--height";
 const std::wstring_view ConsoleArguments::INHERIT_CURSOR_ARG = L"--inheritcursor";
 const std::wstring_view ConsoleArguments::RESIZE_QUIRK = L"--resizeQuirk";
+const std::wstring_view ConsoleArguments::FRAME_DIFF_ARG = L"--frameDiff";
 const std::wstring_view ConsoleArguments::FEATURE_ARG = L"--feature";
 const std::wstring_view ConsoleArguments::FEATURE_PTY_ARG = L"pty";
 const std::wstring_view ConsoleArguments::COM_SERVER_ARG = L"-Embedding";
@@ -514,6 +515,12 @@ void ConsoleArguments::s_ConsumeArg(_Inout_ std::vector<std::wstring>& args, _In
             s_ConsumeArg(args, i);
             hr = S_OK;
         }
+        else if (arg == FRAME_DIFF_ARG)
+        {
+            _frameDiff = true;
+            s_ConsumeArg(args, i);
+            hr = S_OK;
+        }
         else if (arg == CLIENT_COMMANDLINE_ARG)
         {
             // Everything after this is the explicit commandline
@@ -670,6 +677,10 @@ bool ConsoleArguments::IsResizeQuirkEnabled() const
 {
     return _resizeQuirk;
 }
+bool ConsoleArguments::IsFrameDiffEnabled() const
+{
+    return _frameDiff;
+}
 
 #ifdef UNIT_TESTING
 // Method Description:
@@ -55,6 +55,7 @@ public:
     short GetHeight() const;
     bool GetInheritCursor() const;
     bool IsResizeQuirkEnabled() const;
+    bool IsFrameDiffEnabled() const;
 
 #ifdef UNIT_TESTING
     void EnableConptyModeForTests();
@@ -73,6 +74,7 @@ public:
     static const std::wstring_view HEIGHT_ARG;
     static const std::wstring_view INHERIT_CURSOR_ARG;
     static const std::wstring_view RESIZE_QUIRK;
+    static const std::wstring_view FRAME_DIFF_ARG;
     static const std::wstring_view FEATURE_ARG;
     static const std::wstring_view FEATURE_PTY_ARG;
     static const std::wstring_view COM_SERVER_ARG;
@@ -142,6 +144,7 @@ private:
     DWORD _signalHandle;
     bool _inheritCursor;
     bool _resizeQuirk{ false };
+    bool _frameDiff{ false };
 
     [[nodiscard]] HRESULT _GetClientCommandline(_Inout_ std::vector<std::wstring>& args,
                                                 const size_t index,
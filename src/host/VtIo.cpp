@@ -71,6 +71,7 @@ VtIo::VtIo() :
 {
     _lookingForCursorPosition = pArgs->GetInheritCursor();
     _resizeQuirk = pArgs->IsResizeQuirkEnabled();
+    _frameDiff = pArgs->IsFrameDiffEnabled();
     _passthroughMode = pArgs->IsPassthroughMode();
 
     // If we were already given VT handles, set up the VT IO engine to use those.
@@ -217,6 +218,17 @@ VtIo::VtIo() :
             {
                 _pVtRenderEngine->SetTerminalOwner(this);
                 _pVtRenderEngine->SetResizeQuirk(_resizeQuirk);
+                // Frame diffing relies on us knowing what the terminal
+                // displays, which passthrough mode doesn't guarantee.
+                _pVtRenderEngine->SetFrameDiffing(_frameDiff && !_passthroughMode);
+                // Frames skipped while the terminal was backed up still need
+                // to be painted once it has caught up with our output.
+                _pVtRenderEngine->SetOutputDrainedCallback([]() {
+                    if (const auto pRender = ServiceLocator::LocateGlobals().pRender)
+                    {
+                        pRender->NotifyPaintFrame();
+                    }
+                });
             }
         }
     }
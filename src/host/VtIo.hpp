@@ -67,6 +67,7 @@ namespace Microsoft::Console::VirtualTerminal
         bool _lookingForCursorPosition;
 
         bool _resizeQuirk{ false };
+        bool _frameDiff{ false };
         bool _passthroughMode{ false };
         bool _closeEventSent{ false };
 
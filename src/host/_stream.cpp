@@ -408,7 +408,7 @@ try
                     pos.x = 0;
                 }
 
-                textBuffer.GetRowByOffset(pos.y).SetWrapForced(false);
+                textBuffer.SetWrapForced(pos.y, false);
                 pos.y = pos.y + 1;
                 AdjustCursorPosition(screenInfo, pos, keepCursorVisible, psScrollY);
                 continue;
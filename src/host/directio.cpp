@@ -289,9 +289,25 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 
     try
     {
-        auto events = IInputEvent::Create(buffer);
+        // The records can be stored as-is, without turning each of them into an IInputEvent first.
+        // We still need to reject the event types IInputEvent::Create() wouldn't accept when they're read.
+        for (const auto& record : buffer)
+        {
+            switch (record.EventType)
+            {
+            case KEY_EVENT:
+            case MOUSE_EVENT:
+            case WINDOW_BUFFER_SIZE_EVENT:
+            case MENU_EVENT:
+            case FOCUS_EVENT:
+                break;
+            default:
+                return E_INVALIDARG;
+            }
+        }
 
-        return _WriteConsoleInputWImplHelper(context, events, written, append);
+        written = append ? context.Write(buffer) : context.Prepend(buffer);
+        return S_OK;
     }
     CATCH_RETURN();
 }
@@ -7,6 +7,8 @@
 #include "stream.h"
 #include "../types/inc/GlyphWidth.hpp"
 
+#include <bit>
+
 #include <til/bytes.h>
 
 #include "misc.h"
@@ -18,6 +20,116 @@ using Microsoft::Console::Interactivity::ServiceLocator;
 using Microsoft::Console::VirtualTerminal::TerminalInput;
 using namespace Microsoft::Console;
 
+size_t InputRecordRing::size() const noexcept
+{
+    return _size;
+}
+
+bool InputRecordRing::empty() const noexcept
+{
+    return _size == 0;
+}
+
+#pragma warning(push)
+#pragma warning(disable : 26446) // Prefer to use gsl::at() instead of unchecked subscript operator (bounds.4).
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+
+INPUT_RECORD& InputRecordRing::operator[](size_t index) noexcept
+{
+    assert(index < _size);
+    return _buffer[(_head + index) & (_capacity - 1)];
+}
+
+const INPUT_RECORD& InputRecordRing::operator[](size_t index) const noexcept
+{
+    assert(index < _size);
+    return _buffer[(_head + index) & (_capacity - 1)];
+}
+
+INPUT_RECORD& InputRecordRing::front() noexcept
+{
+    return (*this)[0];
+}
+
+INPUT_RECORD& InputRecordRing::back() noexcept
+{
+    return (*this)[_size - 1];
+}
+
+void InputRecordRing::push_back(const INPUT_RECORD& record)
+{
+    if (_size == _capacity)
+    {
+        _reserve(_size + 1);
+    }
+    _buffer[(_head + _size) & (_capacity - 1)] = record;
+    _size++;
+}
+
+void InputRecordRing::append(std::span<const INPUT_RECORD> records)
+{
+    if (records.empty())
+    {
+        return;
+    }
+    if (_capacity - _size < records.size())
+    {
+        _reserve(_size + records.size());
+    }
+
+    // The free space may wrap around the end of the buffer, in which case we need 2 copies.
+    const auto tail = (_head + _size) & (_capacity - 1);
+    const auto first = std::min(records.size(), _capacity - tail);
+    std::copy_n(records.data(), first, _buffer.get() + tail);
+    std::copy_n(records.data() + first, records.size() - first, _buffer.get());
+    _size += records.size();
+}
+
+void InputRecordRing::pop_front(size_t count) noexcept
+{
+    count = std::min(count, _size);
+    _size -= count;
+
+    if (_size == 0)
+    {
+        _head = 0;
+        // Pasting large amounts of text can grow the buffer to many MB. Don't hold onto that forever.
+        if (_capacity > 4096)
+        {
+            _buffer.reset();
+            _capacity = 0;
+        }
+    }
+    else
+    {
+        _head = (_head + count) & (_capacity - 1);
+    }
+}
+
+void InputRecordRing::clear() noexcept
+{
+    _head = 0;
+    _size = 0;
+}
+
+void InputRecordRing::_reserve(size_t capacity)
+{
+    // Grow at least by a factor of 2 to get amortized O(1) push_back().
+    const auto newCapacity = std::bit_ceil(std::max<size_t>({ capacity, _capacity * 2, 16 }));
+    auto newBuffer = std::make_unique_for_overwrite<INPUT_RECORD[]>(newCapacity);
+
+    // Unwrap the existing contents so that they start at index 0 of the new buffer.
+    const auto first = std::min(_size, _capacity - _head);
+    std::copy_n(_buffer.get() + _head, first, newBuffer.get());
+    std::copy_n(_buffer.get(), _size - first, newBuffer.get() + first);
+
+    _buffer = std::move(newBuffer);
+    _capacity = newCapacity;
+    _head = 0;
+}
+
+#pragma warning(pop)
+
 // Routine Description:
 // - This method creates an input buffer.
 // Arguments:
@@ -157,16 +269,15 @@ size_t InputBuffer::ConsumeCached(bool isUnicode, size_t count, InputEventQueue&
 {
     _switchReadingMode(isUnicode ? ReadingMode::InputEventsW : ReadingMode::InputEventsA);
 
-    size_t i = 0;
+    const auto n = std::min(count, _cachedInputEvents.size());
 
-    while (i < count && !_cachedInputEvents.empty())
+    for (size_t i = 0; i < n; i++)
     {
-        target.push_back(std::move(_cachedInputEvents.front()));
-        _cachedInputEvents.pop_front();
-        i++;
+        target.push_back(IInputEvent::Create(_cachedInputEvents[i]));
     }
 
-    return i;
+    _cachedInputEvents.pop_front(n);
+    return n;
 }
 
 // Copies up to `count`, previously cached events into `target`.
@@ -174,20 +285,14 @@ size_t InputBuffer::PeekCached(bool isUnicode, size_t count, InputEventQueue& ta
 {
     _switchReadingMode(isUnicode ? ReadingMode::InputEventsW : ReadingMode::InputEventsA);
 
-    size_t i = 0;
+    const auto n = std::min(count, _cachedInputEvents.size());
 
-    for (const auto& e : _cachedInputEvents)
+    for (size_t i = 0; i < n; i++)
     {
-        if (i >= count)
-        {
-            break;
-        }
-
-        target.push_back(IInputEvent::Create(e->ToInputRecord()));
-        i++;
+        target.push_back(IInputEvent::Create(_cachedInputEvents[i]));
     }
 
-    return i;
+    return n;
 }
 
 // Trims `source` to have a size below or equal to `expectedSourceSize` by
@@ -198,10 +303,10 @@ void InputBuffer::Cache(bool isUnicode, InputEventQueue& source, size_t expected
 
     if (source.size() > expectedSourceSize)
     {
-        _cachedInputEvents.insert(
-            _cachedInputEvents.end(),
-            std::make_move_iterator(source.begin() + expectedSourceSize),
-            std::make_move_iterator(source.end()));
+        for (auto it = source.begin() + expectedSourceSize; it != source.end(); ++it)
+        {
+            _cachedInputEvents.push_back((*it)->ToInputRecord());
+        }
         source.resize(expectedSourceSize);
     }
 }
@@ -222,7 +327,7 @@ void InputBuffer::_switchReadingModeSlowPath(ReadingMode mode)
     _cachedTextW = std::wstring{};
     _cachedTextReaderW = {};
 
-    _cachedInputEvents = std::deque<std::unique_ptr<IInputEvent>>{};
+    _cachedInputEvents = InputRecordRing{};
 
     _readingMode = mode;
 }
@@ -348,10 +453,9 @@ void InputBuffer::Flush()
 // - The console lock must be held when calling this routine.
 void InputBuffer::FlushAllButKeys()
 {
-    auto newEnd = std::remove_if(_storage.begin(), _storage.end(), [](const std::unique_ptr<IInputEvent>& event) {
-        return event->EventType() != InputEventType::KeyEvent;
+    _storage.erase_if([](const INPUT_RECORD& record) {
+        return record.EventType != KEY_EVENT;
     });
-    _storage.erase(newEnd, _storage.end());
 }
 
 void InputBuffer::SetTerminalConnection(_In_ Render::VtEngine* const pTtyConnection)
@@ -412,36 +516,36 @@ try
         ConsumeCached(Unicode, AmountToRead, OutEvents);
     }
 
-    auto it = _storage.begin();
-    const auto end = _storage.end();
+    size_t i = 0;
+    const auto end = _storage.size();
 
-    while (it != end && OutEvents.size() < AmountToRead)
+    while (i != end && OutEvents.size() < AmountToRead)
     {
-        auto event = IInputEvent::Create((*it)->ToInputRecord());
+        const auto& record = _storage[i];
 
-        if (event->EventType() == InputEventType::KeyEvent)
+        if (record.EventType == KEY_EVENT)
         {
-            const auto keyEvent = static_cast<KeyEvent*>(event.get());
+            KeyEvent keyEvent{ record.Event.KeyEvent };
             WORD repeat = 1;
 
             // for stream reads we need to split any key events that have been coalesced
             if (Stream)
             {
-                repeat = keyEvent->GetRepeatCount();
-                keyEvent->SetRepeatCount(1);
+                repeat = keyEvent.GetRepeatCount();
+                keyEvent.SetRepeatCount(1);
             }
 
             if (Unicode)
             {
                 do
                 {
-                    OutEvents.push_back(std::make_unique<KeyEvent>(*keyEvent));
+                    OutEvents.push_back(std::make_unique<KeyEvent>(keyEvent));
                     repeat--;
                 } while (repeat > 0 && OutEvents.size() < AmountToRead);
             }
             else
             {
-                const auto wch = keyEvent->GetCharData();
+                const auto wch = keyEvent.GetCharData();
 
                 char buffer[8];
                 const auto length = WideCharToMultiByte(cp, 0, &wch, 1, &buffer[0], sizeof(buffer), nullptr, nullptr);
@@ -453,7 +557,7 @@ try
                 {
                     for (const auto& ch : str)
                     {
-                        auto tempEvent = std::make_unique<KeyEvent>(*keyEvent);
+                        auto tempEvent = std::make_unique<KeyEvent>(keyEvent);
                         tempEvent->SetCharData(ch);
                         OutEvents.push_back(std::move(tempEvent));
                     }
@@ -463,22 +567,21 @@ try
 
             if (repeat && !Peek)
             {
-                const auto originalKeyEvent = static_cast<KeyEvent*>((*it).get());
-                originalKeyEvent->SetRepeatCount(repeat);
+                _storage[i].Event.KeyEvent.wRepeatCount = repeat;
                 break;
             }
         }
         else
         {
-            OutEvents.push_back(std::move(event));
+            OutEvents.push_back(IInputEvent::Create(record));
         }
 
-        ++it;
+        ++i;
     }
 
     if (!Peek)
     {
-        _storage.erase(_storage.begin(), it);
+        _storage.pop_front(i);
     }
 
     Cache(Unicode, OutEvents, AmountToRead);
@@ -556,7 +659,29 @@ size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& in
 {
     try
     {
-        if (inEvents.empty())
+        const auto inRecords = IInputEvent::ToInputRecords(inEvents);
+        return Prepend(inRecords);
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return 0;
+    }
+}
+
+// Routine Description:
+// -  Writes records to the beginning of the input buffer.
+// Arguments:
+// - inRecords - records to write to buffer.
+// Return Value:
+// - The number of records written to the buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::Prepend(const std::span<const INPUT_RECORD>& inRecords)
+{
+    try
+    {
+        if (inRecords.empty())
         {
             return STATUS_SUCCESS;
         }
@@ -569,8 +694,13 @@ size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& in
         // this way to handle any coalescing that might occur.
 
         // get all of the existing records, "emptying" the buffer
-        std::deque<std::unique_ptr<IInputEvent>> existingStorage;
-        existingStorage.swap(_storage);
+        std::vector<INPUT_RECORD> existingStorage;
+        existingStorage.reserve(_storage.size());
+        for (size_t i = 0; i < _storage.size(); ++i)
+        {
+            existingStorage.push_back(_storage[i]);
+        }
+        _storage.clear();
 
         // We will need this variable to pass to _WriteBuffer so it can attempt to determine wait status.
         // However, because we swapped the storage out from under it with an empty deque, it will always
@@ -580,7 +710,7 @@ size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& in
 
         // write the prepend records
         size_t prependEventsWritten;
-        _WriteBuffer(inEvents, prependEventsWritten, unusedWaitStatus);
+        _WriteBuffer(inRecords, prependEventsWritten, unusedWaitStatus);
         FAIL_FAST_IF(!(unusedWaitStatus));
 
         // write all previously existing records
@@ -625,9 +755,8 @@ size_t InputBuffer::Write(_Inout_ std::unique_ptr<IInputEvent> inEvent)
 {
     try
     {
-        std::deque<std::unique_ptr<IInputEvent>> inEvents;
-        inEvents.push_back(std::move(inEvent));
-        return Write(inEvents);
+        const auto record = inEvent->ToInputRecord();
+        return Write(std::span<const INPUT_RECORD>{ &record, 1 });
     }
     catch (...)
     {
@@ -649,7 +778,32 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
 {
     try
     {
-        if (inEvents.empty())
+        const auto inRecords = IInputEvent::ToInputRecords(inEvents);
+        return Write(inRecords);
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return 0;
+    }
+}
+
+// Routine Description:
+// - Writes records to the input buffer. Wakes up any readers that are
+// waiting for additional input events.
+// - This is the preferred variant for bulk input, like WriteConsoleInput() calls
+//   with many records, because it doesn't need to allocate an IInputEvent per record.
+// Arguments:
+// - inRecords - input records to store in the buffer.
+// Return Value:
+// - The number of records that were written to input buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::Write(const std::span<const INPUT_RECORD>& inRecords)
+{
+    try
+    {
+        if (inRecords.empty())
         {
             return 0;
         }
@@ -660,7 +814,7 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
         // Write to buffer.
         size_t EventsWritten;
         bool SetWaitEvent;
-        _WriteBuffer(inEvents, EventsWritten, SetWaitEvent);
+        _WriteBuffer(inRecords, EventsWritten, SetWaitEvent);
 
         if (SetWaitEvent)
         {
@@ -694,7 +848,7 @@ void InputBuffer::WriteFocusEvent(bool focused) noexcept
     {
         // This is a mini-version of Write().
         const auto wasEmpty = _storage.empty();
-        _storage.push_back(std::make_unique<FocusEvent>(focused));
+        _storage.push_back(FocusEvent{ focused }.ToInputRecord());
         if (wasEmpty)
         {
             ServiceLocator::LocateGlobals().hInputEvent.SetEvent();
@@ -760,7 +914,7 @@ static bool IsPauseKey(const KEY_EVENT_RECORD& event)
 // Note:
 // - The console lock must be held when calling this routine.
 // - will throw on failure
-void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
+void InputBuffer::_WriteBuffer(const std::span<const INPUT_RECORD>& inRecords,
                                _Out_ size_t& eventsWritten,
                                _Out_ bool& setWaitEvent)
 {
@@ -769,21 +923,21 @@ void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>&
     eventsWritten = 0;
     setWaitEvent = false;
     const auto initiallyEmptyQueue = _storage.empty();
-    const auto initialInEventsSize = inEvents.size();
+    const auto initialInEventsSize = inRecords.size();
     const auto vtInputMode = IsInVirtualTerminalInputMode();
 
-    for (auto& inEvent : inEvents)
+    for (const auto& inRecord : inRecords)
     {
-        if (inEvent->EventType() == InputEventType::KeyEvent && static_cast<const KeyEvent*>(inEvent.get())->IsKeyDown())
+        if (inRecord.EventType == KEY_EVENT && inRecord.Event.KeyEvent.bKeyDown)
         {
             // if output is suspended, any keyboard input releases it.
-            if (WI_IsFlagSet(gci.Flags, CONSOLE_SUSPENDED) && !IsSystemKey(static_cast<const KeyEvent*>(inEvent.get())->GetVirtualKeyCode()))
+            if (WI_IsFlagSet(gci.Flags, CONSOLE_SUSPENDED) && !IsSystemKey(inRecord.Event.KeyEvent.wVirtualKeyCode))
             {
                 UnblockWriteConsole(CONSOLE_OUTPUT_SUSPENDED);
                 continue;
             }
             // intercept control-s
-            if (WI_IsFlagSet(InputMode, ENABLE_LINE_INPUT) && IsPauseKey(inEvent->ToInputRecord().Event.KeyEvent))
+            if (WI_IsFlagSet(InputMode, ENABLE_LINE_INPUT) && IsPauseKey(inRecord.Event.KeyEvent))
             {
                 WI_SetFlag(gci.Flags, CONSOLE_SUSPENDED);
                 continue;
@@ -794,10 +948,11 @@ void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>&
         // If it was handled, do nothing else for it.
         // If there was one event passed in, try coalescing it with the previous event currently in the buffer.
         // If it's not coalesced, append it to the buffer.
-        if (vtInputMode)
+        // TerminalInput::HandleKey only translates key events, so only those need to be turned into an IInputEvent.
+        if (vtInputMode && inRecord.EventType == KEY_EVENT)
         {
-            // GH#11682: TerminalInput::HandleKey can handle both KeyEvents and Focus events seamlessly
-            if (const auto out = _termInput.HandleKey(inEvent.get()))
+            const KeyEvent keyEvent{ inRecord.Event.KeyEvent };
+            if (const auto out = _termInput.HandleKey(&keyEvent))
             {
                 _HandleTerminalInputCallback(*out);
                 eventsWritten++;
@@ -809,14 +964,14 @@ void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>&
         // record at a time because this is the original behavior of
         // the input buffer. Changing this behavior may break stuff
         // that was depending on it.
-        if (initialInEventsSize == 1 && !_storage.empty() && _CoalesceEvent(inEvents[0]))
+        if (initialInEventsSize == 1 && !_storage.empty() && _CoalesceEvent(inRecord))
         {
             eventsWritten++;
             return;
         }
 
         // At this point, the event was neither coalesced, nor processed by VT.
-        _storage.push_back(std::move(inEvent));
+        _storage.push_back(inRecord);
         ++eventsWritten;
     }
     if (initiallyEmptyQueue && !_storage.empty())
@@ -839,39 +994,39 @@ void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>&
 // the buffer with updated values from an incoming event, instead of
 // storing the incoming event (which would make the original one
 // redundant/out of date with the most current state).
-bool InputBuffer::_CoalesceEvent(const std::unique_ptr<IInputEvent>& inEvent) const noexcept
+bool InputBuffer::_CoalesceEvent(const INPUT_RECORD& inRecord) noexcept
 {
-    auto& lastEvent = _storage.back();
+    auto& lastRecord = _storage.back();
 
-    if (lastEvent->EventType() == InputEventType::MouseEvent && inEvent->EventType() == InputEventType::MouseEvent)
+    if (lastRecord.EventType == MOUSE_EVENT && inRecord.EventType == MOUSE_EVENT)
     {
-        const auto& inMouse = *static_cast<const MouseEvent*>(inEvent.get());
-        auto& lastMouse = *static_cast<MouseEvent*>(lastEvent.get());
+        const auto& inMouse = inRecord.Event.MouseEvent;
+        auto& lastMouse = lastRecord.Event.MouseEvent;
 
-        if (lastMouse.IsMouseMoveEvent() && inMouse.IsMouseMoveEvent())
+        if (lastMouse.dwEventFlags == MOUSE_MOVED && inMouse.dwEventFlags == MOUSE_MOVED)
         {
-            lastMouse.SetPosition(inMouse.GetPosition());
+            lastMouse.dwMousePosition = inMouse.dwMousePosition;
             return true;
         }
     }
-    else if (lastEvent->EventType() == InputEventType::KeyEvent && inEvent->EventType() == InputEventType::KeyEvent)
+    else if (lastRecord.EventType == KEY_EVENT && inRecord.EventType == KEY_EVENT)
     {
-        const auto& inKey = *static_cast<const KeyEvent*>(inEvent.get());
-        auto& lastKey = *static_cast<KeyEvent*>(lastEvent.get());
+        const auto& inKey = inRecord.Event.KeyEvent;
+        auto& lastKey = lastRecord.Event.KeyEvent;
 
-        if (lastKey.IsKeyDown() && inKey.IsKeyDown() &&
-            (lastKey.GetVirtualScanCode() == inKey.GetVirtualScanCode() || WI_IsFlagSet(inKey.GetActiveModifierKeys(), NLS_IME_CONVERSION)) &&
-            lastKey.GetCharData() == inKey.GetCharData() &&
-            lastKey.GetActiveModifierKeys() == inKey.GetActiveModifierKeys() &&
+        if (lastKey.bKeyDown && inKey.bKeyDown &&
+            (lastKey.wVirtualScanCode == inKey.wVirtualScanCode || WI_IsFlagSet(inKey.dwControlKeyState, NLS_IME_CONVERSION)) &&
+            lastKey.uChar.UnicodeChar == inKey.uChar.UnicodeChar &&
+            lastKey.dwControlKeyState == inKey.dwControlKeyState &&
             // TODO: This behavior is an import from old conhost v1 and has been broken for decades.
             // This is probably the outdated idea that any wide glyph is being represented by 2 characters (DBCS) and likely
             // resulted from conhost originally being split into a ASCII/OEM and a DBCS variant with preprocessor flags.
             // You can't update the repeat count of such a A,B pair, because they're stored as A,A,B,B (down-down, up-up).
             // I believe the proper approach is to store pairs of characters as pairs, update their combined
             // repeat count and only when they're being read de-coalesce them into their alternating form.
-            !IsGlyphFullWidth(inKey.GetCharData()))
+            !IsGlyphFullWidth(inKey.uChar.UnicodeChar))
         {
-            lastKey.SetRepeatCount(lastKey.GetRepeatCount() + inKey.GetRepeatCount());
+            lastKey.wRepeatCount += inKey.wRepeatCount;
             return true;
         }
     }
@@ -908,7 +1063,7 @@ void InputBuffer::_HandleTerminalInputCallback(const TerminalInput::StringType&
 
         for (const auto& wch : text)
         {
-            _storage.push_back(std::make_unique<KeyEvent>(true, 1ui16, 0ui16, 0ui16, wch, 0));
+            _storage.push_back(KeyEvent{ true, 1ui16, 0ui16, 0ui16, wch, 0 }.ToInputRecord());
         }
 
         if (!_vtInputShouldSuppress)
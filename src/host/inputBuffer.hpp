@@ -33,6 +33,50 @@ namespace Microsoft::Console::Render
     class VtEngine;
 }
 
+// A FIFO queue of INPUT_RECORDs. They're stored by value in a single allocation that's used as a ring buffer,
+// which avoids the per-event heap allocation and virtual dispatch of a deque of IInputEvents.
+class InputRecordRing
+{
+public:
+    size_t size() const noexcept;
+    bool empty() const noexcept;
+
+    INPUT_RECORD& operator[](size_t index) noexcept;
+    const INPUT_RECORD& operator[](size_t index) const noexcept;
+    INPUT_RECORD& front() noexcept;
+    INPUT_RECORD& back() noexcept;
+
+    void push_back(const INPUT_RECORD& record);
+    void append(std::span<const INPUT_RECORD> records);
+    void pop_front(size_t count) noexcept;
+    void clear() noexcept;
+
+    // Removes all records for which pred returns true, preserving the order of the remaining ones.
+    template<typename Pred>
+    void erase_if(Pred&& pred) noexcept
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < _size; ++i)
+        {
+            const auto& record = (*this)[i];
+            if (!pred(record))
+            {
+                (*this)[kept++] = record;
+            }
+        }
+        _size = kept;
+    }
+
+private:
+    void _reserve(size_t capacity);
+
+    // The capacity is always a power of 2, so that indices can be wrapped with a mask.
+    std::unique_ptr<INPUT_RECORD[]> _buffer;
+    size_t _capacity = 0;
+    size_t _head = 0;
+    size_t _size = 0;
+};
+
 class InputBuffer final : public ConsoleObjectHeader
 {
 public:
@@ -77,9 +121,11 @@ public:
                                 const bool Stream);
 
     size_t Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
+    size_t Prepend(const std::span<const INPUT_RECORD>& inRecords);
 
     size_t Write(_Inout_ std::unique_ptr<IInputEvent> inEvent);
     size_t Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
+    size_t Write(const std::span<const INPUT_RECORD>& inRecords);
 
     void WriteFocusEvent(bool focused) noexcept;
     bool WriteMouseEvent(til::point position, unsigned int button, short keyState, short wheelDelta);
@@ -102,10 +148,10 @@ private:
     std::string_view _cachedTextReaderA;
     std::wstring _cachedTextW;
     std::wstring_view _cachedTextReaderW;
-    std::deque<std::unique_ptr<IInputEvent>> _cachedInputEvents;
+    InputRecordRing _cachedInputEvents;
     ReadingMode _readingMode = ReadingMode::StringA;
 
-    std::deque<std::unique_ptr<IInputEvent>> _storage;
+    InputRecordRing _storage;
     std::unique_ptr<IInputEvent> _writePartialByteSequence;
     Microsoft::Console::VirtualTerminal::TerminalInput _termInput;
     Microsoft::Console::Render::VtEngine* _pTtyConnection;
@@ -119,11 +165,11 @@ private:
     void _switchReadingMode(ReadingMode mode);
     void _switchReadingModeSlowPath(ReadingMode mode);
 
-    void _WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inRecords,
+    void _WriteBuffer(const std::span<const INPUT_RECORD>& inRecords,
                       _Out_ size_t& eventsWritten,
                       _Out_ bool& setWaitEvent);
 
-    bool _CoalesceEvent(const std::unique_ptr<IInputEvent>& inEvent) const noexcept;
+    bool _CoalesceEvent(const INPUT_RECORD& inRecord) noexcept;
     void _HandleTerminalInputCallback(const Microsoft::Console::VirtualTerminal::TerminalInput::StringType& text);
 
 #ifdef UNIT_TESTING
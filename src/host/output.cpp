@@ -92,28 +92,10 @@ static void _CopyRectangle(SCREEN_INFORMATION& screenInfo,
         }
     }
 
-    // 2. We can move any other scenario in-place without copying. We just have to carefully
-    //    choose which direction we walk through filling up the target so it doesn't accidentally
-    //    erase the source material before it can be copied/moved to the new location.
-    {
-        const auto target = Viewport::FromDimensions(targetOrigin, source.Dimensions());
-        const auto walkDirection = Viewport::DetermineWalkDirection(source, target);
-
-        auto sourcePos = source.GetWalkOrigin(walkDirection);
-        auto targetPos = target.GetWalkOrigin(walkDirection);
-
-        // Note that we read two cells from the source before we start writing
-        // to the target, so a two-cell DBCS character can't accidentally delete
-        // itself when moving one cell horizontally.
-        auto next = OutputCell(*screenInfo.GetCellDataAt(sourcePos));
-        do
-        {
-            const auto current = next;
-            source.WalkInBounds(sourcePos, walkDirection);
-            next = OutputCell(*screenInfo.GetCellDataAt(sourcePos));
-            screenInfo.GetTextBuffer().WriteLine(OutputCellIterator({ &current, 1 }), targetPos);
-        } while (target.WalkInBounds(targetPos, walkDirection));
-    }
+    // 2. We can move any other scenario in-place by copying row spans. CopyRectangle() walks
+    //    through the rows in the right direction so that it doesn't accidentally erase
+    //    the source material before it can be copied/moved to the new location.
+    screenInfo.GetTextBuffer().CopyRectangle(source.ToExclusive(), targetOrigin);
 }
 
 // Routine Description:
@@ -318,6 +318,11 @@ const std::vector<size_t> RenderData::GetPatternId(const til::point /*location*/
     return {};
 }
 
+std::span<const til::CoordType> RenderData::GetPatternBoundaries(const til::CoordType /*row*/) const noexcept
+{
+    return {};
+}
+
 // Routine Description:
 // - Converts a text attribute into the RGB values that should be presented, applying
 //   relevant table translation information and preferences.
@@ -48,6 +48,7 @@ public:
     const std::wstring GetHyperlinkCustomId(uint16_t id) const override;
 
     const std::vector<size_t> GetPatternId(const til::point location) const override;
+    std::span<const til::CoordType> GetPatternBoundaries(const til::CoordType row) const noexcept override;
 
     std::pair<COLORREF, COLORREF> GetAttributeColors(const TextAttribute& attr) const noexcept override;
     const bool IsSelectionActive() const override;
@@ -86,4 +86,80 @@ class CodepointWidthDetectorTests
         widthDetector.NotifyFontChanged();
         VERIFY_ARE_EQUAL(0u, widthDetector._fallbackCache.size());
     }
+
+    TEST_METHOD(StageTablesMatchRangeTable)
+    {
+        size_t mismatches = 0;
+        for (char32_t codepoint = 0; codepoint <= 0x10FFFF; ++codepoint)
+        {
+            const auto expected = CodepointWidthDetector::_lookupRangeTable(codepoint);
+            const auto actual = CodepointWidthDetector::_lookupStageTables(codepoint);
+            if (expected != actual && mismatches++ < 10)
+            {
+                Log::Comment(String().Format(L"U+%04X: expected %d, got %d", codepoint, expected, actual));
+            }
+        }
+        VERIFY_ARE_EQUAL(0u, mismatches);
+    }
+
+    // Measures the width lookup for every codepoint in the natural language
+    // samples of the U8U16Test tool, comparing the stage tables against the
+    // binary search over s_wideAndAmbiguousTable that preceded them.
+    TEST_METHOD(LookupPerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        const auto directory = std::filesystem::path{ __FILE__ }.parent_path() / L"../../tools/U8U16Test";
+        const auto iterations = 100;
+
+        for (const auto name : { L"zh.txt", L"ru.txt" })
+        {
+            std::ifstream file{ directory / name, std::ios::binary };
+            if (!file)
+            {
+                Log::Comment(String().Format(L"%s wasn't found in %s", name, directory.c_str()));
+                Log::Result(WEX::Logging::TestResults::Skipped);
+                return;
+            }
+
+            std::ostringstream buffer;
+            buffer << file.rdbuf();
+            const auto text = til::u8u16(buffer.str());
+
+            std::vector<char32_t> codepoints;
+            for (size_t i = 0; i < text.size(); ++i)
+            {
+                char32_t codepoint = text[i];
+                if (til::is_leading_surrogate(text[i]) && i + 1 < text.size())
+                {
+                    codepoint = (((text[i] & 0x3FF) << 10) | (text[i + 1] & 0x3FF)) + 0x10000;
+                    ++i;
+                }
+                codepoints.push_back(codepoint);
+            }
+
+            const auto measure = [&](auto&& lookup) {
+                size_t wide = 0;
+                const auto now = std::chrono::steady_clock::now();
+                for (auto i = 0; i < iterations; ++i)
+                {
+                    for (const auto codepoint : codepoints)
+                    {
+                        wide += lookup(codepoint) == WI_EnumValue(CodepointWidth::Wide);
+                    }
+                }
+                const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - now).count();
+                return std::pair{ wide, delta };
+            };
+
+            const auto [rangeWide, rangeDelta] = measure(&CodepointWidthDetector::_lookupRangeTable);
+            const auto [stageWide, stageDelta] = measure(&CodepointWidthDetector::_lookupStageTables);
+            VERIFY_ARE_EQUAL(rangeWide, stageWide);
+
+            const auto total = codepoints.size() * iterations;
+            Log::Comment(String().Format(L"%s: %zu codepoints. Binary search: %lld us (%.2f ns/cp). Stage tables: %lld us (%.2f ns/cp)", name, codepoints.size(), rangeDelta, rangeDelta * 1000.0 / total, stageDelta, stageDelta * 1000.0 / total));
+        }
+    }
 };
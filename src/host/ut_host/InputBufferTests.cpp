@@ -9,6 +9,7 @@
 #include "../interactivity/inc/ServiceLocator.hpp"
 #include "../types/inc/IInputEvent.hpp"
 
+using namespace WEX::Common;
 using namespace WEX::Logging;
 using Microsoft::Console::Interactivity::ServiceLocator;
 
@@ -78,7 +79,7 @@ class InputBufferTests
             INPUT_RECORD record;
             record.EventType = MENU_EVENT;
             VERIFY_IS_GREATER_THAN(inputBuffer.Write(IInputEvent::Create(record)), 0u);
-            VERIFY_ARE_EQUAL(record, inputBuffer._storage.back()->ToInputRecord());
+            VERIFY_ARE_EQUAL(record, inputBuffer._storage.back());
         }
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT);
     }
@@ -98,7 +99,7 @@ class InputBufferTests
         // verify that the events are the same in storage
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i]->ToInputRecord(), record);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i], record);
         }
     }
 
@@ -121,10 +122,9 @@ class InputBufferTests
         // check that they coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 1u);
         // check that the mouse position is being updated correctly
-        const IInputEvent* const pOutEvent = inputBuffer._storage.front().get();
-        const auto pMouseEvent = static_cast<const MouseEvent* const>(pOutEvent);
-        VERIFY_ARE_EQUAL(pMouseEvent->GetPosition().x, static_cast<SHORT>(RECORD_INSERT_COUNT));
-        VERIFY_ARE_EQUAL(pMouseEvent->GetPosition().y, static_cast<SHORT>(RECORD_INSERT_COUNT * 2));
+        const auto& mouseEvent = inputBuffer._storage.front().Event.MouseEvent;
+        VERIFY_ARE_EQUAL(mouseEvent.dwMousePosition.X, static_cast<SHORT>(RECORD_INSERT_COUNT));
+        VERIFY_ARE_EQUAL(mouseEvent.dwMousePosition.Y, static_cast<SHORT>(RECORD_INSERT_COUNT * 2));
 
         // add a key event and another mouse event to make sure that
         // an event between two mouse events stopped the coalescing.
@@ -162,10 +162,10 @@ class InputBufferTests
         // no events should have been coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT + 1);
         // check that the events stored match those inserted
-        VERIFY_ARE_EQUAL(inputBuffer._storage.front()->ToInputRecord(), mouseRecords[0]);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front(), mouseRecords[0]);
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1]->ToInputRecord(), mouseRecords[i]);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1], mouseRecords[i]);
         }
     }
 
@@ -221,10 +221,10 @@ class InputBufferTests
         // no events should have been coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT + 1);
         // check that the events stored match those inserted
-        VERIFY_ARE_EQUAL(inputBuffer._storage.front()->ToInputRecord(), keyRecords[0]);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front(), keyRecords[0]);
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1]->ToInputRecord(), keyRecords[i]);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1], keyRecords[i]);
         }
     }
 
@@ -239,7 +239,7 @@ class InputBufferTests
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
             VERIFY_IS_GREATER_THAN(inputBuffer.Write(IInputEvent::Create(record)), 0u);
-            VERIFY_ARE_EQUAL(inputBuffer._storage.back()->ToInputRecord(), record);
+            VERIFY_ARE_EQUAL(inputBuffer._storage.back(), record);
         }
 
         // The events shouldn't be coalesced
@@ -634,7 +634,7 @@ class InputBufferTests
                                            true));
         VERIFY_ARE_EQUAL(outEvents.size(), 1u);
         VERIFY_ARE_EQUAL(inputBuffer._storage.size(), 1u);
-        VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*inputBuffer._storage.front()).GetRepeatCount(), repeatCount - 1);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front().Event.KeyEvent.wRepeatCount, repeatCount - 1);
         VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*outEvents.front()).GetRepeatCount(), 1u);
     }
 
@@ -654,7 +654,103 @@ class InputBufferTests
                                            true));
         VERIFY_ARE_EQUAL(outEvents.size(), 1u);
         VERIFY_ARE_EQUAL(inputBuffer._storage.size(), 1u);
-        VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*inputBuffer._storage.front()).GetRepeatCount(), repeatCount);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front().Event.KeyEvent.wRepeatCount, repeatCount);
         VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*outEvents.front()).GetRepeatCount(), 1u);
     }
+
+    TEST_METHOD(StorageWrapsAroundInOrder)
+    {
+        Log::Comment(L"Records must be returned in FIFO order, even after the ring buffer wrapped around and grew.");
+
+        InputBuffer inputBuffer;
+        std::vector<INPUT_RECORD> records;
+        for (WCHAR wch = L'A'; wch < L'A' + 40; ++wch)
+        {
+            records.push_back(MakeKeyEvent(true, 1, wch, 0, wch, 0));
+        }
+
+        WCHAR expected = L'A';
+        const auto readAndVerify = [&](size_t count) {
+            std::deque<std::unique_ptr<IInputEvent>> outEvents;
+            VERIFY_NT_SUCCESS(inputBuffer.Read(outEvents, count, false, false, true, false));
+            VERIFY_ARE_EQUAL(count, outEvents.size());
+            for (const auto& event : outEvents)
+            {
+                VERIFY_ARE_EQUAL(expected, static_cast<const KeyEvent&>(*event).GetCharData());
+                expected++;
+            }
+        };
+
+        VERIFY_ARE_EQUAL(12u, inputBuffer.Write(std::span{ records }.subspan(0, 12)));
+        readAndVerify(10);
+        // The next write wraps around the end of the initial 16 records of capacity.
+        VERIFY_ARE_EQUAL(12u, inputBuffer.Write(std::span{ records }.subspan(12, 12)));
+        readAndVerify(4);
+        // This one doesn't fit into the capacity anymore and forces the buffer to grow while being wrapped.
+        VERIFY_ARE_EQUAL(16u, inputBuffer.Write(std::span{ records }.subspan(24, 16)));
+        VERIFY_ARE_EQUAL(26u, inputBuffer.GetNumberOfReadyEvents());
+        readAndVerify(26);
+        VERIFY_ARE_EQUAL(0u, inputBuffer.GetNumberOfReadyEvents());
+    }
+
+    TEST_METHOD(PastePerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        // A 1 MB paste turns into a key down and key up record per character.
+        const size_t charCount = 1024 * 1024;
+        std::vector<INPUT_RECORD> records;
+        records.reserve(charCount * 2);
+        for (size_t i = 0; i < charCount; ++i)
+        {
+            const auto wch = static_cast<WCHAR>(L'a' + i % 26);
+            records.push_back(MakeKeyEvent(true, 1, wch, 0, wch, 0));
+            records.push_back(MakeKeyEvent(false, 1, wch, 0, wch, 0));
+        }
+
+        InputBuffer inputBuffer;
+        std::deque<std::unique_ptr<IInputEvent>> outEvents;
+
+        Log::Comment(L"Working. Please wait...");
+        const auto now = std::chrono::steady_clock::now();
+
+        VERIFY_ARE_EQUAL(records.size(), inputBuffer.Write(records));
+        while (inputBuffer.GetNumberOfReadyEvents())
+        {
+            outEvents.clear();
+            VERIFY_NT_SUCCESS(inputBuffer.Read(outEvents, 4096, false, false, true, false));
+        }
+
+        const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - now).count();
+        Log::Comment(String().Format(L"Writing and reading %zu records took %lld us", records.size(), delta));
+    }
+
+    TEST_METHOD(ReadLatencyPerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        // Simulates an application that calls ReadConsoleInput for every single keystroke.
+        const auto count = 100000;
+        const auto record = MakeKeyEvent(true, 1, L'a', 0, L'a', 0);
+
+        InputBuffer inputBuffer;
+        std::deque<std::unique_ptr<IInputEvent>> outEvents;
+
+        Log::Comment(L"Working. Please wait...");
+        const auto now = std::chrono::steady_clock::now();
+
+        for (auto i = 0; i < count; ++i)
+        {
+            inputBuffer.Write(std::span{ &record, 1 });
+            outEvents.clear();
+            VERIFY_NT_SUCCESS(inputBuffer.Read(outEvents, 1, false, false, true, false));
+        }
+
+        const auto delta = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - now).count();
+        Log::Comment(String().Format(L"%d reads took %lld ns. Avg %lld ns per read", count, delta, delta / count));
+    }
 };
@@ -0,0 +1,327 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "CommonState.hpp"
+
+#include "globals.h"
+#include "screenInfo.hpp"
+
+#include "../interactivity/inc/ServiceLocator.hpp"
+#include "../../terminal/adapter/termDispatch.hpp"
+#include "../../terminal/parser/OutputStateMachineEngine.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using namespace Microsoft::Console::Interactivity;
+using namespace Microsoft::Console::VirtualTerminal;
+
+// These benchmarks measure the output pipeline stage by stage without a window,
+// a renderer or a pseudoconsole in the way. Each workload is fed through:
+// * "parse": StateMachine + OutputStateMachineEngine with a dispatch that does nothing.
+// * "pipeline": the conhost screen buffer's own state machine, which goes
+//   through AdaptDispatch all the way into the TextBuffer.
+// The "dispatch" stage is the difference of the two.
+//
+// Results are logged as one line per stage in the form
+//   OutputPipelineBenchmark,<workload>,<stage>,<input bytes>,<MB/s>,<ns/char>
+// where MB/s is relative to the UTF-8 size of the input (what a client would
+// write into the pty) and ns/char is relative to the number of UTF-16 code units.
+namespace
+{
+    class NullDispatch final : public TermDispatch
+    {
+    public:
+        void Print(const wchar_t /*wchPrintable*/) override
+        {
+        }
+
+        void PrintString(const std::wstring_view /*string*/) override
+        {
+        }
+    };
+
+    // Each workload is roughly this many UTF-16 code units long.
+    constexpr size_t workloadSize = 1024 * 1024;
+    constexpr int iterations = 8;
+
+    // Some text of exactly 80 columns, used by most workloads below.
+    constexpr std::wstring_view loremIpsum = L"Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor i";
+
+    std::wstring makeAscii()
+    {
+        std::wstring str;
+        while (str.size() < workloadSize)
+        {
+            str.append(loremIpsum);
+            str.append(L"\r\n");
+        }
+        return str;
+    }
+
+    std::wstring makeDenseSgr()
+    {
+        std::wstring str;
+        for (uint32_t i = 0; str.size() < workloadSize; ++i)
+        {
+            // A 256-color foreground and a 24-bit background for every single cell,
+            // similar to what image-to-text converters and colortool-style tests emit.
+            str.append(L"\x1b[38;5;");
+            str.append(std::to_wstring(i & 0xff));
+            str.append(L";48;2;");
+            str.append(std::to_wstring((i * 7) & 0xff));
+            str.append(L";");
+            str.append(std::to_wstring((i * 13) & 0xff));
+            str.append(L";");
+            str.append(std::to_wstring((i * 29) & 0xff));
+            str.append(L"m");
+            str.push_back(loremIpsum[i % loremIpsum.size()]);
+            if (i % 80 == 79)
+            {
+                str.append(L"\x1b[m\r\n");
+            }
+        }
+        return str;
+    }
+
+    std::wstring makeCjk()
+    {
+        std::wstring str;
+        for (uint32_t i = 0; str.size() < workloadSize; ++i)
+        {
+            // 40 wide glyphs fill an 80 column line.
+            str.push_back(static_cast<wchar_t>(0x4E00 + (i * 31) % 0x5000));
+            if (i % 40 == 39)
+            {
+                str.append(L"\r\n");
+            }
+        }
+        return str;
+    }
+
+    std::wstring makeEmoji()
+    {
+        std::wstring str;
+        for (uint32_t i = 0; str.size() < workloadSize; ++i)
+        {
+            // U+1F600..U+1F64F as surrogate pairs, 40 wide glyphs per line.
+            const auto ch = 0x1F600 + i % 0x50 - 0x10000;
+            str.push_back(static_cast<wchar_t>(0xD800 + (ch >> 10)));
+            str.push_back(static_cast<wchar_t>(0xDC00 + (ch & 0x3ff)));
+            if (i % 40 == 39)
+            {
+                str.append(L"\r\n");
+            }
+        }
+        return str;
+    }
+
+    std::wstring makeTuiRedraw()
+    {
+        // A full screen repaint the way TUI frameworks do it:
+        // absolute positioning, a few colors per row, erase to the end of line
+        // and a reverse video status bar at the bottom.
+        std::wstring str;
+        for (uint32_t frame = 0; str.size() < workloadSize; ++frame)
+        {
+            str.append(L"\x1b[?25l");
+            for (uint32_t y = 1; y < 25; ++y)
+            {
+                str.append(L"\x1b[");
+                str.append(std::to_wstring(y));
+                str.append(L";1H\x1b[38;5;");
+                str.append(std::to_wstring((frame + y) & 0xff));
+                str.append(L"m");
+                str.append(loremIpsum.substr(0, 20));
+                str.append(L"\x1b[1;34m");
+                str.append(loremIpsum.substr(20, 40));
+                str.append(L"\x1b[m\x1b[K");
+            }
+            str.append(L"\x1b[25;1H\x1b[7m");
+            str.append(loremIpsum.substr(0, 79));
+            str.append(L"\x1b[m\x1b[?25h");
+        }
+        return str;
+    }
+
+    std::wstring makeScrollingMargins()
+    {
+        // Output that continuously scrolls a region in the middle of the screen,
+        // like a pager or the log pane of a TUI, which prevents the buffer from
+        // using its fast circular scrolling.
+        std::wstring str{ L"\x1b[5;20r\x1b[20;1H" };
+        while (str.size() < workloadSize)
+        {
+            str.append(loremIpsum.substr(0, 60));
+            str.append(L"\r\n");
+        }
+        str.append(L"\x1b[r");
+        return str;
+    }
+
+    std::wstring makeHyperlinks()
+    {
+        std::wstring str;
+        for (uint32_t i = 0; str.size() < workloadSize; ++i)
+        {
+            // Similar to `ls --hyperlink`: every entry is a link of its own.
+            str.append(L"\x1b]8;;file://localhost/home/user/file");
+            str.append(std::to_wstring(i));
+            str.append(L".txt\x1b\\file");
+            str.append(std::to_wstring(i));
+            str.append(L".txt\x1b]8;;\x1b\\ ");
+            if (i % 4 == 3)
+            {
+                str.append(L"\r\n");
+            }
+        }
+        return str;
+    }
+
+    std::wstring makeWorkload(const std::wstring_view name)
+    {
+        if (name == L"ascii")
+        {
+            return makeAscii();
+        }
+        if (name == L"sgr")
+        {
+            return makeDenseSgr();
+        }
+        if (name == L"cjk")
+        {
+            return makeCjk();
+        }
+        if (name == L"emoji")
+        {
+            return makeEmoji();
+        }
+        if (name == L"tui")
+        {
+            return makeTuiRedraw();
+        }
+        if (name == L"margins")
+        {
+            return makeScrollingMargins();
+        }
+        if (name == L"hyperlinks")
+        {
+            return makeHyperlinks();
+        }
+        return {};
+    }
+
+    // Returns the best (lowest) duration out of all iterations in nanoseconds.
+    // The minimum is the most stable statistic for a single-threaded,
+    // CPU bound benchmark like this one.
+    template<typename Func>
+    double measure(Func&& func)
+    {
+        auto best = std::numeric_limits<double>::max();
+        for (auto i = 0; i < iterations; ++i)
+        {
+            const auto beg = std::chrono::steady_clock::now();
+            func();
+            const auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::nano>(end - beg).count());
+        }
+        return best;
+    }
+
+    void logResult(const std::wstring_view workload, const std::wstring_view stage, const size_t bytes, const size_t chars, const double ns)
+    {
+        const auto mbps = bytes / ns * 1e9 / (1024.0 * 1024.0);
+        const auto nsPerChar = ns / chars;
+        Log::Comment(NoThrowString().Format(L"OutputPipelineBenchmark,%.*s,%.*s,%zu,%.2f,%.3f",
+                                            gsl::narrow_cast<int>(workload.size()),
+                                            workload.data(),
+                                            gsl::narrow_cast<int>(stage.size()),
+                                            stage.data(),
+                                            bytes,
+                                            mbps,
+                                            nsPerChar));
+    }
+}
+
+class OutputPipelineBenchmarks
+{
+    CommonState* m_state;
+
+    TEST_CLASS(OutputPipelineBenchmarks);
+
+    TEST_CLASS_SETUP(ClassSetup)
+    {
+        m_state = new CommonState();
+
+        m_state->InitEvents();
+        m_state->PrepareGlobalFont({ 1, 1 });
+        m_state->PrepareGlobalRenderer();
+        m_state->PrepareGlobalInputBuffer();
+        m_state->PrepareGlobalScreenBuffer();
+
+        return true;
+    }
+
+    TEST_CLASS_CLEANUP(ClassCleanup)
+    {
+        m_state->CleanupGlobalScreenBuffer();
+        m_state->CleanupGlobalRenderer();
+        m_state->CleanupGlobalFont();
+        m_state->CleanupGlobalInputBuffer();
+
+        delete m_state;
+
+        return true;
+    }
+
+    TEST_METHOD_SETUP(MethodSetup)
+    {
+        m_state->PrepareNewTextBufferInfo();
+        return true;
+    }
+
+    TEST_METHOD_CLEANUP(MethodCleanup)
+    {
+        m_state->CleanupNewTextBufferInfo();
+        return true;
+    }
+
+    BEGIN_TEST_METHOD(MeasureStages)
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        TEST_METHOD_PROPERTY(L"Data:workload", L"{ascii, sgr, cjk, emoji, tui, margins, hyperlinks}")
+    END_TEST_METHOD()
+};
+
+void OutputPipelineBenchmarks::MeasureStages()
+{
+    String workloadName;
+    VERIFY_SUCCEEDED(TestData::TryGetValue(L"workload", workloadName));
+
+    const std::wstring_view name{ workloadName.GetBuffer(), gsl::narrow_cast<size_t>(workloadName.GetLength()) };
+    const auto workload = makeWorkload(name);
+    VERIFY_IS_FALSE(workload.empty());
+
+    const auto chars = workload.size();
+    const auto bytes = gsl::narrow_cast<size_t>(WideCharToMultiByte(CP_UTF8, 0, workload.data(), gsl::narrow<int>(chars), nullptr, 0, nullptr, nullptr));
+
+    StateMachine parser{ std::make_unique<OutputStateMachineEngine>(std::make_unique<NullDispatch>()) };
+    const auto parseNs = measure([&]() {
+        parser.ProcessString(workload);
+    });
+
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    auto& stateMachine = gci.GetActiveOutputBuffer().GetStateMachine();
+    const auto pipelineNs = measure([&]() {
+        stateMachine.ProcessString(workload);
+    });
+    // Leave the buffer the way we found it for the next workload.
+    stateMachine.ProcessString(L"\x1b[!p\x1b[H\x1b[2J");
+
+    logResult(name, L"parse", bytes, chars, parseNs);
+    logResult(name, L"dispatch", bytes, chars, std::max(pipelineNs - parseNs, 0.0));
+    logResult(name, L"pipeline", bytes, chars, pipelineNs);
+}
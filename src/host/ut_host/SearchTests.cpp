@@ -158,4 +158,47 @@ class SearchTests
         Search s(gci.renderData, L"\x304b", Search::Direction::Backward, Search::Sensitivity::CaseInsensitive);
         DoFoundChecks(s, coordStartExpected, -1);
     }
+
+    TEST_METHOD(ForwardRegularExpression)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        til::point coordStartExpected;
+        Search s(gci.renderData, L"A[B]", Search::Direction::Forward, Search::Sensitivity::CaseSensitive, Search::Mode::RegularExpression);
+        VERIFY_IS_TRUE(s.IsPatternValid());
+        DoFoundChecks(s, coordStartExpected, 1);
+    }
+
+    TEST_METHOD(InvalidRegularExpression)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        Search s(gci.renderData, L"A[B", Search::Direction::Forward, Search::Sensitivity::CaseSensitive, Search::Mode::RegularExpression);
+        VERIFY_IS_FALSE(s.IsPatternValid());
+        VERIFY_IS_TRUE(s.Results().empty());
+        VERIFY_IS_FALSE(s.FindNext());
+
+        Log::Comment(L"The same needle is a perfectly fine literal.");
+        Search literal(gci.renderData, L"A[B", Search::Direction::Forward, Search::Sensitivity::CaseSensitive);
+        VERIFY_IS_TRUE(literal.IsPatternValid());
+    }
+
+    TEST_METHOD(CatastrophicRegularExpression)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& textBuffer = gci.GetActiveOutputBuffer().GetTextBuffer();
+
+        // A row full of "a" makes the valid pattern below backtrack exponentially,
+        // which std::regex reports by throwing error_complexity or error_stack.
+        const auto width = textBuffer.GetSize().Width();
+        const std::wstring text(gsl::narrow_cast<size_t>(width), L'a');
+        RowWriteState state{ .text = text, .columnLimit = width };
+        textBuffer.GetRowByOffset(4).ReplaceText(state);
+        textBuffer.GetCursor().SetYPosition(5);
+
+        Search s(gci.renderData, L"(a*)*b", Search::Direction::Forward, Search::Sensitivity::CaseSensitive, Search::Mode::RegularExpression);
+        VERIFY_IS_FALSE(s.IsPatternValid());
+        VERIFY_IS_TRUE(s.Results().empty());
+        VERIFY_IS_FALSE(s.FindNext());
+    }
 };
@@ -108,6 +108,15 @@ class TextBufferTests
 
     TEST_METHOD(TestIncrementCircularBuffer);
 
+    TEST_METHOD(TestScrollRows);
+    TEST_METHOD(ScrollRowsPerformance);
+
+    TEST_METHOD(TestCopyRectangle);
+    TEST_METHOD(CopyRectanglePerformance);
+
+    TEST_METHOD(TestReplaceTextASCII);
+    TEST_METHOD(ReplaceTextPerformance);
+
     TEST_METHOD(TestMixedRgbAndLegacyForeground);
     TEST_METHOD(TestMixedRgbAndLegacyBackground);
     TEST_METHOD(TestMixedRgbAndLegacyUnderline);
@@ -158,11 +167,26 @@ class TextBufferTests
 
     TEST_METHOD(GetTextRects);
     TEST_METHOD(GetText);
+    TEST_METHOD(GetTextColorRuns);
+    TEST_METHOD(GenRichTextFromColorRuns);
+    TEST_METHOD(GenRichTextPerformance);
 
     TEST_METHOD(HyperlinkTrim);
     TEST_METHOD(NoHyperlinkTrim);
+    TEST_METHOD(HyperlinkTrimPerformance);
+
+    TEST_METHOD(GetPatterns);
+    TEST_METHOD(GetPatternsPerformance);
+
+    TEST_METHOD(SearchText);
+    TEST_METHOD(SearchTextPerformance);
+    TEST_METHOD(SearchRegex);
+    TEST_METHOD(SearchRegexPerformance);
 };
 
+// The same pattern TerminalCore uses to detect URLs.
+static constexpr std::wstring_view linkPattern{ LR"(\b(https?|ftp|file)://[-A-Za-z0-9+&@#/%?=~_|$!:,.;]*[A-Za-z0-9+&@#/%=~_|$])" };
+
 void TextBufferTests::TestBufferCreate()
 {
     VERIFY_SUCCEEDED(m_state->GetTextBufferInfoInitResult());
@@ -640,6 +664,236 @@ void TextBufferTests::TestIncrementCircularBuffer()
     }
 }
 
+void TextBufferTests::TestScrollRows()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"Data:circular", L"{false, true}")
+    END_TEST_METHOD_PROPERTIES();
+
+    bool circular;
+    VERIFY_SUCCEEDED(TestData::TryGetValue(L"circular", circular), L"Get 'circular' variant");
+
+    const til::size bufferSize{ 10, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    if (circular)
+    {
+        // This ensures that the scrolled ranges wrap around the end of the circular buffer.
+        for (auto i = 0; i < 8; ++i)
+        {
+            _buffer->IncrementCircularBuffer();
+        }
+    }
+
+    WriteLinesToBuffer({ L"0", L"1", L"2", L"3", L"4", L"5", L"6", L"7", L"8", L"9" }, *_buffer);
+
+    const auto verifyRows = [&](const std::wstring_view expected) {
+        for (til::CoordType y = 0; y < bufferSize.height; ++y)
+        {
+            VERIFY_ARE_EQUAL(expected[y], _buffer->GetRowByOffset(y).GetText()[0]);
+        }
+    };
+
+    // The rows 2-6 move up by 1. The uncovered row 6 retains its contents.
+    _buffer->ScrollRows(2, 5, -1);
+    verifyRows(L"0234566789");
+
+    // The rows 1-3 move down by 2. The uncovered rows 1-2 retain their contents.
+    _buffer->ScrollRows(1, 3, 2);
+    verifyRows(L"0232346789");
+
+    // Moving rows further than their count copies them.
+    _buffer->ScrollRows(7, 2, -5);
+    verifyRows(L"0278346789");
+}
+
+// Scrolls a 50 row margin region within a large buffer, like vim or tmux do.
+void TextBufferTests::ScrollRowsPerformance()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD_PROPERTIES()
+
+    const til::size bufferSize{ 120, 9001 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    const auto top = bufferSize.height - 60;
+    const auto height = 50;
+    const auto count = 100000;
+
+    std::wstring line(gsl::narrow_cast<size_t>(bufferSize.width), L'x');
+    for (auto y = top; y < top + height; ++y)
+    {
+        RowWriteState state{ .text = line };
+        _buffer->Write(y, attr, state);
+    }
+
+    Log::Comment(L"Working. Please wait...");
+    const auto now = std::chrono::steady_clock::now();
+
+    for (auto i = 0; i < count; ++i)
+    {
+        _buffer->ScrollRows(top + 1, height - 1, -1);
+        RowWriteState state{ .text = line };
+        _buffer->Write(top + height - 1, attr, state);
+    }
+
+    const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - now).count();
+    Log::Comment(String().Format(L"%d scrolls took %lld us. Avg %lld ns per scroll", count, delta, delta * 1000 / count));
+}
+
+void TextBufferTests::TestCopyRectangle()
+{
+    const til::size bufferSize{ 10, 4 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    const TextAttribute red{ FOREGROUND_RED };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    WriteLinesToBuffer({ L"0123456789", L"abcdefghij", L"ABCDEFGHIJ", L"ab\u304bcd" }, *_buffer);
+    _buffer->GetRowByOffset(0).ReplaceAttributes(2, 5, red);
+
+    Log::Comment(L"Overlapping move to the right within the same rows.");
+    _buffer->CopyRectangle({ 2, 0, 5, 2 }, { 4, 0 });
+    VERIFY_ARE_EQUAL(L"0123234789", _buffer->GetRowByOffset(0).GetText());
+    VERIFY_ARE_EQUAL(L"abcdcdehij", _buffer->GetRowByOffset(1).GetText());
+    VERIFY_ARE_EQUAL(attr, _buffer->GetRowByOffset(0).GetAttrByColumn(1));
+    for (til::CoordType x = 2; x < 7; ++x)
+    {
+        VERIFY_ARE_EQUAL(red, _buffer->GetRowByOffset(0).GetAttrByColumn(x));
+    }
+    VERIFY_ARE_EQUAL(attr, _buffer->GetRowByOffset(0).GetAttrByColumn(7));
+
+    Log::Comment(L"Overlapping move downwards.");
+    _buffer->CopyRectangle({ 0, 0, 3, 2 }, { 0, 1 });
+    VERIFY_ARE_EQUAL(L"0123234789", _buffer->GetRowByOffset(0).GetText());
+    VERIFY_ARE_EQUAL(L"012dcdehij", _buffer->GetRowByOffset(1).GetText());
+    VERIFY_ARE_EQUAL(L"abcDEFGHIJ", _buffer->GetRowByOffset(2).GetText());
+    VERIFY_ARE_EQUAL(red, _buffer->GetRowByOffset(1).GetAttrByColumn(2));
+
+    Log::Comment(L"The trailing half of a wide glyph at the left edge turns into whitespace.");
+    _buffer->CopyRectangle({ 3, 3, 5, 4 }, { 0, 2 });
+    VERIFY_ARE_EQUAL(L" ccDEFGHIJ", _buffer->GetRowByOffset(2).GetText());
+
+    Log::Comment(L"The leading half of a wide glyph at the right edge turns into whitespace.");
+    _buffer->CopyRectangle({ 0, 3, 3, 4 }, { 5, 1 });
+    VERIFY_ARE_EQUAL(L"012dcab ij", _buffer->GetRowByOffset(1).GetText());
+}
+
+// Scrolls a 50 row margin region with left/right margins within a large buffer.
+// This can't use ScrollRows() and has to copy the row contents instead.
+void TextBufferTests::CopyRectanglePerformance()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD_PROPERTIES()
+
+    const til::size bufferSize{ 120, 9001 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    const til::rect margins{ 20, bufferSize.height - 60, 100, bufferSize.height - 10 };
+    const auto count = 10000;
+
+    std::wstring line(gsl::narrow_cast<size_t>(bufferSize.width), L'x');
+    for (auto y = margins.top; y < margins.bottom; ++y)
+    {
+        RowWriteState state{ .text = line };
+        _buffer->Write(y, attr, state);
+    }
+
+    Log::Comment(L"Working. Please wait...");
+    const auto now = std::chrono::steady_clock::now();
+
+    for (auto i = 0; i < count; ++i)
+    {
+        _buffer->CopyRectangle({ margins.left, margins.top + 1, margins.right, margins.bottom }, margins.origin());
+        _buffer->FillRect({ margins.left, margins.bottom - 1, margins.right, margins.bottom }, L"y", attr);
+    }
+
+    const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - now).count();
+    Log::Comment(String().Format(L"%d scrolls took %lld us. Avg %lld ns per scroll", count, delta, delta * 1000 / count));
+}
+
+// ReplaceText() processes ASCII 8 or 16 characters at a time. This tests
+// non-ASCII characters at every position relative to those chunks.
+void TextBufferTests::TestReplaceTextASCII()
+{
+    const til::size bufferSize{ 80, 1 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+    auto& row = _buffer->GetRowByOffset(0);
+
+    for (size_t prefix = 0; prefix < 40; ++prefix)
+    {
+        row.Reset(attr);
+
+        std::wstring text(prefix, L'a');
+        text.append(L"\u304b");
+        text.append(20, L'b');
+
+        RowWriteState state{ .text = text, .columnBegin = 3, .columnLimit = bufferSize.width };
+        row.ReplaceText(state);
+
+        const auto column = gsl::narrow<til::CoordType>(prefix) + 3;
+        VERIFY_ARE_EQUAL(column + 22, state.columnEnd);
+        VERIFY_ARE_EQUAL(std::wstring_view{ text }, row.GetText(3, state.columnEnd));
+        VERIFY_ARE_EQUAL(prefix ? L"a" : L" ", row.GlyphAt(column - 1));
+        VERIFY_ARE_EQUAL(DbcsAttribute::Leading, row.DbcsAttrAt(column));
+        VERIFY_ARE_EQUAL(DbcsAttribute::Trailing, row.DbcsAttrAt(column + 1));
+        VERIFY_ARE_EQUAL(L"b", row.GlyphAt(column + 2));
+    }
+
+    Log::Comment(L"ASCII text that exceeds the row is cut off at columnLimit.");
+    row.Reset(attr);
+    const std::wstring text(100, L'c');
+    RowWriteState state{ .text = text, .columnBegin = 10, .columnLimit = 70 };
+    row.ReplaceText(state);
+    VERIFY_ARE_EQUAL(70, state.columnEnd);
+    VERIFY_ARE_EQUAL(40u, state.text.size());
+    VERIFY_ARE_EQUAL(L" ", row.GlyphAt(70));
+}
+
+// Writes full rows of ASCII text, which is what the output of `cat`ing a log file mostly consists of.
+void TextBufferTests::ReplaceTextPerformance()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD_PROPERTIES()
+
+    const til::size bufferSize{ 120, 1 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+    auto& row = _buffer->GetRowByOffset(0);
+
+    std::wstring line;
+    for (auto i = 0; i < bufferSize.width; ++i)
+    {
+        line.push_back(gsl::narrow_cast<wchar_t>(L'!' + i % 94));
+    }
+
+    const auto count = 1000000;
+
+    Log::Comment(L"Working. Please wait...");
+    const auto now = std::chrono::steady_clock::now();
+
+    for (auto i = 0; i < count; ++i)
+    {
+        RowWriteState state{ .text = line, .columnLimit = bufferSize.width };
+        row.ReplaceText(state);
+    }
+
+    const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - now).count();
+    Log::Comment(String().Format(L"%d rows took %lld us. Avg %lld ns per row", count, delta, delta * 1000 / count));
+}
+
 void TextBufferTests::TestMixedRgbAndLegacyForeground()
 {
     auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
@@ -2127,31 +2381,31 @@ void TextBufferTests::TestRowReplaceText()
 void TextBufferTests::TestAppendRTFText()
 {
     {
-        std::ostringstream contentStream;
+        std::string contentStream;
         const auto ascii = L"This is some Ascii \\ {}";
         TextBuffer::_AppendRTFText(contentStream, ascii);
-        VERIFY_ARE_EQUAL("This is some Ascii \\\\ \\{\\}", contentStream.str());
+        VERIFY_ARE_EQUAL("This is some Ascii \\\\ \\{\\}", contentStream);
     }
     {
-        std::ostringstream contentStream;
+        std::string contentStream;
         // "Low code units: á é í ó ú ⮁ ⮂" in UTF-16
         const auto lowCodeUnits = L"Low code units: \x00E1 \x00E9 \x00ED \x00F3 \x00FA \x2B81 \x2B82";
         TextBuffer::_AppendRTFText(contentStream, lowCodeUnits);
-        VERIFY_ARE_EQUAL("Low code units: \\u225? \\u233? \\u237? \\u243? \\u250? \\u11137? \\u11138?", contentStream.str());
+        VERIFY_ARE_EQUAL("Low code units: \\u225? \\u233? \\u237? \\u243? \\u250? \\u11137? \\u11138?", contentStream);
     }
     {
-        std::ostringstream contentStream;
+        std::string contentStream;
         // "High code units: ꞵ ꞷ" in UTF-16
         const auto highCodeUnits = L"High code units: \xA7B5 \xA7B7";
         TextBuffer::_AppendRTFText(contentStream, highCodeUnits);
-        VERIFY_ARE_EQUAL("High code units: \\u-22603? \\u-22601?", contentStream.str());
+        VERIFY_ARE_EQUAL("High code units: \\u-22603? \\u-22601?", contentStream);
     }
     {
-        std::ostringstream contentStream;
+        std::string contentStream;
         // "Surrogates: 🍦 👾 👀" in UTF-16
         const auto surrogates = L"Surrogates: \xD83C\xDF66 \xD83D\xDC7E \xD83D\xDC40";
         TextBuffer::_AppendRTFText(contentStream, surrogates);
-        VERIFY_ARE_EQUAL("Surrogates: \\u-10180?\\u-8346? \\u-10179?\\u-9090? \\u-10179?\\u-9152?", contentStream.str());
+        VERIFY_ARE_EQUAL("Surrogates: \\u-10180?\\u-8346? \\u-10179?\\u-9090? \\u-10179?\\u-9152?", contentStream);
     }
 }
 
@@ -2735,6 +2989,147 @@ void TextBufferTests::GetText()
     }
 }
 
+// This tests that GetText() returns one color run per attribute run
+// and that wide glyphs at the edges of the selection are handled like copying text does.
+void TextBufferTests::GetTextColorRuns()
+{
+    const til::size bufferSize{ 10, 4 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    // "ab\x3042cd" occupies the columns a=0, b=1, \x3042=2-3, c=4, d=5.
+    WriteLinesToBuffer({ L"ab\x3042cd" }, *_buffer);
+    auto& row = _buffer->GetRowByOffset(0);
+    row.ReplaceAttributes(0, 2, TextAttribute{ 0x0c });
+    row.ReplaceAttributes(2, 6, TextAttribute{ 0x0a });
+
+    const auto getColors = [](const TextAttribute& attr) {
+        return std::pair<COLORREF, COLORREF>{ attr.GetLegacyAttributes(), 0 };
+    };
+    const auto getText = [&](til::CoordType left, til::CoordType right, bool trimTrailingWhitespace) {
+        const std::vector<til::inclusive_rect> rects{ { left, 0, right, 0 } };
+        return _buffer->GetText(false, trimTrailingWhitespace, rects, getColors, true);
+    };
+    const auto verifyRuns = [](const TextBuffer::TextAndColor& actual, std::wstring_view text, std::initializer_list<std::pair<size_t, COLORREF>> runs) {
+        VERIFY_ARE_EQUAL(1u, actual.text.size());
+        VERIFY_ARE_EQUAL(1u, actual.colors.size());
+        VERIFY_ARE_EQUAL(text, actual.text[0]);
+        VERIFY_ARE_EQUAL(runs.size(), actual.colors[0].size());
+        auto it = actual.colors[0].begin();
+        for (const auto& [length, foreground] : runs)
+        {
+            VERIFY_ARE_EQUAL(length, it->length);
+            VERIFY_ARE_EQUAL(foreground, it->foreground);
+            ++it;
+        }
+    };
+
+    Log::Comment(L"Runs are clipped to the selection and counted in code units, not columns.");
+    verifyRuns(getText(1, 6, false), L"b\x3042cd ", { { 1, 0x0c }, { 3, 0x0a }, { 1, 0x7f } });
+
+    Log::Comment(L"Trimming trailing whitespace trims the runs as well.");
+    verifyRuns(getText(1, 9, true), L"b\x3042cd", { { 1, 0x0c }, { 3, 0x0a } });
+
+    Log::Comment(L"A selection starting on the trailing half of a wide glyph excludes it.");
+    verifyRuns(getText(3, 4, false), L"c", { { 1, 0x0a } });
+
+    Log::Comment(L"A selection ending on the leading half of a wide glyph includes it.");
+    verifyRuns(getText(0, 2, false), L"ab\x3042", { { 2, 0x0c }, { 1, 0x0a } });
+}
+
+// This tests the exact HTML and RTF generated from a set of color runs.
+void TextBufferTests::GenRichTextFromColorRuns()
+{
+    constexpr auto red = RGB(0xff, 0x00, 0x00);
+    constexpr auto green = RGB(0x00, 0xff, 0x00);
+    constexpr auto black = RGB(0x00, 0x00, 0x00);
+    constexpr auto background = RGB(0x0c, 0x0c, 0x0c);
+
+    TextBuffer::TextAndColor rows;
+    rows.text = { L"a<b\r\n", L"c" };
+    rows.colors = {
+        { { 1, red, black }, { 2, green, black }, { 2, black, black } },
+        { { 1, green, black } },
+    };
+
+    {
+        const auto html = TextBuffer::GenHTML(rows, 12, L"Consolas", background);
+
+        // The header is followed by the HTML it describes.
+        VERIFY_ARE_EQUAL("Version:0.9\r\nStartHTML:0000000157\r\n", html.substr(0, 35));
+        VERIFY_ARE_EQUAL(fmt::format("EndHTML:{:010}", html.size()), html.substr(35, 18));
+        VERIFY_ARE_EQUAL("<!DOCTYPE>", html.substr(157, 10));
+
+        const std::string expected{
+            "<DIV STYLE=\"display:inline-block;white-space:pre;background-color:#0C0C0C;font-family:'Consolas',monospace;font-size:12pt;padding:4px;\">"
+            "<SPAN STYLE=\"color:#FF0000;background-color:#000000;\">a</SPAN>"
+            "<SPAN STYLE=\"color:#00FF00;background-color:#000000;\">&lt;b<BR>c</SPAN>"
+            "</DIV>"
+        };
+        VERIFY_ARE_NOT_EQUAL(std::string::npos, html.find(expected));
+    }
+
+    {
+        const auto rtf = TextBuffer::GenRTF(rows, 12, L"Consolas", background);
+        const std::string expected{
+            "{\\rtf1\\ansi\\ansicpg1252\\deff0\\nouicompat{\\fonttbl{\\f0\\fmodern\\fcharset0 Consolas;}}"
+            "{\\colortbl ;\\red12\\green12\\blue12;\\red0\\green0\\blue0;\\red255\\green0\\blue0;\\red0\\green255\\blue0;}"
+            "\\viewkind4\\uc4\\pard\\slmult1\\f0\\fs24\\highlight1 "
+            "\\highlight2\\cf3 a\\highlight2\\cf4 <b\\line c}"
+        };
+        VERIFY_ARE_EQUAL(expected, rtf);
+    }
+}
+
+// Copies a full, colorful 9001 row buffer as HTML and RTF.
+void TextBufferTests::GenRichTextPerformance()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD_PROPERTIES()
+
+    const til::size bufferSize{ 120, 9001 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    // Every row is filled with text and has a new color every 8 columns.
+    const std::wstring line(bufferSize.width, L'x');
+    for (til::CoordType y = 0; y < bufferSize.height; ++y)
+    {
+        _buffer->Write(OutputCellIterator{ line }, { 0, y });
+        auto& row = _buffer->GetRowByOffset(y);
+        for (til::CoordType x = 0; x < bufferSize.width; x += 8)
+        {
+            row.ReplaceAttributes(x, x + 8, TextAttribute{ gsl::narrow_cast<WORD>((x + y) % 0x100) });
+        }
+    }
+
+    const auto textRects = _buffer->GetTextRects({ 0, 0 }, { bufferSize.width - 1, bufferSize.height - 1 }, false, false);
+    const auto getColors = [](const TextAttribute& attr) {
+        return std::pair<COLORREF, COLORREF>{ attr.GetLegacyAttributes() & 0x0f, attr.GetLegacyAttributes() >> 4 };
+    };
+
+    Log::Comment(L"Working. Please wait...");
+    const auto start = std::chrono::steady_clock::now();
+    const auto rows = _buffer->GetText(true, true, textRects, getColors);
+    const auto afterText = std::chrono::steady_clock::now();
+    const auto html = TextBuffer::GenHTML(rows, 12, L"Consolas", 0);
+    const auto afterHTML = std::chrono::steady_clock::now();
+    const auto rtf = TextBuffer::GenRTF(rows, 12, L"Consolas", 0);
+    const auto afterRTF = std::chrono::steady_clock::now();
+
+    const auto us = [](auto delta) { return std::chrono::duration_cast<std::chrono::microseconds>(delta).count(); };
+    Log::Comment(String().Format(L"GetText took %lld us", us(afterText - start)));
+    Log::Comment(String().Format(L"GenHTML took %lld us for %zu bytes", us(afterHTML - afterText), html.size()));
+    Log::Comment(String().Format(L"GenRTF took %lld us for %zu bytes", us(afterRTF - afterHTML), rtf.size()));
+
+    VERIFY_ARE_EQUAL(gsl::narrow_cast<size_t>(bufferSize.height), rows.text.size());
+    VERIFY_IS_FALSE(html.empty());
+    VERIFY_IS_FALSE(rtf.empty());
+}
+
 // This tests that when we increment the circular buffer, obsolete hyperlink references
 // are removed from the hyperlink map
 void TextBufferTests::HyperlinkTrim()
@@ -2815,3 +3210,296 @@ void TextBufferTests::NoHyperlinkTrim()
     VERIFY_ARE_EQUAL(_buffer->GetHyperlinkUriFromId(id), url);
     VERIFY_ARE_EQUAL(_buffer->_hyperlinkCustomIdMap[finalCustomId], id);
 }
+
+// Simulates `ls --hyperlink` output: every row contains a couple of hyperlinks,
+// some of which are unique to the row, while others are shared with later rows.
+void TextBufferTests::HyperlinkTrimPerformance()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD_PROPERTIES()
+
+    const til::size bufferSize{ 120, 9001 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    const auto writeRow = [&](til::CoordType y, int i) {
+        for (til::CoordType x = 0; x < bufferSize.width; x += 60)
+        {
+            // The first link is shared between 16 consecutive rows. IDs are only 16 bits
+            // large, so we need to be a bit careful to not run out of them in this test.
+            const auto uri = x ? fmt::format(FMT_COMPILE(L"file://host/dir/{}/{}"), i, x) : fmt::format(FMT_COMPILE(L"file://host/shared/{}"), i / 16);
+            const auto id = _buffer->GetHyperlinkId(uri, {});
+            _buffer->AddHyperlinkToMap(uri, id);
+            auto linkAttr = attr;
+            linkAttr.SetHyperlinkId(id);
+            _buffer->GetRowByOffset(y).ReplaceAttributes(x, x + 10, linkAttr);
+        }
+    };
+
+    for (til::CoordType y = 0; y < bufferSize.height; ++y)
+    {
+        writeRow(y, y);
+    }
+
+    const auto count = 20000;
+
+    Log::Comment(L"Working. Please wait...");
+    const auto now = std::chrono::steady_clock::now();
+
+    for (auto i = 0; i < count; ++i)
+    {
+        _buffer->IncrementCircularBuffer();
+        writeRow(bufferSize.height - 1, bufferSize.height + i);
+    }
+
+    const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - now).count();
+    Log::Comment(String().Format(L"%d rows took %lld us. Avg %lld us per row", count, delta, delta / count));
+
+    // Only the links of the rows that are still in the buffer may remain.
+    VERIFY_IS_LESS_THAN_OR_EQUAL(_buffer->_hyperlinkMap.size(), gsl::narrow_cast<size_t>(bufferSize.height) * 2);
+}
+
+// This tests that GetPatterns finds matches across wrapped rows and that
+// its cache notices when the text of a row changes.
+void TextBufferTests::GetPatterns()
+{
+    const til::size bufferSize{ 20, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    const auto id = _buffer->AddPatternRecognizer(linkPattern);
+
+    // "https://example.com/foo" is 23 characters long and wraps into the second row.
+    WriteLinesToBuffer({ L"x https://example.com/foo", L"", L"", L"http://a.b c" }, *_buffer);
+    VERIFY_IS_TRUE(_buffer->GetRowByOffset(0).WasWrapForced());
+
+    auto tree = _buffer->GetPatterns(0, 4);
+    auto results = tree.findOverlapping({ 0, 0 }, { 19, 4 });
+    VERIFY_ARE_EQUAL(2u, results.size());
+    std::sort(results.begin(), results.end(), [](const auto& a, const auto& b) { return a.start < b.start; });
+    VERIFY_ARE_EQUAL(id, results[0].value);
+    VERIFY_ARE_EQUAL(til::point(2, 0), results[0].start);
+    VERIFY_ARE_EQUAL(til::point(5, 1), results[0].stop);
+    VERIFY_ARE_EQUAL(til::point(0, 3), results[1].start);
+    VERIFY_ARE_EQUAL(til::point(10, 3), results[1].stop);
+
+    // Overwriting the second URL must be picked up by the next call, while the first one stays.
+    WriteLinesToBuffer({ L"", L"", L"", L"no links here" }, *_buffer);
+    tree = _buffer->GetPatterns(0, 4);
+    results = tree.findOverlapping({ 0, 0 }, { 19, 4 });
+    VERIFY_ARE_EQUAL(1u, results.size());
+    VERIFY_ARE_EQUAL(til::point(2, 0), results[0].start);
+
+    // The results are relative to firstRow.
+    tree = _buffer->GetPatterns(3, 4);
+    VERIFY_IS_TRUE(tree.findOverlapping({ 0, 0 }, { 19, 1 }).empty());
+    WriteLinesToBuffer({ L"", L"", L"", L"", L"file://c" }, *_buffer);
+    tree = _buffer->GetPatterns(3, 4);
+    results = tree.findOverlapping({ 0, 0 }, { 19, 1 });
+    VERIFY_ARE_EQUAL(1u, results.size());
+    VERIFY_ARE_EQUAL(til::point(0, 1), results[0].start);
+
+    // Breaking up the wrapped line invalidates the cached matches of the first row as well.
+    _buffer->SetWrapForced(0, false);
+    tree = _buffer->GetPatterns(0, 1);
+    results = tree.findOverlapping({ 0, 0 }, { 19, 1 });
+    VERIFY_ARE_EQUAL(1u, results.size());
+    VERIFY_ARE_EQUAL(til::point(2, 0), results[0].start);
+    VERIFY_ARE_NOT_EQUAL(til::point(5, 1), results[0].stop);
+}
+
+// Simulates tailing a log with URL detection enabled: a new line scrolls
+// into the viewport and the patterns of the viewport get recomputed.
+void TextBufferTests::GetPatternsPerformance()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD_PROPERTIES()
+
+    const til::size bufferSize{ 200, 9001 };
+    const til::CoordType viewportHeight = 50;
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+    _buffer->AddPatternRecognizer(linkPattern);
+
+    const auto viewportTop = bufferSize.height - viewportHeight;
+    const auto viewportBottom = bufferSize.height - 1;
+    const auto count = 10000;
+
+    Log::Comment(L"Working. Please wait...");
+    const auto now = std::chrono::steady_clock::now();
+
+    for (auto i = 0; i < count; ++i)
+    {
+        _buffer->IncrementCircularBuffer();
+
+        auto line = fmt::format(FMT_COMPILE(L"{:08} [info] GET https://example.com/api/v1/items/{} -> 200 OK "), i, i);
+        line.resize(gsl::narrow_cast<size_t>(bufferSize.width), L'.');
+        RowWriteState state{ .text = line };
+        _buffer->Write(viewportBottom, attr, state);
+
+        const auto tree = _buffer->GetPatterns(viewportTop, viewportBottom);
+        VERIFY_IS_FALSE(tree.findOverlapping({ 0, viewportHeight - 1 }, { bufferSize.width - 1, viewportHeight - 1 }).empty());
+    }
+
+    const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - now).count();
+    Log::Comment(String().Format(L"%d lines took %lld us. Avg %lld us per line", count, delta, delta / count));
+}
+
+void TextBufferTests::SearchText()
+{
+    const til::size bufferSize{ 10, 5 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    // "xxxxxxxxaBCd" is 12 characters long and wraps into the second row.
+    WriteLinesToBuffer({ L"xxxxxxxxaBCd", L"", L"aaaa", L"a\u304bb" }, *_buffer);
+    VERIFY_IS_TRUE(_buffer->GetRowByOffset(0).WasWrapForced());
+
+    Log::Comment(L"Matches continue across soft-wrapped rows and respect the case sensitivity.");
+    auto results = _buffer->SearchText(L"abc", true);
+    VERIFY_ARE_EQUAL(1u, results.size());
+    VERIFY_ARE_EQUAL(til::point(8, 0), results[0].start);
+    VERIFY_ARE_EQUAL(til::point(0, 1), results[0].end);
+    VERIFY_IS_TRUE(_buffer->SearchText(L"abc", false).empty());
+    VERIFY_ARE_EQUAL(1u, _buffer->SearchText(L"aBC", false).size());
+
+    Log::Comment(L"Overlapping matches are all reported, in order.");
+    results = _buffer->SearchText(L"aa", false);
+    VERIFY_ARE_EQUAL(3u, results.size());
+    for (til::CoordType i = 0; i < 3; ++i)
+    {
+        VERIFY_ARE_EQUAL(til::point(i, 2), results[i].start);
+        VERIFY_ARE_EQUAL(til::point(i + 1, 2), results[i].end);
+    }
+
+    Log::Comment(L"Wide glyphs map to both of their columns.");
+    results = _buffer->SearchText(L"a\u304b", false);
+    VERIFY_ARE_EQUAL(1u, results.size());
+    VERIFY_ARE_EQUAL(til::point(0, 3), results[0].start);
+    VERIFY_ARE_EQUAL(til::point(2, 3), results[0].end);
+    results = _buffer->SearchText(L"\u304bb", false);
+    VERIFY_ARE_EQUAL(1u, results.size());
+    VERIFY_ARE_EQUAL(til::point(1, 3), results[0].start);
+    VERIFY_ARE_EQUAL(til::point(3, 3), results[0].end);
+
+    Log::Comment(L"The row range limits the search.");
+    VERIFY_IS_TRUE(_buffer->SearchText(L"aa", false, 0, 2).empty());
+    VERIFY_ARE_EQUAL(3u, _buffer->SearchText(L"aa", false, 2, 3).size());
+
+    Log::Comment(L"Writing to the buffer changes its mutation ID, which Search uses to detect stale results.");
+    const auto id = _buffer->GetLastMutationId();
+    // Merely accessing a ROW through the non-const overload must not invalidate searches.
+    VERIFY_IS_FALSE(_buffer->GetRowByOffset(0).GetText().empty());
+    VERIFY_ARE_EQUAL(id, _buffer->GetLastMutationId());
+    WriteLinesToBuffer({ L"", L"", L"", L"", L"abc" }, *_buffer);
+    VERIFY_ARE_NOT_EQUAL(id, _buffer->GetLastMutationId());
+    VERIFY_ARE_EQUAL(2u, _buffer->SearchText(L"abc", true).size());
+}
+
+// Simulates a "find all" over a full scrollback of log output.
+void TextBufferTests::SearchTextPerformance()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD_PROPERTIES()
+
+    const til::size bufferSize{ 120, 9001 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    for (til::CoordType y = 0; y < bufferSize.height; ++y)
+    {
+        auto line = fmt::format(FMT_COMPILE(L"{:08} [{}] GET https://example.com/api/v1/items/{} "), y, y % 100 == 0 ? L"ERROR" : L"info", y);
+        line.resize(gsl::narrow_cast<size_t>(bufferSize.width), L'.');
+        RowWriteState state{ .text = line };
+        _buffer->Write(y, attr, state);
+    }
+
+    const auto count = 20;
+
+    Log::Comment(L"Working. Please wait...");
+    const auto now = std::chrono::steady_clock::now();
+
+    for (auto i = 0; i < count; ++i)
+    {
+        const auto results = _buffer->SearchText(L"error", true);
+        VERIFY_ARE_EQUAL(91u, results.size());
+    }
+
+    const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - now).count();
+    Log::Comment(String().Format(L"%d searches took %lld us. Avg %lld us per search", count, delta, delta / count));
+}
+
+void TextBufferTests::SearchRegex()
+{
+    const til::size bufferSize{ 10, 5 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    // "log ERROR 1234" is 14 characters long and wraps into the second row.
+    WriteLinesToBuffer({ L"log ERROR 1234", L"", L"\u304b 42" }, *_buffer);
+    VERIFY_IS_TRUE(_buffer->GetRowByOffset(0).WasWrapForced());
+
+    Log::Comment(L"Matches continue across soft-wrapped rows.");
+    auto results = _buffer->SearchRegex(std::wregex{ LR"(ERROR\s+\d{4})" }, 0, bufferSize.height);
+    VERIFY_ARE_EQUAL(1u, results.size());
+    VERIFY_ARE_EQUAL(til::point(4, 0), results[0].start);
+    VERIFY_ARE_EQUAL(til::point(3, 1), results[0].end);
+
+    Log::Comment(L"Wide glyphs before a match shift it by two columns.");
+    results = _buffer->SearchRegex(std::wregex{ LR"(\d+)" }, 0, bufferSize.height);
+    VERIFY_ARE_EQUAL(2u, results.size());
+    VERIFY_ARE_EQUAL(til::point(0, 1), results[0].start);
+    VERIFY_ARE_EQUAL(til::point(3, 1), results[0].end);
+    VERIFY_ARE_EQUAL(til::point(3, 2), results[1].start);
+    VERIFY_ARE_EQUAL(til::point(4, 2), results[1].end);
+
+    Log::Comment(L"Case sensitivity is up to the regex and empty matches are skipped.");
+    VERIFY_IS_TRUE(_buffer->SearchRegex(std::wregex{ L"error" }, 0, bufferSize.height).empty());
+    VERIFY_ARE_EQUAL(1u, _buffer->SearchRegex(std::wregex{ L"error", std::regex_constants::icase }, 0, bufferSize.height).size());
+    VERIFY_IS_TRUE(_buffer->SearchRegex(std::wregex{ L"z*" }, 0, bufferSize.height).empty());
+}
+
+// Simulates a regex "find all" over a full scrollback of log output.
+void TextBufferTests::SearchRegexPerformance()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD_PROPERTIES()
+
+    const til::size bufferSize{ 120, 9001 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, false, _renderer);
+
+    for (til::CoordType y = 0; y < bufferSize.height; ++y)
+    {
+        auto line = y % 100 == 0 ? fmt::format(FMT_COMPILE(L"{:08} ERROR  {:04} request failed "), y, y % 10000) : fmt::format(FMT_COMPILE(L"{:08} info GET https://example.com/api/v1/items/{} "), y, y);
+        line.resize(gsl::narrow_cast<size_t>(bufferSize.width), L'.');
+        RowWriteState state{ .text = line };
+        _buffer->Write(y, attr, state);
+    }
+
+    const std::wregex regex{ LR"(ERROR\s+\d{4})", std::regex_constants::ECMAScript | std::regex_constants::optimize };
+    const auto count = 5;
+
+    Log::Comment(L"Working. Please wait...");
+    const auto now = std::chrono::steady_clock::now();
+
+    for (auto i = 0; i < count; ++i)
+    {
+        const auto results = _buffer->SearchRegex(regex, 0, bufferSize.height);
+        VERIFY_ARE_EQUAL(91u, results.size());
+    }
+
+    const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - now).count();
+    Log::Comment(String().Format(L"%d searches took %lld us. Avg %lld us per search", count, delta, delta / count));
+}
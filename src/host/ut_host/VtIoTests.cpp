@@ -396,6 +396,11 @@ public:
     {
         return {};
     }
+
+    std::span<const til::CoordType> GetPatternBoundaries(const til::CoordType /*row*/) const noexcept
+    {
+        return {};
+    }
 };
 
 void VtIoTests::RendererDtorAndThread()
@@ -6,6 +6,8 @@
 #include "../../inc/consoletaeftemplates.hpp"
 #include "../../types/inc/Viewport.hpp"
 
+#include "../../buffer/out/textBuffer.hpp"
+#include "../../renderer/inc/DummyRenderer.hpp"
 #include "../../renderer/vt/Xterm256Engine.hpp"
 #include "../../renderer/vt/XtermEngine.hpp"
 #include "../Settings.hpp"
@@ -83,6 +85,18 @@ class Microsoft::Console::Render::VtRendererTest
 
     TEST_METHOD(TestCursorVisibility);
 
+    TEST_METHOD(TestFrameDiffing);
+
+    TEST_METHOD(TestOutputBackPressure);
+
+    TEST_METHOD(TestNoFlushOnEndHoldsBackFrame);
+
+    TEST_METHOD(TestPaintBufferRow);
+
+    BEGIN_TEST_METHOD(FrameDiffingByteCount)
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD()
+
     void Test16Colors(VtEngine* engine);
 
     std::deque<std::string> qExpectedInput;
@@ -416,9 +430,9 @@ void VtRendererTest::Xterm256TestColors()
 
     Log::Comment(NoThrowString().Format(
         L"Begin by setting some test values - FG,BG = (1,2,3), (4,5,6) to start"
-        L"These values were picked for ease of formatting raw COLORREF values."));
-    qExpectedInput.push_back("\x1b[38;2;1;2;3m");
-    qExpectedInput.push_back("\x1b[48;2;5;6;7m");
+        L"These values were picked for ease of formatting raw COLORREF values."
+        L" Both colors should be set with a single sequence."));
+    qExpectedInput.push_back("\x1b[38;2;1;2;3;48;2;5;6;7m");
     VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes({ 0x00030201, 0x00070605 },
                                                   renderSettings,
                                                   &renderData,
@@ -805,6 +819,11 @@ void VtRendererTest::Xterm256TestAttributesAcrossReset()
     std::stringstream renditionSequence;
     renditionSequence << "\x1b[" << renditionAttribute << "m";
 
+    // When the colors are reset, the rendition has to be reapplied. That should
+    // be done in the same sequence as the reset.
+    std::stringstream resetAndRenditionSequence;
+    resetAndRenditionSequence << "\x1b[0;" << renditionAttribute << "m";
+
     auto hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
     auto engine = std::make_unique<Xterm256Engine>(std::move(hFile), SetUpViewport());
     auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
@@ -872,8 +891,7 @@ void VtRendererTest::Xterm256TestAttributesAcrossReset()
 
     Log::Comment(L"----Reset Default Foreground and Retain Rendition----");
     textAttributes.SetDefaultForeground();
-    qExpectedInput.push_back("\x1b[m");
-    qExpectedInput.push_back(renditionSequence.str());
+    qExpectedInput.push_back(resetAndRenditionSequence.str());
     VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(textAttributes, renderSettings, &renderData, false, false));
 
     Log::Comment(L"----Set Green Background----");
@@ -883,8 +901,7 @@ void VtRendererTest::Xterm256TestAttributesAcrossReset()
 
     Log::Comment(L"----Reset Default Background and Retain Rendition----");
     textAttributes.SetDefaultBackground();
-    qExpectedInput.push_back("\x1b[m");
-    qExpectedInput.push_back(renditionSequence.str());
+    qExpectedInput.push_back(resetAndRenditionSequence.str());
     VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(textAttributes, renderSettings, &renderData, false, false));
 
     VerifyExpectedInputsDrained();
@@ -1594,3 +1611,340 @@ void VtRendererTest::FormattedString()
     qExpectedInput.push_back("\x1b[28;3;500;500;500m");
     VERIFY_SUCCEEDED(engine->_WriteFormatted(bigFormat, bigValue, bigValue, bigValue));
 }
+
+void VtRendererTest::TestFrameDiffing()
+{
+    auto view = SetUpViewport();
+    auto hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    auto engine = std::make_unique<Xterm256Engine>(std::move(hFile), view);
+    RenderSettings renderSettings;
+    RenderData renderData;
+
+    std::string output;
+    engine->SetTestCallback([&](const char* const pch, const size_t cch) {
+        output.append(pch, cch);
+        return true;
+    });
+    engine->SetFrameDiffing(true);
+
+    TestPaint(*engine, [&]() {});
+    output.clear();
+
+    const auto paintLine = [&](const std::wstring_view text, const TextAttribute& attr) {
+        std::vector<Cluster> clusters;
+        for (size_t i = 0; i < text.size(); i++)
+        {
+            clusters.emplace_back(text.substr(i, 1), 1);
+        }
+
+        til::rect invalid{ 0, 0, gsl::narrow_cast<til::CoordType>(text.size()), 1 };
+        VERIFY_SUCCEEDED(engine->Invalidate(&invalid));
+        TestPaint(*engine, [&]() {
+            VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes({}, renderSettings, &renderData, false, true));
+            VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(attr, renderSettings, &renderData, false, false));
+            VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false, false));
+        });
+    };
+
+    const TextAttribute attr{ 0x00030201, 0x00070605 };
+
+    Log::Comment(L"The first time a line is painted, all of it is emitted.");
+    paintLine(L"hello world", attr);
+    VERIFY_ARE_NOT_EQUAL(std::string::npos, output.find("hello world"));
+    output.clear();
+
+    Log::Comment(L"Repainting the same line shouldn't emit anything at all.");
+    paintLine(L"hello world", attr);
+    VERIFY_ARE_EQUAL(std::string{}, output);
+
+    Log::Comment(L"Changing a single cell should only emit that cell.");
+    paintLine(L"hello World", attr);
+    VERIFY_ARE_EQUAL(std::string{ "\x1b[1;7HW" }, output);
+    output.clear();
+
+    Log::Comment(L"Changing the attributes of unchanged text should repaint it.");
+    paintLine(L"hello World", TextAttribute{ 0x00030201, 0x00090807 });
+    VERIFY_ARE_NOT_EQUAL(std::string::npos, output.find("\x1b[48;2;7;8;9m"));
+    VERIFY_ARE_NOT_EQUAL(std::string::npos, output.find("hello World"));
+    output.clear();
+
+    Log::Comment(L"After a resize we no longer know what's on the screen.");
+    const auto newView = Viewport::FromDimensions({ 0, 0 }, { 120, 30 });
+    VERIFY_SUCCEEDED(engine->UpdateViewport(newView.ToInclusive()));
+    output.clear();
+    paintLine(L"hello World", TextAttribute{ 0x00030201, 0x00090807 });
+    VERIFY_ARE_NOT_EQUAL(std::string::npos, output.find("hello World"));
+}
+
+void VtRendererTest::TestOutputBackPressure()
+{
+    wil::unique_hfile readPipe;
+    wil::unique_hfile writePipe;
+    VERIFY_WIN32_BOOL_SUCCEEDED(CreatePipe(readPipe.addressof(), writePipe.addressof(), nullptr, 4096));
+
+    auto engine = std::make_unique<Xterm256Engine>(std::move(writePipe), SetUpViewport());
+
+    VtEngine::OutputPolicy policy;
+    policy.flushBytes = 1024;
+    policy.backPressureBytes = 16 * 1024;
+    engine->SetOutputPolicy(policy);
+
+    std::atomic<bool> drained{ false };
+    engine->SetOutputDrainedCallback([&]() {
+        drained.store(true);
+    });
+
+    Log::Comment(L"The first frame is never skipped.");
+    TestPaint(*engine, [&]() {});
+
+    Log::Comment(L"Write a lot more than the terminal reads.");
+    const std::string chunk(1024, 'a');
+    for (auto i = 0; i < 64; ++i)
+    {
+        VERIFY_SUCCEEDED(engine->WriteTerminalUtf8(chunk));
+    }
+    VERIFY_IS_TRUE(engine->IsOutputBackedUp());
+
+    Log::Comment(L"While the output is backed up, frames are skipped.");
+    VERIFY_SUCCEEDED(engine->InvalidateAll());
+    VERIFY_ARE_EQUAL(S_FALSE, engine->StartPaint());
+
+    Log::Comment(L"Once the terminal caught up, we're told to paint again.");
+    std::array<char, 4096> buffer;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{ 10 };
+    while (!drained.load() && std::chrono::steady_clock::now() < deadline)
+    {
+        DWORD available = 0;
+        VERIFY_WIN32_BOOL_SUCCEEDED(PeekNamedPipe(readPipe.get(), nullptr, 0, nullptr, &available, nullptr));
+        if (available == 0)
+        {
+            Sleep(1);
+            continue;
+        }
+
+        DWORD read = 0;
+        VERIFY_WIN32_BOOL_SUCCEEDED(ReadFile(readPipe.get(), buffer.data(), gsl::narrow_cast<DWORD>(buffer.size()), &read, nullptr));
+    }
+    VERIFY_IS_TRUE(drained.load());
+    VERIFY_IS_FALSE(engine->IsOutputBackedUp());
+
+    // The invalidated regions were kept while we skipped the frame.
+    VERIFY_ARE_EQUAL(S_OK, engine->StartPaint());
+    VERIFY_SUCCEEDED(engine->EndPaint());
+
+    // The writer thread would fail to write the final frame anyway.
+    readPipe.reset();
+}
+
+void VtRendererTest::TestNoFlushOnEndHoldsBackFrame()
+{
+    wil::unique_hfile readPipe;
+    wil::unique_hfile writePipe;
+    VERIFY_WIN32_BOOL_SUCCEEDED(CreatePipe(readPipe.addressof(), writePipe.addressof(), nullptr, 64 * 1024));
+
+    auto engine = std::make_unique<Xterm256Engine>(std::move(writePipe), SetUpViewport());
+
+    // Flush mid-frame as eagerly as possible.
+    VtEngine::OutputPolicy policy;
+    policy.flushBytes = 1024;
+    policy.flushLatency = std::chrono::milliseconds{ 0 };
+    engine->SetOutputPolicy(policy);
+
+    Log::Comment(L"The first frame is always flushed.");
+    TestPaint(*engine, [&]() {});
+    VERIFY_IS_TRUE(engine->_buffer.empty());
+
+    Log::Comment(L"A frame triggered by InvalidateFlush must not reach the pipe, not even partially.");
+    auto forcePaint = false;
+    VERIFY_SUCCEEDED(engine->InvalidateFlush(false, &forcePaint));
+    VERIFY_SUCCEEDED(engine->InvalidateAll());
+    const std::string chunk(4096, 'a');
+    TestPaint(*engine, [&]() {
+        VERIFY_SUCCEEDED(engine->WriteTerminalUtf8(chunk));
+        VERIFY_SUCCEEDED(engine->_FlushIfOverdue());
+        VERIFY_IS_GREATER_THAN_OR_EQUAL(engine->_buffer.size(), chunk.size());
+    });
+    VERIFY_IS_GREATER_THAN_OR_EQUAL(engine->_buffer.size(), chunk.size());
+
+    Log::Comment(L"The held back output is written with the next regular frame.");
+    VERIFY_SUCCEEDED(engine->InvalidateAll());
+    TestPaint(*engine, [&]() {});
+    VERIFY_IS_TRUE(engine->_buffer.empty());
+
+    // The writer thread would fail to write the final frame anyway.
+    readPipe.reset();
+}
+
+void VtRendererTest::TestPaintBufferRow()
+{
+    const auto view = SetUpViewport();
+    RenderSettings renderSettings;
+    RenderData renderData;
+
+    const TextAttribute red{ 0x000000ff, 0x00000000 };
+    const TextAttribute blue{ 0x00ff0000, 0x00000000 };
+    const TextAttribute underlined = [&]() {
+        auto attr = blue;
+        attr.SetUnderlined(true);
+        return attr;
+    }();
+
+    DummyRenderer renderer;
+    TextBuffer buffer{ { 20, 1 }, TextAttribute{}, 12, false, renderer };
+    buffer.Write(OutputCellIterator{ L"ab", red }, { 0, 0 });
+    buffer.Write(OutputCellIterator{ L"\u3042", blue }, { 2, 0 });
+    buffer.Write(OutputCellIterator{ L"  ", red }, { 4, 0 });
+    buffer.Write(OutputCellIterator{ L"cd", underlined }, { 6, 0 });
+    const auto& row = buffer.GetRowByOffset(0);
+
+    const auto makeEngine = [&](std::string& output) {
+        auto hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+        auto engine = std::make_unique<Xterm256Engine>(std::move(hFile), view);
+        engine->SetTestCallback([&](const char* const pch, const size_t cch) {
+            output.append(pch, cch);
+            return true;
+        });
+        TestPaint(*engine, [&]() {});
+        output.clear();
+        return engine;
+    };
+
+    const auto paintRow = [&](VtEngine& engine, const til::CoordType columnBegin, const til::CoordType columnEnd) {
+        BufferRowInfo rowInfo;
+        rowInfo.text = row.GetText();
+        rowInfo.charOffsets = row.CharOffsets();
+        rowInfo.attributes = &row.Attributes();
+        rowInfo.columnBegin = columnBegin;
+        rowInfo.columnEnd = columnEnd;
+        rowInfo.target = { columnBegin, 0 };
+        rowInfo.renderSettings = &renderSettings;
+        rowInfo.renderData = &renderData;
+
+        auto hr = S_OK;
+        TestPaint(engine, [&]() {
+            hr = engine.PaintBufferRow(rowInfo);
+        });
+        return hr;
+    };
+
+    const auto paintRuns = [&](VtEngine& engine, const std::vector<std::tuple<std::wstring_view, til::CoordType, TextAttribute>>& runs) {
+        TestPaint(engine, [&]() {
+            for (const auto& [text, column, attr] : runs)
+            {
+                std::vector<Cluster> clusters;
+                if (text == L"\u3042")
+                {
+                    clusters.emplace_back(text, 2);
+                }
+                else
+                {
+                    for (size_t i = 0; i < text.size(); i++)
+                    {
+                        clusters.emplace_back(text.substr(i, 1), 1);
+                    }
+                }
+                VERIFY_SUCCEEDED(engine.UpdateDrawingBrushes(attr, renderSettings, &renderData, false, false));
+                VERIFY_SUCCEEDED(engine.PaintBufferLine({ clusters.data(), clusters.size() }, { column, 0 }, false, false));
+            }
+        });
+    };
+
+    std::string expected;
+    std::string actual;
+    auto clusterEngine = makeEngine(expected);
+    auto rowEngine = makeEngine(actual);
+
+    Log::Comment(L"The row should be split into runs just like the renderer would do it, "
+                 L"with the spaces joining the preceding run, as they look the same either way.");
+    paintRuns(*clusterEngine, { { L"ab", 0, red }, { L"\u3042  ", 2, blue }, { L"cd", 6, underlined }, { std::wstring_view{ L"            " }, 8, TextAttribute{} } });
+    VERIFY_ARE_EQUAL(S_OK, paintRow(*rowEngine, 0, 20));
+    VERIFY_ARE_EQUAL(expected, actual);
+    expected.clear();
+    actual.clear();
+
+    Log::Comment(L"Painting only the trailing half of a wide glyph should paint all of it.");
+    VERIFY_SUCCEEDED(clusterEngine->InvalidateAll());
+    VERIFY_SUCCEEDED(rowEngine->InvalidateAll());
+    paintRuns(*clusterEngine, { { L"\u3042  ", 2, blue } });
+    VERIFY_ARE_EQUAL(S_OK, paintRow(*rowEngine, 3, 6));
+    VERIFY_ARE_EQUAL(expected, actual);
+    actual.clear();
+
+    Log::Comment(L"Engines that can't paint rows directly should ask for the fallback.");
+    rowEngine->SetFrameDiffing(true);
+    VERIFY_ARE_EQUAL(S_FALSE, paintRow(*rowEngine, 0, 20));
+}
+
+void VtRendererTest::FrameDiffingByteCount()
+{
+    // This simulates an htop-like application, which redraws the entire
+    // viewport every frame even though only a small counter changes per row.
+    static constexpr auto frames = 500;
+
+    const auto view = SetUpViewport();
+    const auto width = view.Width();
+    const auto height = view.Height();
+    RenderSettings renderSettings;
+    RenderData renderData;
+
+    const TextAttribute labelAttr{ 0x0000ff00, 0x00000000 };
+    const TextAttribute valueAttr{ 0x00ffffff, 0x00ff0000 };
+    const TextAttribute fillAttr{};
+
+    const auto measure = [&](const bool frameDiffing) {
+        auto hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+        auto engine = std::make_unique<Xterm256Engine>(std::move(hFile), view);
+        size_t bytes = 0;
+        engine->SetTestCallback([&](const char* const, const size_t cch) {
+            bytes += cch;
+            return true;
+        });
+        engine->SetFrameDiffing(frameDiffing);
+
+        std::vector<Cluster> clusters;
+        const auto paintRun = [&](const std::wstring_view text, const TextAttribute& attr, const til::point coord) {
+            clusters.clear();
+            for (size_t i = 0; i < text.size(); i++)
+            {
+                clusters.emplace_back(text.substr(i, 1), 1);
+            }
+            VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(attr, renderSettings, &renderData, false, false));
+            VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, coord, false, false));
+        };
+
+        const auto start = std::chrono::steady_clock::now();
+        for (auto frame = 0; frame < frames; ++frame)
+        {
+            VERIFY_SUCCEEDED(engine->InvalidateAll());
+            TestPaint(*engine, [&]() {
+                VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes({}, renderSettings, &renderData, false, true));
+                for (til::CoordType y = 0; y < height; ++y)
+                {
+                    const auto label = L"process " + std::to_wstring(y) + L": ";
+                    auto value = std::to_wstring((frame * 7919 + y * 104729) % 100000);
+                    value.insert(0, 6 - value.size(), L' ');
+                    const auto labelWidth = gsl::narrow_cast<til::CoordType>(label.size());
+                    const auto valueWidth = gsl::narrow_cast<til::CoordType>(value.size());
+                    const std::wstring fill(width - labelWidth - valueWidth, L'.');
+
+                    paintRun(label, labelAttr, { 0, y });
+                    paintRun(value, valueAttr, { labelWidth, y });
+                    paintRun(fill, fillAttr, { labelWidth + valueWidth, y });
+                }
+            });
+        }
+        const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+        Log::Comment(String().Format(L"frameDiffing=%d: %zu bytes in %d frames, %.2f ms",
+                                     frameDiffing,
+                                     bytes,
+                                     frames,
+                                     elapsed.count()));
+        return bytes;
+    };
+
+    const auto fullBytes = measure(false);
+    const auto diffBytes = measure(true);
+    Log::Comment(String().Format(L"Frame diffing emitted %.1f%% of the bytes", 100.0 * diffBytes / fullBytes));
+    VERIFY_IS_LESS_THAN(diffBytes, fullBytes);
+}
@@ -14,6 +14,10 @@ could overcome disadvantages of syscalls. Test results can be read up
 in PR #4093 and the test algorithms are available in src\tools\U8U16Test.
 Based on the results the decision was made to keep using the platform
 functions MultiByteToWideChar and WideCharToMultiByte.
+The exception are runs of ASCII, which make up the vast majority of
+terminal output (all VT sequences are ASCII) and which can be widened and
+narrowed with a few SIMD instructions. Everything else, including the
+handling of invalid sequences, is still left to the platform functions.
 
 Author(s):
 - Steffen Illhardt (german-one), Leonard Hecker (lhecker) 2020-2021
@@ -23,6 +27,182 @@ Author(s):
 
 namespace til // Terminal Implementation Library. Also: "Today I Learned"
 {
+    namespace details
+    {
+#pragma warning(push)
+#pragma warning(disable : 26429 26481 26490) // use not_null, pointer arithmetic, reinterpret_cast
+        // Non-ASCII segments are only ended by runs of ASCII this long, so that text
+        // mixing ASCII and other characters doesn't result in lots of tiny calls
+        // to the platform functions, whose overhead would exceed the gains.
+        inline constexpr int minASCIIRun = 16;
+
+        // Widens the leading ASCII characters of in into out.
+        // Returns the number of characters converted.
+        inline size_t u8u16_ascii(const char* in, const size_t count, wchar_t* out) noexcept
+        {
+            size_t i = 0;
+
+#if defined(TIL_SSE_INTRINSICS)
+            const auto z = _mm_setzero_si128();
+            for (const auto end = count & ~size_t{ 15 }; i < end; i += 16)
+            {
+                const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                // A byte is non-ASCII if its most significant bit is set.
+                if (_mm_movemask_epi8(v))
+                {
+                    break;
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi8(v, z));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), _mm_unpackhi_epi8(v, z));
+            }
+#elif defined(TIL_ARM_NEON_INTRINSICS)
+            for (const auto end = count & ~size_t{ 15 }; i < end; i += 16)
+            {
+                const auto v = vld1q_u8(reinterpret_cast<const uint8_t*>(in + i));
+                if (vmaxvq_u8(v) >= 0x80)
+                {
+                    break;
+                }
+                vst1q_u16(reinterpret_cast<uint16_t*>(out + i), vmovl_u8(vget_low_u8(v)));
+                vst1q_u16(reinterpret_cast<uint16_t*>(out + i + 8), vmovl_u8(vget_high_u8(v)));
+            }
+#endif
+
+#pragma loop(no_vector)
+            for (; i < count && static_cast<uint8_t>(in[i]) < 0x80; ++i)
+            {
+                out[i] = static_cast<wchar_t>(in[i]);
+            }
+
+            return i;
+        }
+
+        // Narrows the leading ASCII characters of in into out.
+        // Returns the number of characters converted.
+        inline size_t u16u8_ascii(const wchar_t* in, const size_t count, char* out) noexcept
+        {
+            size_t i = 0;
+
+#if defined(TIL_SSE_INTRINSICS)
+            // A character is non-ASCII if any of the bits in 0xff80 are set.
+            const auto nonASCII = _mm_set1_epi16(static_cast<short>(0xff80));
+            const auto z = _mm_setzero_si128();
+            for (const auto end = count & ~size_t{ 15 }; i < end; i += 16)
+            {
+                const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 8));
+                const auto ascii = _mm_cmpeq_epi16(_mm_and_si128(_mm_or_si128(a, b), nonASCII), z);
+                if (_mm_movemask_epi8(ascii) != 0xffff)
+                {
+                    break;
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(a, b));
+            }
+#elif defined(TIL_ARM_NEON_INTRINSICS)
+            for (const auto end = count & ~size_t{ 15 }; i < end; i += 16)
+            {
+                const auto a = vld1q_u16(reinterpret_cast<const uint16_t*>(in + i));
+                const auto b = vld1q_u16(reinterpret_cast<const uint16_t*>(in + i + 8));
+                if (vmaxvq_u16(vorrq_u16(a, b)) >= 0x80)
+                {
+                    break;
+                }
+                vst1q_u8(reinterpret_cast<uint8_t*>(out + i), vcombine_u8(vmovn_u16(a), vmovn_u16(b)));
+            }
+#endif
+
+#pragma loop(no_vector)
+            for (; i < count && in[i] < 0x80; ++i)
+            {
+                out[i] = static_cast<char>(in[i]);
+            }
+
+            return i;
+        }
+
+        // Returns the length of the non-ASCII segment at the start of in, which ends
+        // where a run of at least minASCIIRun ASCII characters starts (or at the end).
+        // ASCII characters always start a new code point, in UTF-8 as well as UTF-16.
+        template<typename T>
+        int non_ascii_segment(const T* in, const int count) noexcept
+        {
+            int end = 0;
+            int asciiRun = 0;
+            for (; end < count && asciiRun < minASCIIRun; ++end)
+            {
+                asciiRun = static_cast<std::make_unsigned_t<T>>(in[end]) < 0x80 ? asciiRun + 1 : 0;
+            }
+            return end - asciiRun;
+        }
+
+        // Converts UTF-8 to UTF-16 like MultiByteToWideChar does, but widens runs of ASCII
+        // on its own. out must have room for count characters, which is the worst case.
+        // Returns the number of characters written or 0 if MultiByteToWideChar failed.
+        inline int u8u16_convert(const char* in, int count, wchar_t* out, const int capacity) noexcept
+        {
+            int written = 0;
+            for (;;)
+            {
+                const auto ascii = gsl::narrow_cast<int>(u8u16_ascii(in, gsl::narrow_cast<size_t>(count), out + written));
+                in += ascii;
+                count -= ascii;
+                written += ascii;
+                if (!count)
+                {
+                    return written;
+                }
+
+                const auto segment = non_ascii_segment(in, count);
+                const auto converted = MultiByteToWideChar(CP_UTF8, 0UL, in, segment, out + written, capacity - written);
+                if (!converted)
+                {
+                    return 0;
+                }
+                in += segment;
+                count -= segment;
+                written += converted;
+                if (!count)
+                {
+                    return written;
+                }
+            }
+        }
+
+        // Converts UTF-16 to UTF-8 like WideCharToMultiByte does, but narrows runs of ASCII
+        // on its own. out must have room for 3 * count characters, which is the worst case.
+        // Returns the number of characters written or 0 if WideCharToMultiByte failed.
+        inline int u16u8_convert(const wchar_t* in, int count, char* out, const int capacity) noexcept
+        {
+            int written = 0;
+            for (;;)
+            {
+                const auto ascii = gsl::narrow_cast<int>(u16u8_ascii(in, gsl::narrow_cast<size_t>(count), out + written));
+                in += ascii;
+                count -= ascii;
+                written += ascii;
+                if (!count)
+                {
+                    return written;
+                }
+
+                const auto segment = non_ascii_segment(in, count);
+                const auto converted = WideCharToMultiByte(CP_UTF8, 0UL, in, segment, out + written, capacity - written, nullptr, nullptr);
+                if (!converted)
+                {
+                    return 0;
+                }
+                in += segment;
+                count -= segment;
+                written += converted;
+                if (!count)
+                {
+                    return written;
+                }
+            }
+        }
+#pragma warning(pop)
+    }
+
     // state structure for maintenance of UTF-8 partials
     struct u8state
     {
@@ -70,7 +250,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             // The worst ratio of UTF-8 code units to UTF-16 code units is 1 to 1 if UTF-8 consists of ASCII only.
             RETURN_HR_IF(E_ABORT, !base::MakeCheckedNum(in.length()).AssignIfValid(&lengthRequired));
             out.resize(in.length()); // avoid to call MultiByteToWideChar twice only to get the required size
-            const int lengthOut = MultiByteToWideChar(CP_UTF8, 0ul, in.data(), lengthRequired, out.data(), lengthRequired);
+            const int lengthOut = details::u8u16_convert(in.data(), lengthRequired, out.data(), lengthRequired);
             out.resize(gsl::narrow_cast<size_t>(lengthOut));
 
             return lengthOut == 0 ? E_UNEXPECTED : S_OK;
@@ -158,7 +338,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
 
             if (len8)
             {
-                const auto convLen{ MultiByteToWideChar(CP_UTF8, 0UL, cursor8, len8, out.data() + len16, capa16) };
+                const auto convLen{ details::u8u16_convert(cursor8, len8, out.data() + len16, capa16) };
                 RETURN_HR_IF(E_UNEXPECTED, !convLen);
 
                 len16 += convLen;
@@ -197,7 +377,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             // Thus, the worst ratio of UTF-16 code units to UTF-8 code units is 1 to 3.
             RETURN_HR_IF(E_ABORT, !base::MakeCheckedNum(in.length()).AssignIfValid(&lengthIn) || !base::CheckMul(lengthIn, 3).AssignIfValid(&lengthRequired));
             out.resize(gsl::narrow_cast<size_t>(lengthRequired)); // avoid to call WideCharToMultiByte twice only to get the required size
-            const int lengthOut = WideCharToMultiByte(CP_UTF8, 0ul, in.data(), lengthIn, out.data(), lengthRequired, nullptr, nullptr);
+            const int lengthOut = details::u16u8_convert(in.data(), lengthIn, out.data(), lengthRequired);
             out.resize(gsl::narrow_cast<size_t>(lengthOut));
 
             return lengthOut == 0 ? E_UNEXPECTED : S_OK;
@@ -259,7 +439,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
 
             if (len16)
             {
-                const auto convLen{ WideCharToMultiByte(CP_UTF8, 0UL, cursor16, len16, out.data() + len8, capa8, nullptr, nullptr) };
+                const auto convLen{ details::u16u8_convert(cursor16, len16, out.data() + len8, capa8) };
                 RETURN_HR_IF(E_UNEXPECTED, !convLen);
 
                 len8 += convLen;
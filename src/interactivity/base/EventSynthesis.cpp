@@ -41,11 +41,17 @@ static CodepointWidth GetQuickCharWidthLegacyForNumpadEventSynthesis(const wchar
     return CodepointWidth::Narrow;
 }
 
-std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::CharToKeyEvents(const wchar_t wch,
-                                                                                         const unsigned int codepage)
+// Routine Description:
+// - looks up how a wchar_t would be typed with the current keyboard layout
+// Arguments:
+// - wch - the wchar_t to look up
+// - keyState - receives the VkKeyScanW() result for wch, or 0 if it isn't in the layout
+// Return Value:
+// - true if wch needs to be typed using alt + numpad instead
+static bool LookupKeyState(const wchar_t wch, short& keyState)
 {
     const short invalidKey = -1;
-    auto keyState = OneCoreSafeVkKeyScanW(wch);
+    keyState = OneCoreSafeVkKeyScanW(wch);
 
     if (keyState == invalidKey)
     {
@@ -62,15 +68,138 @@ std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::CharToK
                 // It wasn't alphanumeric or determined to be wide by the old algorithm
                 // if VkKeyScanW fails (char is not in kbd layout), we must
                 // emulate the key being input through the numpad
-                return SynthesizeNumpadEvents(wch, codepage);
+                return true;
             }
         }
         keyState = 0; // SynthesizeKeyboardEvents would rather get 0 than -1
     }
 
+    return false;
+}
+
+std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::CharToKeyEvents(const wchar_t wch,
+                                                                                         const unsigned int codepage)
+{
+    short keyState = 0;
+    if (LookupKeyState(wch, keyState))
+    {
+        return SynthesizeNumpadEvents(wch, codepage);
+    }
+
     return SynthesizeKeyboardEvents(wch, keyState);
 }
 
+static void AppendKeyRecord(std::vector<INPUT_RECORD>& records,
+                            const bool keyDown,
+                            const WORD virtualKeyCode,
+                            const WORD virtualScanCode,
+                            const wchar_t wch,
+                            const DWORD controlKeyState)
+{
+    auto& record = records.emplace_back();
+    record.EventType = KEY_EVENT;
+    record.Event.KeyEvent.bKeyDown = keyDown;
+    record.Event.KeyEvent.wRepeatCount = 1;
+    record.Event.KeyEvent.wVirtualKeyCode = virtualKeyCode;
+    record.Event.KeyEvent.wVirtualScanCode = virtualScanCode;
+    record.Event.KeyEvent.uChar.UnicodeChar = wch;
+    record.Event.KeyEvent.dwControlKeyState = controlKeyState;
+}
+
+// Routine Description:
+// - converts a string into a series of key event records as if it was typed.
+//   The result is identical to calling CharToKeyEvents() for each character,
+//   but no IInputEvent is allocated per character.
+// - Looking a character up in the keyboard layout is comparatively expensive,
+//   while pasted text usually consists of a small set of distinct characters.
+//   The lookups are thus memoized in a small table for the duration of the call.
+//   It isn't kept across calls, since the keyboard layout may change in between.
+// Arguments:
+// - string - the string to convert
+// - codepage - the codepage used for characters that are typed using alt + numpad
+// - records - the records are appended to this vector
+// Note:
+// - will throw exception on error
+void Microsoft::Console::Interactivity::StringToInputRecords(const std::wstring_view string,
+                                                             const unsigned int codepage,
+                                                             std::vector<INPUT_RECORD>& records)
+{
+    struct Mapping
+    {
+        wchar_t wch = 0;
+        bool valid = false;
+        bool numpad = false;
+        WORD virtualKeyCode = 0;
+        WORD virtualScanCode = 0;
+        BYTE modifierState = 0;
+    };
+    std::array<Mapping, 256> mappings;
+
+    // Most characters are typed as a key down and a key up.
+    records.reserve(records.size() + string.size() * 2);
+
+    for (const auto wch : string)
+    {
+        auto& mapping = til::at(mappings, wch & 0xff);
+        if (!mapping.valid || mapping.wch != wch)
+        {
+            short keyState = 0;
+            mapping = {};
+            mapping.wch = wch;
+            mapping.valid = true;
+            mapping.numpad = LookupKeyState(wch, keyState);
+            if (!mapping.numpad)
+            {
+                mapping.virtualKeyCode = LOBYTE(keyState);
+                mapping.virtualScanCode = gsl::narrow<WORD>(OneCoreSafeMapVirtualKeyW(mapping.virtualKeyCode, MAPVK_VK_TO_VSC));
+                mapping.modifierState = HIBYTE(keyState);
+            }
+        }
+
+        if (mapping.numpad)
+        {
+            // Characters outside of the keyboard layout are rare enough
+            // that we don't need a separate fast path for them.
+            for (const auto& event : SynthesizeNumpadEvents(wch, codepage))
+            {
+                records.push_back(event->ToInputRecord());
+            }
+            continue;
+        }
+
+        // This mirrors what SynthesizeKeyboardEvents() does.
+        const auto modifierState = mapping.modifierState;
+        const auto altGrSet = WI_AreAllFlagsSet(modifierState, VkKeyScanModState::CtrlAndAltPressed);
+        const auto shiftSet = !altGrSet && WI_IsFlagSet(modifierState, VkKeyScanModState::ShiftPressed);
+
+        DWORD controlKeyState = 0;
+        WI_SetFlagIf(controlKeyState, SHIFT_PRESSED, WI_IsFlagSet(modifierState, VkKeyScanModState::ShiftPressed));
+        WI_SetFlagIf(controlKeyState, LEFT_CTRL_PRESSED, WI_IsFlagSet(modifierState, VkKeyScanModState::CtrlPressed));
+        WI_SetFlagIf(controlKeyState, RIGHT_ALT_PRESSED, altGrSet);
+
+        if (altGrSet)
+        {
+            AppendKeyRecord(records, true, VK_MENU, altScanCode, UNICODE_NULL, ENHANCED_KEY | LEFT_CTRL_PRESSED | RIGHT_ALT_PRESSED);
+        }
+        else if (shiftSet)
+        {
+            AppendKeyRecord(records, true, VK_SHIFT, leftShiftScanCode, UNICODE_NULL, SHIFT_PRESSED);
+        }
+
+        AppendKeyRecord(records, true, mapping.virtualKeyCode, mapping.virtualScanCode, wch, controlKeyState);
+        AppendKeyRecord(records, false, mapping.virtualKeyCode, mapping.virtualScanCode, wch, controlKeyState);
+
+        if (altGrSet)
+        {
+            AppendKeyRecord(records, false, VK_MENU, altScanCode, UNICODE_NULL, ENHANCED_KEY);
+        }
+        else if (shiftSet)
+        {
+            AppendKeyRecord(records, false, VK_SHIFT, leftShiftScanCode, UNICODE_NULL, 0);
+        }
+    }
+}
+
 // Routine Description:
 // - converts a wchar_t into a series of KeyEvents as if it was typed
 // using the keyboard
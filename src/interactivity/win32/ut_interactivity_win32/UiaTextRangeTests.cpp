@@ -1813,6 +1813,127 @@ class UiaTextRangeTests
         }
     }
 
+    TEST_METHOD(FindAttributeBlockRange)
+    {
+        // Set up the buffer's attributes. The italic cells at x=5 and x=6 are outside of the block range.
+        TextAttribute italicAttr;
+        italicAttr.SetItalic(true);
+        _pTextBuffer->GetRowByOffset(2).ReplaceAttributes(3, 7, italicAttr);
+        _pTextBuffer->GetRowByOffset(3).ReplaceAttributes(3, 4, italicAttr);
+
+        // The block range covers the columns 2 to 4 of the rows 1 to 3.
+        Microsoft::WRL::ComPtr<UiaTextRange> utr;
+        THROW_IF_FAILED(Microsoft::WRL::MakeAndInitialize<UiaTextRange>(&utr, _pUiaData, &_dummyProvider, til::point{ 2, 1 }, til::point{ 5, 3 }, true));
+
+        VARIANT var{};
+        var.vt = VT_BOOL;
+        var.boolVal = true;
+
+        Log::Comment(L"Searching forwards stops at the right edge of the block");
+        {
+            Microsoft::WRL::ComPtr<ITextRangeProvider> result;
+            VERIFY_SUCCEEDED(utr->FindAttribute(UIA_IsItalicAttributeId, var, false, result.GetAddressOf()));
+            Microsoft::WRL::ComPtr<UiaTextRange> resultUtr{ static_cast<UiaTextRange*>(result.Get()) };
+            VERIFY_ARE_EQUAL(til::point(3, 2), resultUtr->_start);
+            VERIFY_ARE_EQUAL(til::point(2, 3), resultUtr->_end);
+        }
+
+        Log::Comment(L"Searching backwards finds the last italic cell in the block first");
+        {
+            Microsoft::WRL::ComPtr<ITextRangeProvider> result;
+            VERIFY_SUCCEEDED(utr->FindAttribute(UIA_IsItalicAttributeId, var, true, result.GetAddressOf()));
+            Microsoft::WRL::ComPtr<UiaTextRange> resultUtr{ static_cast<UiaTextRange*>(result.Get()) };
+            VERIFY_ARE_EQUAL(til::point(3, 3), resultUtr->_start);
+            VERIFY_ARE_EQUAL(til::point(4, 3), resultUtr->_end);
+        }
+
+        Log::Comment(L"The attribute value is mixed within the block");
+        {
+            VARIANT result;
+            VERIFY_SUCCEEDED(utr->GetAttributeValue(UIA_IsItalicAttributeId, &result));
+            Microsoft::WRL::ComPtr<IUnknown> mixedVal;
+            THROW_IF_FAILED(UiaGetReservedMixedAttributeValue(&mixedVal));
+            VERIFY_ARE_EQUAL(VT_UNKNOWN, result.vt);
+            VERIFY_ARE_EQUAL(mixedVal.Get(), result.punkVal);
+        }
+    }
+
+    // Compares FindAttribute() against iterating over each cell of a
+    // 9001 row buffer, the way FindAttribute() used to be implemented.
+    TEST_METHOD(FindAttributePerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        _state->CleanupNewTextBufferInfo();
+        _state->PrepareNewTextBufferInfo(false, 120, 9001);
+        _pTextBuffer = &_pScreenInfo->GetTextBuffer();
+
+        // Fill the buffer with text and a new color every 8 columns.
+        // Only a couple of cells in the very last row are italic.
+        const auto bufferSize = _pTextBuffer->GetSize();
+        const std::wstring text(bufferSize.Width(), L'X');
+        for (til::CoordType y = 0; y < bufferSize.Height(); ++y)
+        {
+            auto& row = _pTextBuffer->GetRowByOffset(y);
+            RowWriteState state{ .text = text };
+            row.ReplaceText(state);
+            for (til::CoordType x = 0; x < bufferSize.Width(); x += 8)
+            {
+                row.ReplaceAttributes(x, x + 8, TextAttribute{ gsl::narrow_cast<WORD>((x + y) % 16) });
+            }
+        }
+
+        const til::point expectedStart{ 100, bufferSize.BottomInclusive() };
+        const til::point expectedEnd{ 110, bufferSize.BottomInclusive() };
+        TextAttribute italicAttr;
+        italicAttr.SetItalic(true);
+        _pTextBuffer->GetRowByOffset(expectedStart.y).ReplaceAttributes(expectedStart.x, expectedEnd.x, italicAttr);
+
+        Microsoft::WRL::ComPtr<UiaTextRange> utr;
+        THROW_IF_FAILED(Microsoft::WRL::MakeAndInitialize<UiaTextRange>(&utr, _pUiaData, &_dummyProvider));
+        THROW_IF_FAILED(utr->ExpandToEnclosingUnit(TextUnit_Document));
+
+        VARIANT var{};
+        var.vt = VT_BOOL;
+        var.boolVal = true;
+
+        Log::Comment(L"Working. Please wait...");
+
+        auto start = std::chrono::steady_clock::now();
+        std::optional<til::point> cellResult;
+        for (auto it = _pTextBuffer->GetCellDataAt({}); it; ++it)
+        {
+            if (utr->_verifyAttr(UIA_IsItalicAttributeId, var, it->TextAttr()).value())
+            {
+                cellResult = it.Pos();
+                break;
+            }
+        }
+        const auto cellDelta = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        Microsoft::WRL::ComPtr<ITextRangeProvider> result;
+        VERIFY_SUCCEEDED(utr->FindAttribute(UIA_IsItalicAttributeId, var, false, result.GetAddressOf()));
+        const auto findDelta = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        VARIANT value;
+        VERIFY_SUCCEEDED(utr->GetAttributeValue(UIA_IsItalicAttributeId, &value));
+        const auto valueDelta = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        Log::Comment(NoThrowString().Format(L"Iterating over each cell took %lld us", cellDelta));
+        Log::Comment(NoThrowString().Format(L"FindAttribute took %lld us", findDelta));
+        Log::Comment(NoThrowString().Format(L"GetAttributeValue took %lld us", valueDelta));
+
+        VERIFY_IS_TRUE(cellResult == expectedStart);
+        Microsoft::WRL::ComPtr<UiaTextRange> resultUtr{ static_cast<UiaTextRange*>(result.Get()) };
+        VERIFY_ARE_EQUAL(expectedStart, resultUtr->_start);
+        VERIFY_ARE_EQUAL(expectedEnd, resultUtr->_end);
+        VERIFY_ARE_EQUAL(VT_UNKNOWN, value.vt);
+    }
+
     TEST_METHOD(BlockRange)
     {
         // This test replicates GH#7960.
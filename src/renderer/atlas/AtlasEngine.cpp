@@ -258,6 +258,19 @@ try
 }
 CATCH_RETURN()
 
+// The paint calls only ever touch _api and _p and never use the IRenderData they're given.
+// The Renderer can thus hand us a snapshot of the buffer and paint outside of the console lock.
+[[nodiscard]] bool AtlasEngine::SupportsSnapshotPainting() const noexcept
+{
+    return true;
+}
+
+// NotifyNewText() is a no-op.
+[[nodiscard]] bool AtlasEngine::SupportsNewTextNotifications() const noexcept
+{
+    return false;
+}
+
 [[nodiscard]] HRESULT AtlasEngine::PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept
 {
     RETURN_HR_IF_NULL(E_INVALIDARG, pForcePaint);
@@ -293,6 +306,13 @@ CATCH_RETURN()
     return S_OK;
 }
 
+// We don't paint whole rows (yet). Returning S_FALSE makes the
+// Renderer fall back to UpdateDrawingBrushes and PaintBufferLine.
+[[nodiscard]] HRESULT AtlasEngine::PaintBufferRow(const BufferRowInfo& /*row*/) noexcept
+{
+    return S_FALSE;
+}
+
 [[nodiscard]] HRESULT AtlasEngine::PaintBufferLine(std::span<const Cluster> clusters, til::point coord, const bool fTrimLeft, const bool lineWrapped) noexcept
 try
 {
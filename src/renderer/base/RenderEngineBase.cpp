@@ -69,6 +69,41 @@ HRESULT RenderEngineBase::PrepareLineTransform(const LineRendition /*lineRenditi
     return false;
 }
 
+// Method Description:
+// - By default, engines are painted while the console lock is held.
+//   Engines that return true here are instead painted from a snapshot of the
+//   dirty rows after the lock has been released. Such engines must not call
+//   back into the IRenderData they're handed while painting.
+[[nodiscard]] bool RenderEngineBase::SupportsSnapshotPainting() const noexcept
+{
+    return false;
+}
+
+// Method Description:
+// - NotifyNewText is called for every write to the buffer. Engines that
+//   actually do something with the text return true here, so that the
+//   renderer can skip the call (and copying the text) for all others.
+[[nodiscard]] bool RenderEngineBase::SupportsNewTextNotifications() const noexcept
+{
+    return false;
+}
+
+// Method Description:
+// - Engines may paint an entire row of the text buffer in one call, instead of
+//   having the renderer split it into runs of clusters of the same attributes.
+//   An engine that does so is responsible for updating its own drawing brushes
+//   and for drawing the grid lines of the row.
+// - The default implementation returns S_FALSE, which makes the renderer fall
+//   back to calling UpdateDrawingBrushes and PaintBufferLine for each run.
+// Arguments:
+// - row - The text, columns and attributes of the row to paint.
+// Return Value:
+// - S_FALSE because we don't use this.
+[[nodiscard]] HRESULT RenderEngineBase::PaintBufferRow(const BufferRowInfo& /*row*/) noexcept
+{
+    return S_FALSE;
+}
+
 // Method Description:
 // - Blocks until the engine is able to render without blocking.
 void RenderEngineBase::WaitUntilCanRender() noexcept
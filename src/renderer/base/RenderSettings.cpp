@@ -65,6 +65,7 @@ const std::array<COLORREF, TextColor::TABLE_SIZE>& RenderSettings::GetColorTable
 void RenderSettings::ResetColorTable() noexcept
 {
     InitializeColorTable({ _colorTable.data(), 16 });
+    _perceivableColorCache.Clear();
 }
 
 // Routine Description:
@@ -74,7 +75,14 @@ void RenderSettings::ResetColorTable() noexcept
 // - color - The new COLORREF to use as that color table value.
 void RenderSettings::SetColorTableEntry(const size_t tableIndex, const COLORREF color)
 {
-    _colorTable.at(tableIndex) = color;
+    auto& entry = _colorTable.at(tableIndex);
+    if (entry != color)
+    {
+        entry = color;
+        // The cached results are still correct, but the color pairs
+        // they were made for are unlikely to be used ever again.
+        _perceivableColorCache.Clear();
+    }
 }
 
 // Routine Description:
@@ -182,13 +190,68 @@ std::pair<COLORREF, COLORREF> RenderSettings::GetAttributeColors(const TextAttri
             fg != bg &&
             (_renderMode.test(Mode::AlwaysDistinguishableColors) || (fgTextColor.IsDefaultOrLegacy() && bgTextColor.IsDefaultOrLegacy())))
         {
-            fg = ColorFix::GetPerceivableColor(fg, bg, 0.5f * 0.5f);
+            fg = _perceivableColorCache.GetPerceivableColor(fg, bg);
         }
     }
 
     return { fg, bg };
 }
 
+// Routine Description:
+// - Returns ColorFix::GetPerceivableColor(color, reference), using a cached
+//   result for the pair of colors if there is one.
+// Arguments:
+// - color - The foreground color to adjust.
+// - reference - The background color it needs to be perceivable on.
+// Return Value:
+// - The adjusted foreground color.
+COLORREF RenderSettings::PerceivableColorCache::GetPerceivableColor(const COLORREF color, const COLORREF reference) noexcept
+{
+    static constexpr auto minSquaredDistance = 0.5f * 0.5f;
+    static constexpr uint64_t rgbMask = 0xffffff;
+    static constexpr uint64_t occupied = uint64_t{ 1 } << 24;
+
+    // Only plain RGB values fit into a slot.
+    if ((color | reference) > rgbMask)
+    {
+        return ColorFix::GetPerceivableColor(color, reference, minSquaredDistance);
+    }
+
+    // The slot index is made up of the low bits of the 48-bit key, mixed with a
+    // hash of the remaining ones. As those low bits can be recovered from the
+    // index, a slot only stores the other 39, followed by an occupied bit and
+    // the 24-bit result. That's exactly 64 bits, so we can use plain atomics.
+    const auto key = uint64_t{ color } << 24 | reference;
+    const auto high = key >> IndexBits;
+    const auto hash = (high * UINT64_C(0x9E3779B97F4A7C15)) >> (64 - IndexBits);
+    const auto index = gsl::narrow_cast<size_t>((key ^ hash) & (_entries.size() - 1));
+    const auto tag = high << 25 | occupied;
+
+    auto& slot = til::at(_entries, index);
+    const auto cached = slot.load(std::memory_order_relaxed);
+    if ((cached & ~rgbMask) == tag)
+    {
+        return gsl::narrow_cast<COLORREF>(cached & rgbMask);
+    }
+
+    const auto result = ColorFix::GetPerceivableColor(color, reference, minSquaredDistance);
+    if (result <= rgbMask)
+    {
+        slot.store(tag | result, std::memory_order_relaxed);
+    }
+    return result;
+}
+
+// Routine Description:
+// - Empties the cache.
+void RenderSettings::PerceivableColorCache::Clear() noexcept
+{
+    for (auto& slot : _entries)
+    {
+        slot.store(0, std::memory_order_relaxed);
+    }
+}
+
 // Routine Description:
 // - Calculates the RGBA colors of a given text attribute, using the current
 //   color table configuration and active render settings. This differs from
@@ -115,6 +115,10 @@ try
         _pData->UnlockConsole();
     });
 
+    // This also hands any calls that were queued up while we
+    // painted the previous frame from a snapshot to their engine.
+    auto engineLock = LockEngines();
+
     // Last chance check if anything scrolled without an explicit invalidate notification since the last frame.
     _CheckViewportAndScroll();
 
@@ -154,11 +158,33 @@ try
     // 1. Paint Background
     RETURN_IF_FAILED(_PaintBackground(pEngine));
 
+    // Engines that support it get painted from a copy of the dirty rows, so that we can
+    // let go of the console lock before doing the bulk of the work below. Overlays (the
+    // conhost IME composition) are rare enough that we simply take the slow path for them.
+    const auto paintFromSnapshot = pEngine->SupportsSnapshotPainting() && _pData->GetOverlays().empty();
+    auto resetSnapshot = wil::scope_exit([&]() {
+        _paintingFromSnapshot = false;
+    });
+
+    if (paintFromSnapshot)
+    {
+        _CaptureSnapshot(pEngine);
+        RETURN_IF_FAILED(_PaintTitle(pEngine));
+
+        // From here on any call into this engine gets queued up by _ForEachEngine().
+        _snapshotEngine = pEngine;
+        _paintingFromSnapshot = true;
+        unlock.reset();
+    }
+
     // 2. Paint Rows of Text
     _PaintBufferOutput(pEngine);
 
     // 3. Paint overlays that reside above the text buffer
-    _PaintOverlays(pEngine);
+    if (!paintFromSnapshot)
+    {
+        _PaintOverlays(pEngine);
+    }
 
     // 4. Paint Selection
     _PaintSelection(pEngine);
@@ -167,10 +193,15 @@ try
     _PaintCursor(pEngine);
 
     // 6. Paint window title
-    RETURN_IF_FAILED(_PaintTitle(pEngine));
+    if (!paintFromSnapshot)
+    {
+        RETURN_IF_FAILED(_PaintTitle(pEngine));
+    }
 
     // Force scope exit end paint to finish up collecting information and possibly painting
     endPaint.reset();
+    resetSnapshot.reset();
+    engineLock.unlock();
 
     // Force scope exit unlock to let go of global lock so other threads can run
     unlock.reset();
@@ -183,6 +214,136 @@ try
 }
 CATCH_RETURN()
 
+// Routine Description:
+// - Copies everything that _PaintFrameForEngine needs to paint the given engine into
+//   _snapshot: the rows of the viewport that the engine considers dirty, as well as the
+//   cursor, selection and pattern state. Must be called while holding the console lock.
+// Arguments:
+// - pEngine - The engine that is about to be painted.
+// Return Value:
+// - <none>
+void Renderer::_CaptureSnapshot(_In_ IRenderEngine* const pEngine)
+{
+    const auto& buffer = _pData->GetTextBuffer();
+    const auto view = _pData->GetViewport();
+    const til::size size{ buffer.GetSize().Width(), view.Height() };
+
+    // The snapshot buffer is reused across frames. Rows that aren't dirty may
+    // hold stale contents, but the engine won't ask us to paint them anyway.
+    if (!_snapshot.buffer || _snapshot.buffer->GetSize().Dimensions() != size)
+    {
+        _snapshot.buffer = std::make_unique<TextBuffer>(size, TextAttribute{}, 0, false, *this);
+    }
+
+    std::span<const til::rect> dirtyAreas;
+    LOG_IF_FAILED(pEngine->GetDirtyArea(dirtyAreas));
+
+    for (const auto& dirtyRect : dirtyAreas)
+    {
+        const auto top = std::max(dirtyRect.top, 0);
+        const auto bottom = std::min(dirtyRect.bottom, size.height);
+
+        for (auto y = top; y < bottom; ++y)
+        {
+            _snapshot.buffer->GetRowByOffset(y).CopyFrom(buffer.GetRowByOffset(view.Top() + y));
+        }
+    }
+
+    _snapshot.patternBoundaries.clear();
+    _snapshot.patternBoundaryOffsets.clear();
+    _snapshot.patternBoundaryOffsets.emplace_back(0);
+
+    for (til::CoordType y = 0; y < size.height; ++y)
+    {
+        const auto boundaries = _pData->GetPatternBoundaries(y);
+        _snapshot.patternBoundaries.insert(_snapshot.patternBoundaries.end(), boundaries.begin(), boundaries.end());
+        _snapshot.patternBoundaryOffsets.emplace_back(_snapshot.patternBoundaries.size());
+    }
+
+    _snapshot.viewport = view;
+    _snapshot.renderSettings = _renderSettings;
+    _snapshot.selectionRects = _GetSelectionRects();
+    _snapshot.cursorInfo = _GetCursorInfo();
+    _snapshot.hoveredInterval = _hoveredInterval;
+    _snapshot.hyperlinkHoveredId = _hyperlinkHoveredId;
+    _snapshot.hoveredIntervalHasPattern = _hoveredInterval && !_pData->GetPatternId(_hoveredInterval->start).empty();
+    _snapshot.gridLineDrawingAllowed = _pData->IsGridLineDrawingAllowed();
+}
+
+// Routine Description:
+// - Waits until the render thread is done painting from a snapshot (if it is doing so)
+//   and then hands any calls that were queued up in the meantime to their engine.
+// - Callers that talk to a render engine directly instead of going through the Renderer
+//   must hold the returned lock, since such engines may be painted outside of the
+//   console lock. Must be called while holding the console lock.
+// Arguments:
+// - <none>
+// Return Value:
+// - The lock that keeps the render thread from painting.
+[[nodiscard]] std::unique_lock<std::recursive_mutex> Renderer::LockEngines()
+{
+    std::unique_lock lock{ _engineMutex };
+    _FlushDeferredEngineCalls();
+    return lock;
+}
+
+void Renderer::_FlushDeferredEngineCalls()
+{
+    if (const auto pEngine = std::exchange(_snapshotEngine, nullptr))
+    {
+        for (const auto& call : _deferredEngineCalls)
+        {
+            call(pEngine);
+        }
+    }
+    _deferredEngineCalls.clear();
+}
+
+// Routine Description:
+// - Invokes the given callable with each engine. Calls into the engine that
+//   is being painted from a snapshot are queued up for the next frame instead.
+// Arguments:
+// - call - A callable taking an IRenderEngine*. It's copied if it gets queued up.
+// Return Value:
+// - <none>
+template<typename T>
+void Renderer::_ForEachEngine(T&& call)
+{
+    FOREACH_ENGINE(pEngine)
+    {
+        if (pEngine == _snapshotEngine)
+        {
+            _deferredEngineCalls.emplace_back(call);
+        }
+        else
+        {
+            call(pEngine);
+        }
+    }
+}
+
+const RenderSettings& Renderer::_GetRenderSettings() const noexcept
+{
+    return _paintingFromSnapshot ? _snapshot.renderSettings : _renderSettings;
+}
+
+std::span<const til::CoordType> Renderer::_GetPatternBoundaries(const til::CoordType row) const noexcept
+{
+    if (!_paintingFromSnapshot)
+    {
+        return _pData->GetPatternBoundaries(row);
+    }
+
+    const auto& offsets = _snapshot.patternBoundaryOffsets;
+    const auto y = gsl::narrow_cast<size_t>(row);
+    if (row < 0 || y + 1 >= offsets.size())
+    {
+        return {};
+    }
+
+    return std::span{ _snapshot.patternBoundaries }.subspan(til::at(offsets, y), til::at(offsets, y + 1) - til::at(offsets, y));
+}
+
 void Renderer::NotifyPaintFrame() noexcept
 {
     // If we're running in the unittests, we might not have a render thread.
@@ -201,10 +362,9 @@ void Renderer::NotifyPaintFrame() noexcept
 // - <none>
 void Renderer::TriggerSystemRedraw(const til::rect* const prcDirtyClient)
 {
-    FOREACH_ENGINE(pEngine)
-    {
-        LOG_IF_FAILED(pEngine->InvalidateSystem(prcDirtyClient));
-    }
+    _ForEachEngine([dirtyClient = *prcDirtyClient](IRenderEngine* pEngine) {
+        LOG_IF_FAILED(pEngine->InvalidateSystem(&dirtyClient));
+    });
 
     NotifyPaintFrame();
 }
@@ -235,10 +395,9 @@ void Renderer::TriggerRedraw(const Viewport& region)
     if (view.TrimToViewport(&srUpdateRegion))
     {
         view.ConvertToOrigin(&srUpdateRegion);
-        FOREACH_ENGINE(pEngine)
-        {
+        _ForEachEngine([srUpdateRegion](IRenderEngine* pEngine) {
             LOG_IF_FAILED(pEngine->Invalidate(&srUpdateRegion));
-        }
+        });
 
         NotifyPaintFrame();
     }
@@ -286,10 +445,9 @@ void Renderer::TriggerRedrawCursor(const til::point* const pcoord)
         if (view.TrimToViewport(&updateRect))
         {
             view.ConvertToOrigin(&updateRect);
-            FOREACH_ENGINE(pEngine)
-            {
+            _ForEachEngine([updateRect](IRenderEngine* pEngine) {
                 LOG_IF_FAILED(pEngine->InvalidateCursor(&updateRect));
-            }
+            });
 
             NotifyPaintFrame();
         }
@@ -306,10 +464,9 @@ void Renderer::TriggerRedrawCursor(const til::point* const pcoord)
 // - <none>
 void Renderer::TriggerRedrawAll(const bool backgroundChanged, const bool frameChanged)
 {
-    FOREACH_ENGINE(pEngine)
-    {
+    _ForEachEngine([](IRenderEngine* pEngine) {
         LOG_IF_FAILED(pEngine->InvalidateAll());
-    }
+    });
 
     NotifyPaintFrame();
 
@@ -372,11 +529,10 @@ void Renderer::TriggerSelection()
             sr &= viewport;
         }
 
-        FOREACH_ENGINE(pEngine)
-        {
-            LOG_IF_FAILED(pEngine->InvalidateSelection(_previousSelection));
+        _ForEachEngine([previousSelection = _previousSelection, rects](IRenderEngine* pEngine) {
+            LOG_IF_FAILED(pEngine->InvalidateSelection(previousSelection));
             LOG_IF_FAILED(pEngine->InvalidateSelection(rects));
-        }
+        });
 
         _previousSelection = std::move(rects);
 
@@ -408,11 +564,10 @@ bool Renderer::_CheckViewportAndScroll()
     coordDelta.x = srOldViewport.left - srNewViewport.left;
     coordDelta.y = srOldViewport.top - srNewViewport.top;
 
-    FOREACH_ENGINE(engine)
-    {
+    _ForEachEngine([srNewViewport, coordDelta](IRenderEngine* engine) {
         LOG_IF_FAILED(engine->UpdateViewport(srNewViewport));
         LOG_IF_FAILED(engine->InvalidateScroll(&coordDelta));
-    }
+    });
 
     _ScrollPreviousSelection(coordDelta);
     return true;
@@ -444,10 +599,9 @@ void Renderer::TriggerScroll()
 // - <none>
 void Renderer::TriggerScroll(const til::point* const pcoordDelta)
 {
-    FOREACH_ENGINE(pEngine)
-    {
-        LOG_IF_FAILED(pEngine->InvalidateScroll(pcoordDelta));
-    }
+    _ForEachEngine([coordDelta = *pcoordDelta](IRenderEngine* pEngine) {
+        LOG_IF_FAILED(pEngine->InvalidateScroll(&coordDelta));
+    });
 
     _ScrollPreviousSelection(*pcoordDelta);
 
@@ -463,6 +617,8 @@ void Renderer::TriggerScroll(const til::point* const pcoordDelta)
 // - <none>
 void Renderer::TriggerFlush(const bool circling)
 {
+    // The engines may want to be painted right away, so we can't queue this up.
+    const auto engineLock = LockEngines();
     const auto rects = _GetSelectionRects();
 
     FOREACH_ENGINE(pEngine)
@@ -489,11 +645,9 @@ void Renderer::TriggerFlush(const bool circling)
 // - <none>
 void Renderer::TriggerTitleChange()
 {
-    const auto newTitle = _pData->GetConsoleTitle();
-    FOREACH_ENGINE(pEngine)
-    {
+    _ForEachEngine([newTitle = std::wstring{ _pData->GetConsoleTitle() }](IRenderEngine* pEngine) {
         LOG_IF_FAILED(pEngine->InvalidateTitle(newTitle));
-    }
+    });
     NotifyPaintFrame();
 }
 
@@ -501,7 +655,23 @@ void Renderer::TriggerNewTextNotification(const std::wstring_view newText)
 {
     FOREACH_ENGINE(pEngine)
     {
-        LOG_IF_FAILED(pEngine->NotifyNewText(newText));
+        // This is called for every write, so we skip engines that ignore the text
+        // and only copy it if we actually need to queue the call up.
+        if (!pEngine->SupportsNewTextNotifications())
+        {
+            continue;
+        }
+
+        if (pEngine == _snapshotEngine)
+        {
+            _deferredEngineCalls.emplace_back([text = std::wstring{ newText }](IRenderEngine* engine) {
+                LOG_IF_FAILED(engine->NotifyNewText(text));
+            });
+        }
+        else
+        {
+            LOG_IF_FAILED(pEngine->NotifyNewText(newText));
+        }
     }
 }
 
@@ -527,6 +697,8 @@ HRESULT Renderer::_PaintTitle(IRenderEngine* const pEngine)
 // - <none>
 void Renderer::TriggerFontChange(const int iDpi, const FontInfoDesired& FontInfoDesired, _Out_ FontInfo& FontInfo)
 {
+    const auto engineLock = LockEngines();
+
     FOREACH_ENGINE(pEngine)
     {
         LOG_IF_FAILED(pEngine->UpdateDpi(iDpi));
@@ -546,6 +718,8 @@ void Renderer::TriggerFontChange(const int iDpi, const FontInfoDesired& FontInfo
 // - <none>
 void Renderer::UpdateSoftFont(const std::span<const uint16_t> bitPattern, const til::size cellSize, const size_t centeringHint)
 {
+    const auto engineLock = LockEngines();
+
     // We reserve PUA code points U+EF20 to U+EF7F for soft fonts, but the range
     // that we test for in _IsSoftFontChar will depend on the size of the active
     // bitPattern. If it's empty (i.e. no soft font is set), then nothing will
@@ -608,6 +782,7 @@ bool Renderer::s_IsSoftFontChar(const std::wstring_view& v, const size_t firstSo
 // - True if the codepoint is full-width (two wide), false if it is half-width (one wide).
 bool Renderer::IsGlyphWideByFont(const std::wstring_view glyph)
 {
+    const auto engineLock = LockEngines();
     auto fIsFullWidth = false;
 
     // There will only every really be two engines - the real head and the VT
@@ -684,7 +859,7 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
     // This is the subsection of the entire screen buffer that is currently being presented.
     // It can move left/right or top/bottom depending on how the viewport is scrolled
     // relative to the entire buffer.
-    const auto view = _pData->GetViewport();
+    const auto view = _paintingFromSnapshot ? _snapshot.viewport : _pData->GetViewport();
 
     // This is effectively the number of cells on the visible screen that need to be redrawn.
     // The origin is always 0, 0 because it represents the screen itself, not the underlying buffer.
@@ -715,7 +890,9 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
         const auto redraw = Viewport::Intersect(dirty, view);
 
         // Retrieve the text buffer so we can read information out of it.
-        const auto& buffer = _pData->GetTextBuffer();
+        // The snapshot only holds the rows of the viewport, starting at its top.
+        const auto& buffer = _paintingFromSnapshot ? *_snapshot.buffer : _pData->GetTextBuffer();
+        const til::point bufferOffset{ 0, _paintingFromSnapshot ? -view.Top() : 0 };
 
         // Now walk through each row of text that we need to redraw.
         for (auto row = redraw.Top(); row < redraw.BottomExclusive(); row++)
@@ -726,7 +903,7 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
 
             // Convert the screen coordinates of the line to an equivalent
             // range of buffer cells, taking line rendition into account.
-            const auto lineRendition = buffer.GetLineRendition(row);
+            const auto lineRendition = buffer.GetLineRendition(row + bufferOffset.y);
             const auto bufferLine = Viewport::FromInclusive(ScreenToBufferLine(screenLine, lineRendition));
 
             // Find where on the screen we should place this line information. This requires us to re-map
@@ -736,19 +913,46 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
             // of the backing buffer to fill in line 1 of the screen.
             const auto screenPosition = bufferLine.Origin() - til::point{ 0, view.Top() };
 
-            // Retrieve the cell information iterator limited to just this line we want to redraw.
-            auto it = buffer.GetCellDataAt(bufferLine.Origin(), bufferLine);
+            const auto sourceLine = Viewport::Offset(bufferLine, bufferOffset);
 
             // Calculate if two things are true:
             // 1. this row wrapped
             // 2. We're painting the last col of the row.
             // In that case, set lineWrapped=true for the _PaintBufferOutputHelper call.
-            const auto lineWrapped = (buffer.GetRowByOffset(bufferLine.Origin().y).WasWrapForced()) &&
+            const auto lineWrapped = (buffer.GetRowByOffset(sourceLine.Origin().y).WasWrapForced()) &&
                                      (bufferLine.RightExclusive() == buffer.GetSize().Width());
 
             // Prepare the appropriate line transform for the current row and viewport offset.
             LOG_IF_FAILED(pEngine->PrepareLineTransform(lineRendition, screenPosition.y, view.Left()));
 
+            // Engines that can paint the row as is get it handed over directly, which spares
+            // us from walking it cell by cell. We only do that if we don't have to split its
+            // runs any further than its attributes do, for soft font glyphs or patterns.
+            if (_lastSoftFontChar == 0 && _GetPatternBoundaries(screenPosition.y).empty())
+            {
+                const auto& sourceRow = buffer.GetRowByOffset(sourceLine.Origin().y);
+                BufferRowInfo rowInfo;
+                rowInfo.text = sourceRow.GetText();
+                rowInfo.charOffsets = sourceRow.CharOffsets();
+                rowInfo.attributes = &sourceRow.Attributes();
+                rowInfo.columnBegin = sourceLine.Left();
+                rowInfo.columnEnd = std::min(sourceLine.RightExclusive(), gsl::narrow_cast<til::CoordType>(sourceRow.size()));
+                rowInfo.target = screenPosition;
+                rowInfo.lineWrapped = lineWrapped;
+                rowInfo.renderSettings = &_GetRenderSettings();
+                rowInfo.renderData = _pData;
+
+                const auto hr = pEngine->PaintBufferRow(rowInfo);
+                THROW_IF_FAILED(hr);
+                if (hr == S_OK)
+                {
+                    continue;
+                }
+            }
+
+            // Retrieve the cell information iterator limited to just this line we want to redraw.
+            auto it = buffer.GetCellDataAt(sourceLine.Origin(), sourceLine);
+
             // Ask the helper to paint through this specific line.
             _PaintBufferOutputHelper(pEngine, it, screenPosition, lineWrapped);
         }
@@ -766,7 +970,7 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
                                         const til::point target,
                                         const bool lineWrapped)
 {
-    auto globalInvert{ _renderSettings.GetRenderMode(RenderSettings::Mode::ScreenReversed) };
+    auto globalInvert{ _GetRenderSettings().GetRenderMode(RenderSettings::Mode::ScreenReversed) };
 
     // If we have valid data, let's figure out how to draw it.
     if (it)
@@ -779,8 +983,10 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
 
         // Retrieve the first color.
         auto color = it->TextAttr();
-        // Retrieve the first pattern id
-        auto patternIds = _pData->GetPatternId(target);
+        // Retrieve the columns at which patterns begin or end in this row and
+        // keep a cursor pointing at the first one following the current run.
+        const auto patternBoundaries = _GetPatternBoundaries(target.y);
+        auto nextPatternBoundary = std::upper_bound(patternBoundaries.begin(), patternBoundaries.end(), target.x);
         // Determine whether we're using a soft font.
         auto usingSoftFont = s_IsSoftFontChar(it->Chars(), _firstSoftFontChar, _lastSoftFontChar);
 
@@ -796,9 +1002,6 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
             // when we go to draw gridlines for the length of the run.
             const auto currentRunColor = color;
 
-            // Hold onto the current pattern id as well
-            const auto currentPatternId = patternIds;
-
             // Update the drawing brushes with our color and font usage.
             THROW_IF_FAILED(_UpdateDrawingBrushes(pEngine, currentRunColor, usingSoftFont, false));
 
@@ -827,10 +1030,10 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
             // We also accumulate clusters according to regex patterns
             do
             {
-                til::point thisPoint{ screenPoint.x + cols, screenPoint.y };
-                const auto thisPointPatterns = _pData->GetPatternId(thisPoint);
+                const auto thisColumn = screenPoint.x + cols;
                 const auto thisUsingSoftFont = s_IsSoftFontChar(it->Chars(), _firstSoftFontChar, _lastSoftFontChar);
-                const auto changedPatternOrFont = patternIds != thisPointPatterns || usingSoftFont != thisUsingSoftFont;
+                const auto changedPattern = nextPatternBoundary != patternBoundaries.end() && thisColumn >= *nextPatternBoundary;
+                const auto changedPatternOrFont = changedPattern || usingSoftFont != thisUsingSoftFont;
                 if (color != it->TextAttr() || changedPatternOrFont)
                 {
                     auto newAttr{ it->TextAttr() };
@@ -839,7 +1042,7 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
                     if (!_IsAllSpaces(it->Chars()) || !newAttr.HasIdenticalVisualRepresentationForBlankSpace(color, globalInvert) || changedPatternOrFont)
                     {
                         color = newAttr;
-                        patternIds = thisPointPatterns;
+                        nextPatternBoundary = std::upper_bound(nextPatternBoundary, patternBoundaries.end(), thisColumn);
                         usingSoftFont = thisUsingSoftFont;
                         break; // vend this run
                     }
@@ -878,7 +1081,7 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
 
             // If we're allowed to do grid drawing, draw that now too (since it will be coupled with the color data)
             // We're only allowed to draw the grid lines under certain circumstances.
-            if (_pData->IsGridLineDrawingAllowed())
+            if (_paintingFromSnapshot ? _snapshot.gridLineDrawingAllowed : _pData->IsGridLineDrawingAllowed())
             {
                 // See GH: 803
                 // If we found a wide character while we looped above, it's possible we skipped over the right half
@@ -996,7 +1199,7 @@ void Renderer::_PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngin
     if (lines.any())
     {
         // Get the current foreground color to render the lines.
-        const auto rgb = _renderSettings.GetAttributeColors(textAttribute).first;
+        const auto rgb = _GetRenderSettings().GetAttributeColors(textAttribute).first;
         // Draw the lines
         LOG_IF_FAILED(pEngine->PaintBufferGridLines(lines, rgb, cchLine, coordTarget));
     }
@@ -1004,13 +1207,23 @@ void Renderer::_PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngin
 
 bool Renderer::_isHoveredHyperlink(const TextAttribute& textAttribute) const noexcept
 {
-    return _hyperlinkHoveredId && _hyperlinkHoveredId == textAttribute.GetHyperlinkId();
+    const auto hoveredId = _paintingFromSnapshot ? _snapshot.hyperlinkHoveredId : _hyperlinkHoveredId;
+    return hoveredId && hoveredId == textAttribute.GetHyperlinkId();
 }
 
+// The pattern intervals are half-open: TextBuffer::_FindPatternsInRows() stores
+// the position just past the match as the stop, which is also where the
+// following run begins, since it's one of the pattern boundaries.
 bool Renderer::_isInHoveredInterval(const til::point coordTarget) const noexcept
 {
+    if (_paintingFromSnapshot)
+    {
+        const auto& interval = _snapshot.hoveredInterval;
+        return interval && interval->start <= coordTarget && coordTarget < interval->stop && _snapshot.hoveredIntervalHasPattern;
+    }
+
     return _hoveredInterval &&
-           _hoveredInterval->start <= coordTarget && coordTarget <= _hoveredInterval->stop &&
+           _hoveredInterval->start <= coordTarget && coordTarget < _hoveredInterval->stop &&
            _pData->GetPatternId(coordTarget).size() > 0;
 }
 
@@ -1086,7 +1299,7 @@ bool Renderer::_isInHoveredInterval(const til::point coordTarget) const noexcept
 // - <none>
 void Renderer::_PaintCursor(_In_ IRenderEngine* const pEngine)
 {
-    const auto cursorInfo = _GetCursorInfo();
+    const auto cursorInfo = _paintingFromSnapshot ? _snapshot.cursorInfo : _GetCursorInfo();
     if (cursorInfo.has_value())
     {
         LOG_IF_FAILED(pEngine->PaintCursor(cursorInfo.value()));
@@ -1189,7 +1402,7 @@ void Renderer::_PaintSelection(_In_ IRenderEngine* const pEngine)
         LOG_IF_FAILED(pEngine->GetDirtyArea(dirtyAreas));
 
         // Get selection rectangles
-        const auto rectangles = _GetSelectionRects();
+        const auto rectangles = _paintingFromSnapshot ? _snapshot.selectionRects : _GetSelectionRects();
         for (const auto& rect : rectangles)
         {
             for (auto& dirtyRect : dirtyAreas)
@@ -1223,7 +1436,7 @@ void Renderer::_PaintSelection(_In_ IRenderEngine* const pEngine)
 {
     // The last color needs to be each engine's responsibility. If it's local to this function,
     //      then on the next engine we might not update the color.
-    return pEngine->UpdateDrawingBrushes(textAttributes, _renderSettings, _pData, usingSoftFont, isSettingDefaultBrushes);
+    return pEngine->UpdateDrawingBrushes(textAttributes, _GetRenderSettings(), _pData, usingSoftFont, isSettingDefaultBrushes);
 }
 
 // Routine Description:
@@ -1369,10 +1582,13 @@ void Renderer::ResetErrorStateAndResume()
 void Renderer::UpdateHyperlinkHoveredId(uint16_t id) noexcept
 {
     _hyperlinkHoveredId = id;
-    FOREACH_ENGINE(pEngine)
+    try
     {
-        pEngine->UpdateHyperlinkHoveredId(id);
+        _ForEachEngine([id](IRenderEngine* pEngine) {
+            pEngine->UpdateHyperlinkHoveredId(id);
+        });
     }
+    CATCH_LOG();
 }
 
 void Renderer::UpdateLastHoveredInterval(const std::optional<PointTree::interval>& newInterval)
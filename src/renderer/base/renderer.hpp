@@ -92,11 +92,37 @@ namespace Microsoft::Console::Render
         void UpdateHyperlinkHoveredId(uint16_t id) noexcept;
         void UpdateLastHoveredInterval(const std::optional<interval_tree::IntervalTree<til::point, size_t>::interval>& newInterval);
 
+        [[nodiscard]] std::unique_lock<std::recursive_mutex> LockEngines();
+
     private:
+        // Engines that support it are painted from this copy of the console state after
+        // the console lock has been released. Only the dirty rows of .buffer are kept
+        // up to date. Its rows are relative to the top of the viewport.
+        struct RenderSnapshot
+        {
+            std::unique_ptr<TextBuffer> buffer;
+            Microsoft::Console::Types::Viewport viewport;
+            RenderSettings renderSettings;
+            std::vector<til::CoordType> patternBoundaries;
+            std::vector<size_t> patternBoundaryOffsets;
+            std::vector<til::rect> selectionRects;
+            std::optional<CursorOptions> cursorInfo;
+            std::optional<interval_tree::IntervalTree<til::point, size_t>::interval> hoveredInterval;
+            uint16_t hyperlinkHoveredId = 0;
+            bool hoveredIntervalHasPattern = false;
+            bool gridLineDrawingAllowed = false;
+        };
+
         static GridLineSet s_GetGridlines(const TextAttribute& textAttribute) noexcept;
         static bool s_IsSoftFontChar(const std::wstring_view& v, const size_t firstSoftFontChar, const size_t lastSoftFontChar);
 
         [[nodiscard]] HRESULT _PaintFrameForEngine(_In_ IRenderEngine* const pEngine) noexcept;
+        void _CaptureSnapshot(_In_ IRenderEngine* const pEngine);
+        void _FlushDeferredEngineCalls();
+        template<typename T>
+        void _ForEachEngine(T&& call);
+        const RenderSettings& _GetRenderSettings() const noexcept;
+        std::span<const til::CoordType> _GetPatternBoundaries(const til::CoordType row) const noexcept;
         bool _CheckViewportAndScroll();
         [[nodiscard]] HRESULT _PaintBackground(_In_ IRenderEngine* const pEngine);
         void _PaintBufferOutput(_In_ IRenderEngine* const pEngine);
@@ -127,6 +153,15 @@ namespace Microsoft::Console::Render
         Microsoft::Console::Types::Viewport _viewport;
         std::vector<Cluster> _clusterBuffer;
         std::vector<til::rect> _previousSelection;
+        RenderSnapshot _snapshot;
+        bool _paintingFromSnapshot = false;
+        // Serializes the render thread's snapshot painting with callers that need to talk to
+        // the engines directly. Only ever acquired while holding the console lock.
+        std::recursive_mutex _engineMutex;
+        // The engine that was last painted from _snapshot. Calls into it are queued up in
+        // _deferredEngineCalls until the next frame (or the next LockEngines() call).
+        IRenderEngine* _snapshotEngine = nullptr;
+        std::vector<std::function<void(IRenderEngine*)>> _deferredEngineCalls;
         std::function<void()> _pfnBackgroundColorChanged;
         std::function<void()> _pfnFrameColorChanged;
         std::function<void()> _pfnRendererEnteredErrorState;
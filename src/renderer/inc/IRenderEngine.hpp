@@ -46,6 +46,27 @@ namespace Microsoft::Console::Render
     };
     using GridLineSet = til::enumset<GridLines>;
 
+    // A range of columns of a single row of the text buffer, handed to engines
+    // that paint whole rows at once via IRenderEngine::PaintBufferRow.
+    struct BufferRowInfo
+    {
+        // The text of the row and the offset of each column's glyph in it,
+        // followed by the length of the text. See ROW::CharOffsets().
+        std::wstring_view text;
+        std::span<const uint16_t> charOffsets;
+        // The attributes of the row, with one run per change of attributes.
+        const til::small_rle<TextAttribute, uint16_t, 1>* attributes = nullptr;
+        // The range of columns to paint, and where on the screen columnBegin goes.
+        til::CoordType columnBegin = 0;
+        til::CoordType columnEnd = 0;
+        til::point target;
+        // True if the row wrapped and columnEnd is its last column.
+        bool lineWrapped = false;
+        // The arguments the renderer would otherwise pass to UpdateDrawingBrushes.
+        const RenderSettings* renderSettings = nullptr;
+        IRenderData* renderData = nullptr;
+    };
+
     class __declspec(novtable) IRenderEngine
     {
     public:
@@ -55,6 +76,8 @@ namespace Microsoft::Console::Render
         [[nodiscard]] virtual HRESULT StartPaint() noexcept = 0;
         [[nodiscard]] virtual HRESULT EndPaint() noexcept = 0;
         [[nodiscard]] virtual bool RequiresContinuousRedraw() noexcept = 0;
+        [[nodiscard]] virtual bool SupportsSnapshotPainting() const noexcept = 0;
+        [[nodiscard]] virtual bool SupportsNewTextNotifications() const noexcept = 0;
         virtual void WaitUntilCanRender() noexcept = 0;
         [[nodiscard]] virtual HRESULT Present() noexcept = 0;
         [[nodiscard]] virtual HRESULT PrepareForTeardown(_Out_ bool* pForcePaint) noexcept = 0;
@@ -73,6 +96,7 @@ namespace Microsoft::Console::Render
         [[nodiscard]] virtual HRESULT PrepareLineTransform(LineRendition lineRendition, til::CoordType targetRow, til::CoordType viewportLeft) noexcept = 0;
         [[nodiscard]] virtual HRESULT PaintBackground() noexcept = 0;
         [[nodiscard]] virtual HRESULT PaintBufferLine(std::span<const Cluster> clusters, til::point coord, bool fTrimLeft, bool lineWrapped) noexcept = 0;
+        [[nodiscard]] virtual HRESULT PaintBufferRow(const BufferRowInfo& row) noexcept = 0;
         [[nodiscard]] virtual HRESULT PaintBufferGridLines(GridLineSet lines, COLORREF color, size_t cchLine, til::point coordTarget) noexcept = 0;
         [[nodiscard]] virtual HRESULT PaintSelection(const til::rect& rect) noexcept = 0;
         [[nodiscard]] virtual HRESULT PaintCursor(const CursorOptions& options) noexcept = 0;
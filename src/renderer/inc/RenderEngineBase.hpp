@@ -43,6 +43,12 @@ namespace Microsoft::Console::Render
 
         [[nodiscard]] bool RequiresContinuousRedraw() noexcept override;
 
+        [[nodiscard]] bool SupportsSnapshotPainting() const noexcept override;
+
+        [[nodiscard]] bool SupportsNewTextNotifications() const noexcept override;
+
+        [[nodiscard]] HRESULT PaintBufferRow(const BufferRowInfo& row) noexcept override;
+
         [[nodiscard]] HRESULT InvalidateFlush(_In_ const bool circled, _Out_ bool* const pForcePaint) noexcept override;
 
         void WaitUntilCanRender() noexcept override;
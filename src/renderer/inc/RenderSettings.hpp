@@ -44,11 +44,31 @@ namespace Microsoft::Console::Render
         void ToggleBlinkRendition(class Renderer& renderer) noexcept;
 
     private:
+        // A small direct-mapped cache for ColorFix::GetPerceivableColor(), which is
+        // too expensive to call for every attribute run in every frame. Each slot
+        // packs its key and result into a single atomic, so that it can be shared
+        // by concurrent readers without a lock. Since a result only depends on the
+        // two colors, copies don't need the entries, and assignment keeps its own.
+        class PerceivableColorCache
+        {
+        public:
+            PerceivableColorCache() noexcept = default;
+            PerceivableColorCache(const PerceivableColorCache&) noexcept {}
+            PerceivableColorCache& operator=(const PerceivableColorCache&) noexcept { return *this; }
+            COLORREF GetPerceivableColor(const COLORREF color, const COLORREF reference) noexcept;
+            void Clear() noexcept;
+
+        private:
+            static constexpr size_t IndexBits = 9;
+            std::array<std::atomic<uint64_t>, size_t{ 1 } << IndexBits> _entries{};
+        };
+
         til::enumset<Mode> _renderMode{ Mode::BlinkAllowed, Mode::IntenseIsBright };
         std::array<COLORREF, TextColor::TABLE_SIZE> _colorTable;
         std::array<size_t, static_cast<size_t>(ColorAlias::ENUM_COUNT)> _colorAliasIndices;
         size_t _blinkCycle = 0;
         mutable bool _blinkIsInUse = false;
         bool _blinkShouldBeFaint = false;
+        mutable PerceivableColorCache _perceivableColorCache;
     };
 }
@@ -50,6 +50,20 @@ UiaEngine::UiaEngine(IUiaEventDispatcher* dispatcher) :
     return S_OK;
 }
 
+// Routine Description:
+// - Sets the maximum number of characters that are queued up for
+//   NotifyNewOutput() in between two frames. Since each frame announces
+//   the output in chunks of SapiLimit characters, this also limits the
+//   number of notifications per frame. When a program produces more output
+//   than this, only the most recent output will be announced.
+// Arguments:
+// - limit - the maximum number of characters, or 0 for no limit.
+void UiaEngine::SetPendingOutputLimit(const size_t limit) noexcept
+{
+    _pendingOutputLimit = limit;
+    _trimPendingOutput();
+}
+
 // Routine Description:
 // - Notifies us that the console has changed the character region specified.
 // - NOTE: This typically triggers on cursor or text buffer changes
@@ -168,19 +182,89 @@ CATCH_RETURN();
     return S_OK;
 }
 
+// Routine Description:
+// - New output is announced to automation clients, see NotifyNewText().
+// Arguments:
+// - <none>
+// Return Value:
+// - true
+[[nodiscard]] bool UiaEngine::SupportsNewTextNotifications() const noexcept
+{
+    return true;
+}
+
 [[nodiscard]] HRESULT UiaEngine::NotifyNewText(const std::wstring_view newText) noexcept
 try
 {
     if (!newText.empty())
     {
+        _textBufferChanged = true;
+
+        // Programs like progress bars and spinners tend to print the same line over and over.
+        // Announcing it once per frame is plenty.
+        if (_isPendingOutputLastLine(newText))
+        {
+            return S_OK;
+        }
+
         _newOutput.append(newText);
         _newOutput.push_back(L'\n');
-        _textBufferChanged = true;
+
+        // Trimming the output moves the remaining text to the front of the string. By letting it
+        // grow to twice the limit first, the cost of that is amortized over many calls while
+        // memory usage stays bounded, no matter how much output is produced in between frames.
+        if (_pendingOutputLimit != 0 && _newOutput.size() > 2 * _pendingOutputLimit)
+        {
+            _trimPendingOutput();
+        }
     }
     return S_OK;
 }
 CATCH_LOG_RETURN_HR(E_FAIL);
 
+// Routine Description:
+// - Checks whether the given text is identical to the last line queued up in _newOutput.
+// Arguments:
+// - newText - the text that's about to be queued up.
+// Return Value:
+// - true if newText is identical to the last line in _newOutput.
+bool UiaEngine::_isPendingOutputLastLine(const std::wstring_view newText) const noexcept
+{
+    // Every line in _newOutput is terminated with a \n.
+    const std::wstring_view output{ _newOutput };
+    if (output.size() <= newText.size())
+    {
+        return false;
+    }
+
+    const auto lineBegin = output.size() - newText.size() - 1;
+    return (lineBegin == 0 || til::at(output, lineBegin - 1) == L'\n') && output.substr(lineBegin, newText.size()) == newText;
+}
+
+// Routine Description:
+// - Drops the oldest text in _newOutput until it's at most _pendingOutputLimit characters long.
+//   If possible, it drops entire lines, so that the announcement doesn't begin in the middle of one.
+void UiaEngine::_trimPendingOutput() noexcept
+{
+    if (_pendingOutputLimit == 0 || _newOutput.size() <= _pendingOutputLimit)
+    {
+        return;
+    }
+
+    auto drop = _newOutput.size() - _pendingOutputLimit;
+    if (til::at(_newOutput, drop - 1) != L'\n')
+    {
+        // The last character is always a \n. If that's the only one left, we have to cut the line.
+        const auto lineEnd = _newOutput.find(L'\n', drop);
+        if (lineEnd < _newOutput.size() - 1)
+        {
+            drop = lineEnd + 1;
+        }
+    }
+
+    _newOutput.erase(0, drop);
+}
+
 // Routine Description:
 // - This is unused by this renderer.
 // Arguments:
@@ -230,6 +314,7 @@ CATCH_LOG_RETURN_HR(E_FAIL);
     // so present can work on the copy while another
     // thread might start filling the next "frame"
     // worth of text data.
+    _trimPendingOutput();
     std::swap(_queuedOutput, _newOutput);
     _newOutput.clear();
     return S_OK;
@@ -281,14 +366,12 @@ void UiaEngine::WaitUntilCanRender() noexcept
     }
     try
     {
-        // The speech API is limited to 1000 characters at a time.
-        // Break up the output into 1000 character chunks to ensure
-        // the output isn't cut off.
-        static constexpr size_t sapiLimit{ 1000 };
+        // Break up the output into SapiLimit character
+        // chunks to ensure the output isn't cut off.
         const std::wstring_view output{ _queuedOutput };
-        for (size_t offset = 0; offset < output.size(); offset += sapiLimit)
+        for (size_t offset = 0; offset < output.size(); offset += SapiLimit)
         {
-            _dispatcher->NotifyNewOutput(output.substr(offset, sapiLimit));
+            _dispatcher->NotifyNewOutput(output.substr(offset, SapiLimit));
         }
     }
     CATCH_LOG();
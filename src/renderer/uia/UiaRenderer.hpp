@@ -20,6 +20,11 @@ Author(s):
 #include "../../types/IUiaEventDispatcher.h"
 #include "../../types/inc/Viewport.hpp"
 
+namespace ControlUnitTests
+{
+    class UiaEngineTests;
+};
+
 namespace Microsoft::Console::Render
 {
     class UiaEngine final : public RenderEngineBase
@@ -33,12 +38,18 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT Enable() noexcept override;
         [[nodiscard]] HRESULT Disable() noexcept;
 
+        // The maximum number of characters announced via NotifyNewOutput() per frame.
+        // Older output is dropped first. 0 means unlimited. All hosts use the
+        // DefaultPendingOutputLimit; this mainly exists for the unit tests.
+        void SetPendingOutputLimit(const size_t limit) noexcept;
+
         // IRenderEngine Members
         [[nodiscard]] HRESULT StartPaint() noexcept override;
         [[nodiscard]] HRESULT EndPaint() noexcept override;
         void WaitUntilCanRender() noexcept override;
         [[nodiscard]] HRESULT Present() noexcept override;
         [[nodiscard]] HRESULT PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept override;
+        [[nodiscard]] bool SupportsNewTextNotifications() const noexcept override;
         [[nodiscard]] HRESULT ScrollFrame() noexcept override;
         [[nodiscard]] HRESULT Invalidate(const til::rect* const psrRegion) noexcept override;
         [[nodiscard]] HRESULT InvalidateCursor(const til::rect* const psrRegion) noexcept override;
@@ -65,6 +76,13 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _DoUpdateTitle(const std::wstring_view newTitle) noexcept override;
 
     private:
+        // The speech API is limited to 1000 characters at a time.
+        static constexpr size_t SapiLimit = 1000;
+        static constexpr size_t DefaultPendingOutputLimit = 8 * SapiLimit;
+
+        bool _isPendingOutputLastLine(const std::wstring_view newText) const noexcept;
+        void _trimPendingOutput() noexcept;
+
         bool _isEnabled;
         bool _isPainting;
         bool _selectionChanged;
@@ -72,10 +90,13 @@ namespace Microsoft::Console::Render
         bool _cursorChanged;
         std::wstring _newOutput;
         std::wstring _queuedOutput;
+        size_t _pendingOutputLimit = DefaultPendingOutputLimit;
 
         Microsoft::Console::Types::IUiaEventDispatcher* _dispatcher;
 
         std::vector<til::rect> _prevSelection;
         til::rect _prevCursorRegion;
+
+        friend class ControlUnitTests::UiaEngineTests;
     };
 }
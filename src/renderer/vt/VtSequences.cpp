@@ -189,6 +189,70 @@ using namespace Microsoft::Console::Render;
     return _Write("\x1b[H");
 }
 
+// Method Description:
+// - Writes an SGR sequence with the given parameters. While a batch is open
+//      (see _BeginGraphicsRendition), the parameters are instead appended to
+//      the pending sequence, so that a whole attribute change goes out as a
+//      single "CSI a;b;c m" instead of one sequence per attribute.
+// Arguments:
+// - parameters: the semicolon separated SGR parameters to write.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_WriteGraphicsRendition(const std::string_view parameters) noexcept
+try
+{
+    if (_batchingGraphicsRendition)
+    {
+        if (!_graphicsRendition.empty())
+        {
+            _graphicsRendition.push_back(';');
+        }
+        _graphicsRendition.append(parameters);
+        return S_OK;
+    }
+
+    // A lone reset is written in its shortest form.
+    if (parameters == "0")
+    {
+        return _Write("\x1b[m");
+    }
+    return _WriteFormatted(FMT_COMPILE("\x1b[{}m"), parameters);
+}
+CATCH_RETURN();
+
+// Method Description:
+// - Starts collecting the parameters of subsequent SGR sequences, rather than
+//      writing them out immediately.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtEngine::_BeginGraphicsRendition() noexcept
+{
+    _batchingGraphicsRendition = true;
+    _graphicsRendition.clear();
+}
+
+// Method Description:
+// - Writes all the SGR parameters collected since _BeginGraphicsRendition as
+//      a single sequence, if there were any.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_EndGraphicsRendition() noexcept
+{
+    _batchingGraphicsRendition = false;
+    if (_graphicsRendition.empty())
+    {
+        return S_OK;
+    }
+
+    const auto hr = _WriteGraphicsRendition(_graphicsRendition);
+    _graphicsRendition.clear();
+    return hr;
+}
+
 // Method Description:
 // - Formats and writes a sequence to change the current text attributes to the default.
 // Arguments:
@@ -197,7 +261,7 @@ using namespace Microsoft::Console::Render;
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_SetGraphicsDefault() noexcept
 {
-    return _Write("\x1b[m");
+    return _WriteGraphicsRendition("0");
 }
 
 // Method Description:
@@ -224,7 +288,7 @@ using namespace Microsoft::Console::Render;
     // By specifying the intensity and brightness separately, we'll make sure the
     //      terminal has an accurate representation of our buffer.
     const auto prefix = WI_IsFlagSet(index, FOREGROUND_INTENSITY) ? (fIsForeground ? 90 : 100) : (fIsForeground ? 30 : 40);
-    return _WriteFormatted(FMT_COMPILE("\x1b[{}m"), prefix + (index & 7));
+    return _WriteGraphicsRenditionFormatted(FMT_COMPILE("{}"), prefix + (index & 7));
 }
 
 // Method Description:
@@ -238,7 +302,7 @@ using namespace Microsoft::Console::Render;
 [[nodiscard]] HRESULT VtEngine::_SetGraphicsRendition256Color(const BYTE index,
                                                               const bool fIsForeground) noexcept
 {
-    return _WriteFormatted(FMT_COMPILE("\x1b[{}8;5;{}m"), fIsForeground ? '3' : '4', index);
+    return _WriteGraphicsRenditionFormatted(FMT_COMPILE("{}8;5;{}"), fIsForeground ? '3' : '4', index);
 }
 
 // Method Description:
@@ -255,7 +319,7 @@ using namespace Microsoft::Console::Render;
     const auto r = GetRValue(color);
     const auto g = GetGValue(color);
     const auto b = GetBValue(color);
-    return _WriteFormatted(FMT_COMPILE("\x1b[{}8;2;{};{};{}m"), fIsForeground ? '3' : '4', r, g, b);
+    return _WriteGraphicsRenditionFormatted(FMT_COMPILE("{}8;2;{};{};{}"), fIsForeground ? '3' : '4', r, g, b);
 }
 
 // Method Description:
@@ -267,7 +331,7 @@ using namespace Microsoft::Console::Render;
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_SetGraphicsRenditionDefaultColor(const bool fIsForeground) noexcept
 {
-    return _Write(fIsForeground ? ("\x1b[39m") : ("\x1b[49m"));
+    return _WriteGraphicsRendition(fIsForeground ? "39" : "49");
 }
 
 // Method Description:
@@ -318,7 +382,7 @@ using namespace Microsoft::Console::Render;
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_SetIntense(const bool isIntense) noexcept
 {
-    return _Write(isIntense ? "\x1b[1m" : "\x1b[22m");
+    return _WriteGraphicsRendition(isIntense ? "1" : "22");
 }
 
 // Method Description:
@@ -329,7 +393,7 @@ using namespace Microsoft::Console::Render;
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_SetFaint(const bool isFaint) noexcept
 {
-    return _Write(isFaint ? "\x1b[2m" : "\x1b[22m");
+    return _WriteGraphicsRendition(isFaint ? "2" : "22");
 }
 
 // Method Description:
@@ -340,7 +404,7 @@ using namespace Microsoft::Console::Render;
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_SetUnderlined(const bool isUnderlined) noexcept
 {
-    return _Write(isUnderlined ? "\x1b[4m" : "\x1b[24m");
+    return _WriteGraphicsRendition(isUnderlined ? "4" : "24");
 }
 
 // Method Description:
@@ -351,7 +415,7 @@ using namespace Microsoft::Console::Render;
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_SetDoublyUnderlined(const bool isUnderlined) noexcept
 {
-    return _Write(isUnderlined ? "\x1b[21m" : "\x1b[24m");
+    return _WriteGraphicsRendition(isUnderlined ? "21" : "24");
 }
 
 // Method Description:
@@ -362,7 +426,7 @@ using namespace Microsoft::Console::Render;
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_SetOverlined(const bool isOverlined) noexcept
 {
-    return _Write(isOverlined ? "\x1b[53m" : "\x1b[55m");
+    return _WriteGraphicsRendition(isOverlined ? "53" : "55");
 }
 
 // Method Description:
@@ -373,7 +437,7 @@ using namespace Microsoft::Console::Render;
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_SetItalic(const bool isItalic) noexcept
 {
-    return _Write(isItalic ? "\x1b[3m" : "\x1b[23m");
+    return _WriteGraphicsRendition(isItalic ? "3" : "23");
 }
 
 // Method Description:
@@ -384,7 +448,7 @@ using namespace Microsoft::Console::Render;
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_SetBlinking(const bool isBlinking) noexcept
 {
-    return _Write(isBlinking ? "\x1b[5m" : "\x1b[25m");
+    return _WriteGraphicsRendition(isBlinking ? "5" : "25");
 }
 
 // Method Description:
@@ -395,7 +459,7 @@ using namespace Microsoft::Console::Render;
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_SetInvisible(const bool isInvisible) noexcept
 {
-    return _Write(isInvisible ? "\x1b[8m" : "\x1b[28m");
+    return _WriteGraphicsRendition(isInvisible ? "8" : "28");
 }
 
 // Method Description:
@@ -406,7 +470,7 @@ using namespace Microsoft::Console::Render;
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_SetCrossedOut(const bool isCrossedOut) noexcept
 {
-    return _Write(isCrossedOut ? "\x1b[9m" : "\x1b[29m");
+    return _WriteGraphicsRendition(isCrossedOut ? "9" : "29");
 }
 
 // Method Description:
@@ -417,7 +481,7 @@ using namespace Microsoft::Console::Render;
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_SetReverseVideo(const bool isReversed) noexcept
 {
-    return _Write(isReversed ? "\x1b[7m" : "\x1b[27m");
+    return _WriteGraphicsRendition(isReversed ? "7" : "27");
 }
 
 // Method Description:
@@ -27,13 +27,26 @@ Xterm256Engine::Xterm256Engine(_In_ wil::unique_hfile hPipe,
 // Return Value:
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT Xterm256Engine::UpdateDrawingBrushes(const TextAttribute& textAttributes,
-                                                           const RenderSettings& /*renderSettings*/,
+                                                           const RenderSettings& renderSettings,
                                                            const gsl::not_null<IRenderData*> pData,
                                                            const bool usingSoftFont,
                                                            const bool isSettingDefaultBrushes) noexcept
 {
     RETURN_HR_IF(S_FALSE, _passthrough && isSettingDefaultBrushes);
 
+    if (_DeferDrawingBrushes(textAttributes, renderSettings, pData, usingSoftFont, isSettingDefaultBrushes))
+    {
+        return S_OK;
+    }
+
+    // Collect all the attribute changes below into a single SGR sequence.
+    // The hyperlink and character set changes aren't SGRs, and get written
+    // immediately, ahead of it. Their order relative to the SGR doesn't matter.
+    _BeginGraphicsRendition();
+    auto endGraphicsRendition = wil::scope_exit([&]() noexcept {
+        LOG_IF_FAILED(_EndGraphicsRendition());
+    });
+
     RETURN_IF_FAILED(VtEngine::_RgbUpdateDrawingBrushes(textAttributes));
 
     RETURN_IF_FAILED(_UpdateHyperlinkAttr(textAttributes, pData));
@@ -50,7 +63,10 @@ Xterm256Engine::Xterm256Engine(_In_ wil::unique_hfile hPipe,
     }
 
     // Only do extended attributes in xterm-256color, as to not break telnet.exe.
-    return _UpdateExtendedAttrs(textAttributes);
+    RETURN_IF_FAILED(_UpdateExtendedAttrs(textAttributes));
+
+    endGraphicsRendition.release();
+    return _EndGraphicsRendition();
 }
 
 // Routine Description:
@@ -3,6 +3,7 @@
 
 #include "precomp.h"
 #include "XtermEngine.hpp"
+#include "../../buffer/out/Row.hpp"
 #include "../../types/inc/convert.hpp"
 #pragma hdrstop
 using namespace Microsoft::Console;
@@ -37,6 +38,14 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
 //      the pipe.
 [[nodiscard]] HRESULT XtermEngine::StartPaint() noexcept
 {
+    // If the connected terminal isn't keeping up with our output, don't pile
+    // more onto it. The invalidated regions keep accumulating, and we'll paint
+    // them all at once after the writer thread has caught up.
+    if (_ShouldSkipFrame())
+    {
+        return S_FALSE;
+    }
+
     RETURN_IF_FAILED(VtEngine::StartPaint());
 
     _trace.TraceLastText(_lastText);
@@ -64,6 +73,7 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
         //      the screen on the first paint, just to make sure that the
         //      terminal's state is consistent with what we'll be rendering.
         RETURN_IF_FAILED(_ClearScreen());
+        _ResetShadowScreen();
         _clearedAllThisFrame = true;
         _firstPaint = false;
     }
@@ -109,7 +119,8 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
     if (_needToDisableCursor)
     {
         // If the cursor was previously visible, let's hide it for this frame,
-        // by prepending a cursor off.
+        // by prepending a cursor off. (If a large frame already had part of
+        // its output flushed, this only hides the cursor for the remainder.)
         if (_lastCursorIsVisible != Tribool::False)
         {
             _buffer.insert(0, "\x1b[?25l");
@@ -145,11 +156,16 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
 // Return Value:
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT XtermEngine::UpdateDrawingBrushes(const TextAttribute& textAttributes,
-                                                        const RenderSettings& /*renderSettings*/,
-                                                        const gsl::not_null<IRenderData*> /*pData*/,
-                                                        const bool /*usingSoftFont*/,
-                                                        const bool /*isSettingDefaultBrushes*/) noexcept
+                                                        const RenderSettings& renderSettings,
+                                                        const gsl::not_null<IRenderData*> pData,
+                                                        const bool usingSoftFont,
+                                                        const bool isSettingDefaultBrushes) noexcept
 {
+    if (_DeferDrawingBrushes(textAttributes, renderSettings, pData, usingSoftFont, isSettingDefaultBrushes))
+    {
+        return S_OK;
+    }
+
     // The base xterm mode only knows about 16 colors
     RETURN_IF_FAILED(VtEngine::_16ColorUpdateDrawingBrushes(textAttributes));
 
@@ -365,6 +381,10 @@ try
     const auto dy = _scrollDelta.y;
     const auto absDy = abs(dy);
 
+    // The lines we're about to insert are filled with the current background
+    // color, so make sure any deferred default brushes get emitted first.
+    RETURN_IF_FAILED(_FlushDeferredBrushes());
+
     // Save the old wrap state here. We're going to clear it so that
     // _MoveCursor will definitely move us to the right position. We'll
     // restore the state afterwards.
@@ -397,6 +417,7 @@ try
         RETURN_IF_FAILED(_MoveCursor({ 0, 0 }));
         RETURN_IF_FAILED(_InsertLine(absDy));
     }
+    _ScrollShadowScreen(dy);
 
     // Restore our wrap state.
     _wrappedRow = oldWrappedRow;
@@ -492,7 +513,8 @@ CATCH_RETURN();
 // Routine Description:
 // - Draws one line of the buffer to the screen. Writes the characters to the
 //      pipe, encoded in UTF-8 or ASCII only, depending on the VtIoMode.
-//      (See descriptions of both implementations for details.)
+//      (See descriptions of both implementations for details.) When frame
+//      diffing, only the cells that changed since the last frame are written.
 // Arguments:
 // - clusters - text and column counts for each piece of text.
 // - coord - character coordinate target to render within viewport
@@ -509,11 +531,124 @@ CATCH_RETURN();
                                                    const bool /*trimLeft*/,
                                                    const bool lineWrapped) noexcept
 {
-    return _fUseAsciiOnly ?
-               VtEngine::_PaintAsciiBufferLine(clusters, coord) :
-               VtEngine::_PaintUtf8BufferLine(clusters, coord, lineWrapped);
+    if (_fUseAsciiOnly)
+    {
+        RETURN_IF_FAILED(_FlushDeferredBrushes());
+        RETURN_IF_FAILED(VtEngine::_PaintAsciiBufferLine(clusters, coord));
+    }
+    else
+    {
+        RETURN_IF_FAILED(_frameDiffing ?
+                             VtEngine::_PaintChangedUtf8BufferLine(clusters, coord, lineWrapped) :
+                             VtEngine::_PaintUtf8BufferLine(clusters, coord, lineWrapped));
+    }
+
+    // Don't let a large frame hold back all of its output until it's done.
+    return _FlushIfOverdue();
 }
 
+// Routine Description:
+// - Draws a range of columns of a row of the buffer to the screen, straight
+//      from the row's text and attributes. This splits the row into runs
+//      exactly like the renderer does for PaintBufferLine, but each run is
+//      written as a slice of the row's text, without building Clusters first.
+// - The ASCII-only and frame diffing modes work on clusters, so we leave
+//      those to PaintBufferLine.
+// Arguments:
+// - row - The text, columns and attributes of the row to paint.
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe, or S_FALSE if the row
+//      should be painted with PaintBufferLine instead.
+[[nodiscard]] HRESULT XtermEngine::PaintBufferRow(const BufferRowInfo& row) noexcept
+try
+{
+    if (_fUseAsciiOnly || _frameDiffing)
+    {
+        return S_FALSE;
+    }
+
+    const auto isTrailer = [&](const til::CoordType column) {
+        return WI_IsFlagSet(til::at(row.charOffsets, column), ROW::CharOffsetsTrailer);
+    };
+    const auto textAt = [&](const til::CoordType begin, const til::CoordType end) {
+        const auto offsetBegin = til::at(row.charOffsets, begin) & ROW::CharOffsetsMask;
+        const auto offsetEnd = til::at(row.charOffsets, end) & ROW::CharOffsetsMask;
+        return row.text.substr(offsetBegin, offsetEnd - offsetBegin);
+    };
+
+    const auto rowWidth = gsl::narrow_cast<til::CoordType>(row.charOffsets.size() - 1);
+    auto column = row.columnBegin;
+    auto end = row.columnEnd;
+    auto target = row.target;
+
+    // Just like the renderer, paint wide glyphs in full, even if we were
+    // only asked to paint one of their halves.
+    if (column > 0 && column < end && isTrailer(column))
+    {
+        --column;
+        --target.x;
+    }
+    while (end < rowWidth && isTrailer(end))
+    {
+        ++end;
+    }
+
+    // Find the attribute run the first column belongs to. From there on we
+    // only ever move forward, so looking up an attribute is cheap.
+    const auto& runs = row.attributes->runs();
+    auto run = runs.begin();
+    til::CoordType runEnd = run->length;
+    const auto attributeAt = [&](const til::CoordType col) -> const TextAttribute& {
+        while (runEnd <= col)
+        {
+            ++run;
+            runEnd += run->length;
+        }
+        return run->value;
+    };
+
+    const auto globalInvert = row.renderSettings->GetRenderMode(RenderSettings::Mode::ScreenReversed);
+    auto color = attributeAt(column);
+
+    while (column < end)
+    {
+        RETURN_IF_FAILED(UpdateDrawingBrushes(color, *row.renderSettings, row.renderData, false, false));
+
+        const auto runBegin = column;
+        do
+        {
+            auto glyphEnd = column + 1;
+            while (glyphEnd < rowWidth && isTrailer(glyphEnd))
+            {
+                ++glyphEnd;
+            }
+
+            const auto& attr = attributeAt(column);
+            if (attr != color)
+            {
+                // Runs of spaces don't need to be split if they look the same either way.
+                const auto glyph = textAt(column, glyphEnd);
+                if (glyph.find_first_not_of(L' ') != std::wstring_view::npos || !attr.HasIdenticalVisualRepresentationForBlankSpace(color, globalInvert))
+                {
+                    color = attr;
+                    break;
+                }
+            }
+
+            column = glyphEnd;
+        } while (column < end);
+
+        RETURN_IF_FAILED(_PaintUtf8Text(textAt(runBegin, column), column - runBegin, target, row.lineWrapped));
+        target.x += column - runBegin;
+
+        // Don't let a large frame hold back all of its output until it's done.
+        RETURN_IF_FAILED(_FlushIfOverdue());
+    }
+
+    return S_OK;
+}
+CATCH_RETURN();
+
 // Method Description:
 // - Wrapper for _Write. Write either an ascii-only, or a
 //      proper utf-8 string, depending on our mode.
@@ -526,6 +661,8 @@ CATCH_RETURN();
     RETURN_IF_FAILED(_fUseAsciiOnly ?
                          VtEngine::_WriteTerminalAscii(wstr) :
                          VtEngine::_WriteTerminalUtf8(wstr));
+    // We have no idea what this sequence does to the terminal's screen.
+    _ResetShadowScreen();
     // GH#4106, GH#2011, GH#13710 - WriteTerminalW is only ever called by the
     // StateMachine, when we've encountered a string we don't understand. When
     // this happens, we will trigger a new frame in the renderer, and
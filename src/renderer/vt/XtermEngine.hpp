@@ -47,6 +47,7 @@ namespace Microsoft::Console::Render
                                               const til::point coord,
                                               const bool trimLeft,
                                               const bool lineWrapped) noexcept override;
+        [[nodiscard]] HRESULT PaintBufferRow(const BufferRowInfo& row) noexcept override;
         [[nodiscard]] HRESULT ScrollFrame() noexcept override;
 
         [[nodiscard]] HRESULT InvalidateScroll(const til::point* const pcoordDelta) noexcept override;
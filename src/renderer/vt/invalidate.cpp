@@ -136,9 +136,13 @@ CATCH_RETURN();
 // Arguments:
 // - Receives a bool indicating if we should force the repaint.
 // Return Value:
-// - S_OK
+// - S_OK, else an appropriate HRESULT for failing to write the pending output.
 [[nodiscard]] HRESULT VtEngine::PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept
 {
     *pForcePaint = true;
-    return S_OK;
+
+    // The host exits right after the final frame, so from now on we wait for
+    // our output to be written, starting with what's already queued up.
+    _tearingDown = true;
+    return _Flush();
 }
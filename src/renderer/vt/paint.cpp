@@ -77,7 +77,14 @@ using namespace Microsoft::Console::Types;
             _virtualTop--;
         }
     }
+    // Circling the buffer shifts the terminal's contents in ways we don't
+    // track, so we can't trust our shadow of the screen any longer.
+    if (_circled)
+    {
+        _ResetShadowScreen();
+    }
     _circled = false;
+    _deferredBrushes.reset();
 
     // If _stopUsingLineRenditions is still true at the end of the frame, that
     // means we've refreshed the entire viewport with every line being single
@@ -441,6 +448,7 @@ using namespace Microsoft::Console::Types;
 [[nodiscard]] HRESULT VtEngine::_PaintUtf8BufferLine(const std::span<const Cluster> clusters,
                                                      const til::point coord,
                                                      const bool lineWrapped) noexcept
+try
 {
     if (coord.y < _virtualTop)
     {
@@ -455,10 +463,36 @@ using namespace Microsoft::Console::Types;
         _bufferLine.append(cluster.GetText());
         totalWidth += cluster.GetColumns();
     }
-    const auto cchLine = _bufferLine.size();
 
-    const auto spaceIndex = _bufferLine.find_last_not_of(L' ');
-    const auto foundNonspace = spaceIndex != decltype(_bufferLine)::npos;
+    return _PaintUtf8Text(_bufferLine, totalWidth, coord, lineWrapped);
+}
+CATCH_RETURN();
+
+// Routine Description:
+// - Draws a run of text to the screen, which has already been assembled into
+//      a single string. Writes the characters to the pipe, encoded in UTF-8.
+// Arguments:
+// - text - the text to be written
+// - totalWidth - the number of columns the text occupies
+// - coord - character coordinate target to render within viewport
+// - lineWrapped: true if this run we're painting is the end of a line that
+//   wrapped.
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT VtEngine::_PaintUtf8Text(const std::wstring_view text,
+                                               const til::CoordType totalWidth,
+                                               const til::point coord,
+                                               const bool lineWrapped) noexcept
+{
+    if (coord.y < _virtualTop)
+    {
+        return S_OK;
+    }
+
+    const auto cchLine = text.size();
+
+    const auto spaceIndex = text.find_last_not_of(L' ');
+    const auto foundNonspace = spaceIndex != decltype(text)::npos;
     const auto nonSpaceLength = foundNonspace ? spaceIndex + 1 : 0;
 
     // Examples:
@@ -554,11 +588,11 @@ using namespace Microsoft::Console::Types;
     // representation back to ASCII (handled by the _WriteTerminalDrcs method).
     if (_usingSoftFont) [[unlikely]]
     {
-        RETURN_IF_FAILED(VtEngine::_WriteTerminalDrcs({ _bufferLine.data(), cchActual }));
+        RETURN_IF_FAILED(VtEngine::_WriteTerminalDrcs(text.substr(0, cchActual)));
     }
     else
     {
-        RETURN_IF_FAILED(VtEngine::_WriteTerminalUtf8({ _bufferLine.data(), cchActual }));
+        RETURN_IF_FAILED(VtEngine::_WriteTerminalUtf8(text.substr(0, cchActual)));
     }
 
     // GH#4415, GH#5181
@@ -656,6 +690,258 @@ using namespace Microsoft::Console::Types;
     return S_OK;
 }
 
+// Routine Description:
+// - Draws one line of the buffer to the screen, but only the cells that differ
+//      from what we last emitted to the connected terminal. Unchanged clusters
+//      are skipped entirely (including the SGR sequences that would precede
+//      them), and each changed span is painted with _PaintUtf8BufferLine, so
+//      it still gets the cursor movement and ECH optimizations.
+// - Rows whose contents we don't know, or whose wrap state we'd need to
+//      preserve, are painted in full, exactly as _PaintUtf8BufferLine would.
+// Arguments:
+// - clusters - text and column counts for each piece of text.
+// - coord - character coordinate target to render within viewport
+// - lineWrapped: true if this run we're painting is the end of a line that
+//   wrapped.
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT VtEngine::_PaintChangedUtf8BufferLine(const std::span<const Cluster> clusters,
+                                                            const til::point coord,
+                                                            const bool lineWrapped) noexcept
+{
+    // Rewriting a handful of unchanged cells is cheaper than the CUF sequence
+    // we'd need to skip over them, so don't split spans at gaps this small.
+    static constexpr til::CoordType maxRepaintedGap = 4;
+
+    const auto shadowRow = _GetShadowRow(coord.y);
+    const auto paintEverything = shadowRow.empty() ||
+                                 coord.y < _virtualTop ||
+                                 lineWrapped ||
+                                 _wrappedRow.has_value() ||
+                                 _usingLineRenditions ||
+                                 _passthrough ||
+                                 (_newBottomLine && coord.y == _lastViewport.BottomInclusive());
+    if (paintEverything)
+    {
+        RETURN_IF_FAILED(_FlushDeferredBrushes());
+        RETURN_IF_FAILED(_PaintUtf8BufferLine(clusters, coord, lineWrapped));
+        if (coord.y >= _virtualTop)
+        {
+            _RecordShadowCells(clusters, coord);
+        }
+        return S_OK;
+    }
+
+    const auto clusterCount = clusters.size();
+    size_t begin = 0;
+    auto beginX = coord.x;
+    while (begin < clusterCount)
+    {
+        if (_ShadowCellMatches(shadowRow, beginX, til::at(clusters, begin)))
+        {
+            beginX += til::at(clusters, begin).GetColumns();
+            ++begin;
+            continue;
+        }
+
+        // Find the end of this changed span, absorbing short unchanged gaps.
+        auto end = begin + 1;
+        auto endX = beginX + til::at(clusters, begin).GetColumns();
+        auto x = endX;
+        til::CoordType gap = 0;
+        for (auto i = end; i < clusterCount && gap <= maxRepaintedGap; ++i)
+        {
+            const auto& cluster = til::at(clusters, i);
+            if (_ShadowCellMatches(shadowRow, x, cluster))
+            {
+                gap += cluster.GetColumns();
+            }
+            else
+            {
+                gap = 0;
+                end = i + 1;
+                endX = x + cluster.GetColumns();
+            }
+            x += cluster.GetColumns();
+        }
+
+        const auto span = clusters.subspan(begin, end - begin);
+        const til::point spanCoord{ beginX, coord.y };
+        RETURN_IF_FAILED(_FlushDeferredBrushes());
+        RETURN_IF_FAILED(_PaintUtf8BufferLine(span, spanCoord, false));
+        _RecordShadowCells(span, spanCoord);
+
+        begin = end;
+        beginX = endX;
+    }
+
+    return S_OK;
+}
+
+// Routine Description:
+// - When frame diffing, holds on to the arguments of an UpdateDrawingBrushes
+//      call instead of emitting the SGR sequences right away. They're emitted
+//      by _FlushDeferredBrushes once we know there's text that needs them.
+// - This includes the default brushes set at the start of each frame, which
+//      only matter to us if ScrollFrame needs to insert lines. It flushes them.
+// Arguments:
+// - The arguments given to UpdateDrawingBrushes.
+// Return Value:
+// - true if the call was deferred and the caller should return immediately.
+bool VtEngine::_DeferDrawingBrushes(const TextAttribute& textAttributes,
+                                    const RenderSettings& renderSettings,
+                                    IRenderData* const pData,
+                                    const bool usingSoftFont,
+                                    const bool isSettingDefaultBrushes) noexcept
+{
+    if (!_frameDiffing || _replayingBrushes)
+    {
+        return false;
+    }
+
+    _deferredBrushes = DeferredBrushes{ textAttributes, &renderSettings, pData, usingSoftFont, isSettingDefaultBrushes };
+    _runAttributes = textAttributes;
+    return true;
+}
+
+// Routine Description:
+// - Emits the SGR sequences for the last UpdateDrawingBrushes call that was
+//      deferred, if any.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_FlushDeferredBrushes() noexcept
+{
+    if (!_deferredBrushes)
+    {
+        return S_OK;
+    }
+
+    const auto brushes = *std::exchange(_deferredBrushes, std::nullopt);
+    _replayingBrushes = true;
+    const auto hr = UpdateDrawingBrushes(brushes.attributes, *brushes.renderSettings, brushes.renderData, brushes.usingSoftFont, brushes.isSettingDefaultBrushes);
+    _replayingBrushes = false;
+    return hr;
+}
+
+// Routine Description:
+// - Returns the shadow cells of the given viewport row, or an empty span if
+//      we aren't frame diffing or the row is out of bounds.
+std::span<VtEngine::ShadowCell> VtEngine::_GetShadowRow(const til::CoordType row) noexcept
+{
+    const auto width = _lastViewport.Width();
+    const auto height = _lastViewport.Height();
+    if (row < 0 || row >= height || _shadowCells.size() != gsl::narrow_cast<size_t>(width) * height)
+    {
+        return {};
+    }
+    return std::span{ _shadowCells }.subspan(gsl::narrow_cast<size_t>(row) * width, width);
+}
+
+// Routine Description:
+// - Returns true if the given cluster, painted with the current run's
+//      attributes, is exactly what the terminal already shows at the column.
+bool VtEngine::_ShadowCellMatches(const std::span<const ShadowCell> shadowRow,
+                                  const til::CoordType column,
+                                  const Cluster& cluster) const noexcept
+{
+    if (column < 0 || gsl::narrow_cast<size_t>(column) >= shadowRow.size())
+    {
+        return false;
+    }
+
+    const auto& cell = til::at(shadowRow, column);
+    const auto text = cluster.GetText();
+    return cell.length != 0 &&
+           cell.length == text.size() &&
+           cell.columns == cluster.GetColumns() &&
+           std::equal(text.begin(), text.end(), cell.text.begin()) &&
+           cell.attributes == _runAttributes;
+}
+
+// Routine Description:
+// - Remembers that the given clusters were painted with the current run's
+//      attributes. Clusters too long to store are recorded as unknown, which
+//      just means they'll always be repainted.
+void VtEngine::_RecordShadowCells(const std::span<const Cluster> clusters, const til::point coord) noexcept
+{
+    const auto shadowRow = _GetShadowRow(coord.y);
+    const auto width = gsl::narrow_cast<til::CoordType>(shadowRow.size());
+
+    auto x = coord.x;
+    for (const auto& cluster : clusters)
+    {
+        const auto text = cluster.GetText();
+        const auto columns = cluster.GetColumns();
+        for (til::CoordType i = 0; i < columns; ++i)
+        {
+            if (x + i < 0 || x + i >= width)
+            {
+                continue;
+            }
+
+            auto& cell = til::at(shadowRow, x + i);
+            cell = {};
+            cell.attributes = _runAttributes;
+            // Only the leading cell of a cluster holds its text. The
+            // trailing half of a wide glyph keeps a column count of 0.
+            if (i == 0 && text.size() <= cell.text.size())
+            {
+                std::copy(text.begin(), text.end(), cell.text.begin());
+                cell.length = gsl::narrow_cast<uint8_t>(text.size());
+                cell.columns = gsl::narrow_cast<uint8_t>(columns);
+            }
+        }
+        x += columns;
+    }
+}
+
+// Routine Description:
+// - Shifts the shadow screen by the given number of rows, the same way the
+//      scrolling sequences we emitted shifted the terminal's contents. The
+//      revealed rows are unknown.
+// Arguments:
+// - delta - the number of rows the contents moved down (negative for up).
+void VtEngine::_ScrollShadowScreen(const til::CoordType delta) noexcept
+{
+    const auto width = _lastViewport.Width();
+    const auto height = _lastViewport.Height();
+    if (_shadowCells.size() != gsl::narrow_cast<size_t>(width) * height)
+    {
+        return;
+    }
+
+    const auto shift = gsl::narrow_cast<ptrdiff_t>(std::min(std::abs(delta), height)) * width;
+    const auto begin = _shadowCells.begin();
+    const auto end = _shadowCells.end();
+    if (delta < 0)
+    {
+        std::move(begin + shift, end, begin);
+        std::fill(end - shift, end, ShadowCell{});
+    }
+    else
+    {
+        std::move_backward(begin, end - shift, end);
+        std::fill(begin, begin + shift, ShadowCell{});
+    }
+}
+
+// Routine Description:
+// - Forgets everything we know about the terminal's contents, so that the
+//      next frame repaints every invalidated cell in full. This is called
+//      whenever something we can't track may have changed the screen.
+void VtEngine::_ResetShadowScreen() noexcept
+try
+{
+    _shadowCells.clear();
+    if (_frameDiffing)
+    {
+        _shadowCells.resize(gsl::narrow_cast<size_t>(_lastViewport.Width()) * _lastViewport.Height());
+    }
+}
+CATCH_LOG()
+
 // Method Description:
 // - Updates the window's title string. Emits the VT sequence to SetWindowTitle.
 //      Because wintelnet does not understand these sequences by default, we
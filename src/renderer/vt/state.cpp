@@ -67,6 +67,23 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
 #endif
 }
 
+// Routine Description:
+// - Destroys the engine, after the writer thread finished writing everything
+//      that was queued up so far.
+VtEngine::~VtEngine()
+{
+    {
+        const std::scoped_lock lock{ _writerMutex };
+        _writerExit = true;
+    }
+    _writerCondition.notify_one();
+
+    if (_writerThread.joinable())
+    {
+        _writerThread.join();
+    }
+}
+
 // Method Description:
 // - Writes a fill of characters to our file handle (repeat of same character over and over)
 [[nodiscard]] HRESULT VtEngine::_WriteFill(const size_t n, const char c) noexcept
@@ -93,8 +110,9 @@ try
 #endif
 
     // TODO GH10001: Replace me with REP
+    const auto previousSize = _buffer.size();
     _buffer.append(n, c);
-    return S_OK;
+    return _OnBufferGrew(previousSize);
 }
 CATCH_RETURN();
 
@@ -129,38 +147,310 @@ CATCH_RETURN();
 
     try
     {
+        const auto previousSize = _buffer.size();
         _buffer.append(str);
 
-        return S_OK;
+        return _OnBufferGrew(previousSize);
     }
     CATCH_RETURN();
 }
 
+// Method Description:
+// - Applies the flush policy after something was appended to _buffer. We note
+//      when the buffer became non-empty for _FlushIfOverdue, and hand it over
+//      to the writer thread right away once it grew large enough.
+// - While _noFlushOnEnd is set, the current frame is deliberately held back
+//      (see EndPaint), so we must not write any part of it to the pipe.
+// Arguments:
+// - previousSize: the size of _buffer before the append.
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT VtEngine::_OnBufferGrew(const size_t previousSize) noexcept
+{
+    if (previousSize == 0)
+    {
+        _bufferStartTime = std::chrono::steady_clock::now();
+    }
+    if (_buffer.size() >= _outputPolicy.flushBytes && !_noFlushOnEnd)
+    {
+        return _Flush();
+    }
+    return S_OK;
+}
+
+// Method Description:
+// - Hands the contents of _buffer to the writer thread, which writes them to
+//      the pipe. This only blocks if the writer has fallen so far behind that
+//      queueing more would exceed OutputPolicy::maxPendingBytes, or if we're
+//      tearing down, in which case we wait for everything to be written.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
 [[nodiscard]] HRESULT VtEngine::_Flush() noexcept
+try
 {
-    if (_hFile)
+    if (!_hFile)
     {
-        auto fSuccess = !!WriteFile(_hFile.get(), _buffer.data(), gsl::narrow_cast<DWORD>(_buffer.size()), nullptr, nullptr);
-        _buffer.clear();
-        if (!fSuccess)
+        return S_OK;
+    }
+
+    auto hr = S_OK;
+    {
+        std::unique_lock lock{ _writerMutex };
+
+        if (!_buffer.empty() && SUCCEEDED(_writerResult))
         {
-            _exitResult = HRESULT_FROM_WIN32(GetLastError());
-            _hFile.reset();
-            if (_terminalOwner)
+            _drainedCondition.wait(lock, [&]() {
+                return _pendingBytes == 0 ||
+                       _pendingBytes + _buffer.size() <= _outputPolicy.maxPendingBytes ||
+                       FAILED(_writerResult);
+            });
+
+            std::string next;
+            if (!_outputPool.empty())
+            {
+                next = std::move(_outputPool.back());
+                _outputPool.pop_back();
+            }
+
+            _pendingBytes += _buffer.size();
+            _pendingOutput.emplace_back(std::exchange(_buffer, std::move(next)));
+
+            if (!_writerThread.joinable())
             {
-                _terminalOwner->CloseOutput();
+                _writerThread = std::thread{ [this]() { _WriterThread(); } };
             }
-            return _exitResult;
+            _writerCondition.notify_one();
         }
+
+        if (_tearingDown)
+        {
+            _drainedCondition.wait(lock, [&]() {
+                return _pendingBytes == 0 || FAILED(_writerResult);
+            });
+        }
+
+        hr = _writerResult;
     }
 
+    _buffer.clear();
+
+    if (FAILED(hr))
+    {
+        // The writer thread exits once it fails to write.
+        if (_writerThread.joinable())
+        {
+            _writerThread.join();
+        }
+
+        _exitResult = hr;
+        _hFile.reset();
+        if (_terminalOwner)
+        {
+            _terminalOwner->CloseOutput();
+        }
+        return _exitResult;
+    }
+
+    return S_OK;
+}
+CATCH_RETURN();
+
+// Method Description:
+// - Hands _buffer to the writer thread if the oldest byte in it has been
+//      waiting for longer than OutputPolicy::flushLatency. This keeps large
+//      frames from holding back all of their output until they're done,
+//      except for frames that EndPaint is going to hold back anyway.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT VtEngine::_FlushIfOverdue() noexcept
+{
+    if (!_noFlushOnEnd && !_buffer.empty() && std::chrono::steady_clock::now() - _bufferStartTime >= _outputPolicy.flushLatency)
+    {
+        return _Flush();
+    }
     return S_OK;
 }
 
+// Method Description:
+// - Writes the output queued up by _Flush to the pipe, until the engine is
+//      destroyed or a write fails. Pipes don't support gathered writes, so
+//      we coalesce small buffers into one write ourselves instead.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtEngine::_WriterThread() noexcept
+{
+    std::vector<std::string> batch;
+    std::string gathered;
+    std::unique_lock lock{ _writerMutex };
+
+    for (;;)
+    {
+        _writerCondition.wait(lock, [&]() {
+            return _writerExit || !_pendingOutput.empty();
+        });
+        if (_pendingOutput.empty())
+        {
+            break;
+        }
+
+        batch.swap(_pendingOutput);
+        const auto flushBytes = _outputPolicy.flushBytes;
+        lock.unlock();
+
+        auto hr = S_OK;
+        size_t written = 0;
+        const auto write = [&](const std::string& str) {
+            if (SUCCEEDED(hr) && !str.empty())
+            {
+                if (!WriteFile(_hFile.get(), str.data(), gsl::narrow_cast<DWORD>(str.size()), nullptr, nullptr))
+                {
+                    hr = HRESULT_FROM_WIN32(GetLastError());
+                }
+            }
+        };
+
+        try
+        {
+            gathered.clear();
+            for (const auto& buffer : batch)
+            {
+                written += buffer.size();
+                if (!gathered.empty() && gathered.size() + buffer.size() > flushBytes)
+                {
+                    write(gathered);
+                    gathered.clear();
+                }
+                if (buffer.size() >= flushBytes)
+                {
+                    write(buffer);
+                }
+                else
+                {
+                    gathered.append(buffer);
+                }
+            }
+            write(gathered);
+        }
+        catch (...)
+        {
+            hr = wil::ResultFromCaughtException();
+        }
+
+        lock.lock();
+
+        for (auto& buffer : batch)
+        {
+            // The pool is deliberately small. There's no point in holding on
+            // to more buffers than the render thread can fill between writes.
+            if (_outputPool.size() < 4)
+            {
+                buffer.clear();
+                _outputPool.emplace_back(std::move(buffer));
+            }
+        }
+        batch.clear();
+
+        _pendingBytes -= written;
+        if (FAILED(hr))
+        {
+            _writerResult = hr;
+            _pendingOutput.clear();
+            _pendingBytes = 0;
+            _drainedCondition.notify_all();
+            break;
+        }
+        _drainedCondition.notify_all();
+
+        // If the renderer skipped a frame because of us, tell it to try again.
+        if (_skippedFrame && _pendingBytes <= _outputPolicy.backPressureBytes)
+        {
+            _skippedFrame = false;
+            if (_pfnOutputDrained)
+            {
+                _pfnOutputDrained();
+            }
+        }
+    }
+}
+
+// Method Description:
+// - Returns true if the pipe's reader isn't keeping up with our output, and
+//      more than OutputPolicy::backPressureBytes are still waiting to be written.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if the writer thread is backed up.
+bool VtEngine::IsOutputBackedUp() noexcept
+{
+    const std::scoped_lock lock{ _writerMutex };
+    return _pendingBytes > _outputPolicy.backPressureBytes;
+}
+
+// Method Description:
+// - Decides whether StartPaint should skip this frame, because the writer
+//      thread is backed up. Frames we must not lose aren't skipped: the first
+//      one, those forced by InvalidateFlush or teardown, and those that
+//      follow output that's already sitting in our buffer.
+// - When a frame is skipped, the writer thread will call the output drained
+//      callback once it has caught up, so that the renderer paints again.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if the frame should be skipped.
+bool VtEngine::_ShouldSkipFrame() noexcept
+{
+    if (_firstPaint || _tearingDown || _circled || _noFlushOnEnd || !_buffer.empty() || !_hFile)
+    {
+        return false;
+    }
+
+    const std::scoped_lock lock{ _writerMutex };
+    if (_pendingBytes > _outputPolicy.backPressureBytes)
+    {
+        _skippedFrame = true;
+        return true;
+    }
+    return false;
+}
+
+// Method Description:
+// - Configures how output is buffered and handed to the writer thread.
+// Arguments:
+// - policy - The new output policy.
+// Return Value:
+// - <none>
+void VtEngine::SetOutputPolicy(const OutputPolicy& policy) noexcept
+{
+    const std::scoped_lock lock{ _writerMutex };
+    _outputPolicy = policy;
+}
+
+// Method Description:
+// - Sets the function the writer thread calls when it caught up with output,
+//      after we skipped a frame because it was backed up. This is called on
+//      the writer thread, so it should do little more than ask for a new frame.
+// Arguments:
+// - pfnDrained - The callback.
+// Return Value:
+// - <none>
+void VtEngine::SetOutputDrainedCallback(std::function<void()> pfnDrained) noexcept
+{
+    const std::scoped_lock lock{ _writerMutex };
+    _pfnOutputDrained = std::move(pfnDrained);
+}
+
 // Method Description:
 // - Wrapper for _Write.
 [[nodiscard]] HRESULT VtEngine::WriteTerminalUtf8(const std::string_view str) noexcept
 {
+    // We have no idea what this string does to the terminal's screen.
+    _ResetShadowScreen();
     return _Write(str);
 }
 
@@ -311,6 +601,11 @@ CATCH_RETURN();
     _suppressResizeRepaint = false;
     _lastViewport = newView;
 
+    if (oldSize != newSize)
+    {
+        _ResetShadowScreen();
+    }
+
     return hr;
 }
 
@@ -490,6 +785,22 @@ void VtEngine::SetResizeQuirk(const bool resizeQuirk)
     _resizeQuirk = resizeQuirk;
 }
 
+// Method Description:
+// - Configure the renderer to keep a shadow copy of the screen it has emitted,
+//   and to only repaint the cells of an invalidated region that differ from
+//   it. This trades a little memory and CPU for (potentially much) less
+//   output when applications redraw mostly unchanged content.
+// Arguments:
+// - frameDiffing - True to turn on frame diffing. False otherwise.
+// Return Value:
+// - <none>
+void VtEngine::SetFrameDiffing(const bool frameDiffing) noexcept
+{
+    _frameDiffing = frameDiffing;
+    _deferredBrushes.reset();
+    _ResetShadowScreen();
+}
+
 // Method Description:
 // - Configure the renderer to understand that we're operating in limited-draw
 //   passthrough mode. We do not need to handle full responsibility for replicating
@@ -553,6 +864,7 @@ HRESULT VtEngine::RequestWin32Input() noexcept
 HRESULT VtEngine::SwitchScreenBuffer(const bool useAltBuffer) noexcept
 {
     RETURN_IF_FAILED(_SwitchScreenBuffer(useAltBuffer));
+    _ResetShadowScreen();
     RETURN_IF_FAILED(_Flush());
     return S_OK;
 }
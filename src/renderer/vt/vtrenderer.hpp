@@ -20,6 +20,8 @@ Author(s):
 #include "tracing.hpp"
 #include <string>
 #include <functional>
+#include <chrono>
+#include <condition_variable>
 
 // fwdecl unittest classes
 #ifdef UNIT_TESTING
@@ -44,8 +46,26 @@ namespace Microsoft::Console::Render
         static const size_t ERASE_CHARACTER_STRING_LENGTH = 8;
         static const til::point INVALID_COORDS;
 
+        // Controls how our output gets to the pipe. Output is written by a
+        // separate thread, so that a slow reader on the other end doesn't stall
+        // the render thread (and with it, the console lock).
+        struct OutputPolicy
+        {
+            // Hand buffered output to the writer once it reaches this size,
+            // even in the middle of a frame...
+            size_t flushBytes = 64 * 1024;
+            // ...or once the oldest byte in it has waited this long.
+            std::chrono::milliseconds flushLatency{ 16 };
+            // While more than this many bytes are waiting to be written, skip
+            // frames, so that their changes get coalesced into a later one.
+            size_t backPressureBytes = 1024 * 1024;
+            // Block instead of queueing more than this many bytes.
+            size_t maxPendingBytes = 8 * 1024 * 1024;
+        };
+
         VtEngine(_In_ wil::unique_hfile hPipe,
                  const Microsoft::Console::Types::Viewport initialViewport);
+        ~VtEngine() override;
 
         // IRenderEngine
         [[nodiscard]] HRESULT StartPaint() noexcept override;
@@ -83,6 +103,10 @@ namespace Microsoft::Console::Render
         void BeginResizeRequest();
         void EndResizeRequest();
         void SetResizeQuirk(const bool resizeQuirk);
+        void SetFrameDiffing(const bool frameDiffing) noexcept;
+        void SetOutputPolicy(const OutputPolicy& policy) noexcept;
+        void SetOutputDrainedCallback(std::function<void()> pfnDrained) noexcept;
+        bool IsOutputBackedUp() noexcept;
         void SetPassthroughMode(const bool passthrough) noexcept;
         void SetLookingForDSRCallback(std::function<void(bool)> pfnLooking) noexcept;
         void SetTerminalCursorTextPosition(const til::point coordCursor) noexcept;
@@ -97,6 +121,8 @@ namespace Microsoft::Console::Render
 
         std::string _formatBuffer;
         std::string _conversionBuffer;
+        std::string _graphicsRendition;
+        bool _batchingGraphicsRendition{ false };
 
         bool _usingLineRenditions;
         bool _stopUsingLineRenditions;
@@ -142,9 +168,60 @@ namespace Microsoft::Console::Render
         bool _noFlushOnEnd{ false };
         std::optional<TextColor> _newBottomLineBG{ std::nullopt };
 
+        // A copy of what we believe the connected terminal is currently
+        // displaying, one cell per column of the viewport. Only maintained
+        // when frame diffing is enabled. A cell with a length of 0 is unknown
+        // and will always be repainted.
+        struct ShadowCell
+        {
+            TextAttribute attributes;
+            std::array<wchar_t, 2> text{};
+            uint8_t length{ 0 };
+            uint8_t columns{ 0 };
+        };
+
+        // The arguments of the last UpdateDrawingBrushes call, which we hold
+        // on to until we know that the following run actually needs painting.
+        struct DeferredBrushes
+        {
+            TextAttribute attributes;
+            const RenderSettings* renderSettings;
+            IRenderData* renderData;
+            bool usingSoftFont;
+            bool isSettingDefaultBrushes;
+        };
+
+        bool _frameDiffing{ false };
+        bool _replayingBrushes{ false };
+        std::vector<ShadowCell> _shadowCells;
+        std::optional<DeferredBrushes> _deferredBrushes;
+        TextAttribute _runAttributes;
+
+        OutputPolicy _outputPolicy;
+        std::chrono::steady_clock::time_point _bufferStartTime;
+        bool _tearingDown{ false };
+
+        // The state below is shared with the writer thread and guarded by
+        // _writerMutex.
+        std::mutex _writerMutex;
+        std::condition_variable _writerCondition;
+        std::condition_variable _drainedCondition;
+        std::thread _writerThread;
+        std::vector<std::string> _pendingOutput;
+        std::vector<std::string> _outputPool;
+        size_t _pendingBytes{ 0 };
+        HRESULT _writerResult{ S_OK };
+        bool _writerExit{ false };
+        bool _skippedFrame{ false };
+        std::function<void()> _pfnOutputDrained;
+
         [[nodiscard]] HRESULT _WriteFill(const size_t n, const char c) noexcept;
         [[nodiscard]] HRESULT _Write(std::string_view const str) noexcept;
         [[nodiscard]] HRESULT _Flush() noexcept;
+        [[nodiscard]] HRESULT _FlushIfOverdue() noexcept;
+        [[nodiscard]] HRESULT _OnBufferGrew(const size_t previousSize) noexcept;
+        bool _ShouldSkipFrame() noexcept;
+        void _WriterThread() noexcept;
 
         template<typename S, typename... Args>
         [[nodiscard]] HRESULT _WriteFormatted(S&& format, Args&&... args)
@@ -156,6 +233,20 @@ namespace Microsoft::Console::Render
         }
         CATCH_RETURN()
 
+        template<typename S, typename... Args>
+        [[nodiscard]] HRESULT _WriteGraphicsRenditionFormatted(S&& format, Args&&... args)
+        try
+        {
+            fmt::basic_memory_buffer<char, 32> buf;
+            fmt::format_to(std::back_inserter(buf), std::forward<S>(format), std::forward<Args>(args)...);
+            return _WriteGraphicsRendition({ buf.data(), buf.size() });
+        }
+        CATCH_RETURN()
+
+        [[nodiscard]] HRESULT _WriteGraphicsRendition(const std::string_view parameters) noexcept;
+        void _BeginGraphicsRendition() noexcept;
+        [[nodiscard]] HRESULT _EndGraphicsRendition() noexcept;
+
         void _OrRect(_Inout_ til::inclusive_rect* const pRectExisting, const til::inclusive_rect* const pRectToOr) const;
         bool _AllIsInvalid() const;
 
@@ -220,10 +311,31 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _PaintUtf8BufferLine(const std::span<const Cluster> clusters,
                                                    const til::point coord,
                                                    const bool lineWrapped) noexcept;
+        [[nodiscard]] HRESULT _PaintUtf8Text(const std::wstring_view text,
+                                             const til::CoordType totalWidth,
+                                             const til::point coord,
+                                             const bool lineWrapped) noexcept;
 
         [[nodiscard]] HRESULT _PaintAsciiBufferLine(const std::span<const Cluster> clusters,
                                                     const til::point coord) noexcept;
 
+        [[nodiscard]] HRESULT _PaintChangedUtf8BufferLine(const std::span<const Cluster> clusters,
+                                                          const til::point coord,
+                                                          const bool lineWrapped) noexcept;
+
+        bool _DeferDrawingBrushes(const TextAttribute& textAttributes,
+                                  const RenderSettings& renderSettings,
+                                  IRenderData* const pData,
+                                  const bool usingSoftFont,
+                                  const bool isSettingDefaultBrushes) noexcept;
+        [[nodiscard]] HRESULT _FlushDeferredBrushes() noexcept;
+
+        std::span<ShadowCell> _GetShadowRow(const til::CoordType row) noexcept;
+        bool _ShadowCellMatches(const std::span<const ShadowCell> shadowRow, const til::CoordType column, const Cluster& cluster) const noexcept;
+        void _RecordShadowCells(const std::span<const Cluster> clusters, const til::point coord) noexcept;
+        void _ScrollShadowScreen(const til::CoordType delta) noexcept;
+        void _ResetShadowScreen() noexcept;
+
         [[nodiscard]] HRESULT _WriteTerminalUtf8(const std::wstring_view str) noexcept;
         [[nodiscard]] HRESULT _WriteTerminalAscii(const std::wstring_view str) noexcept;
         [[nodiscard]] HRESULT _WriteTerminalDrcs(const std::wstring_view str) noexcept;
@@ -62,7 +62,7 @@ bool InteractDispatch::WriteCtrlKey(const KeyEvent& event)
 
 // Method Description:
 // - Writes a string of input to the host. The string is converted to keystrokes
-//      that will faithfully represent the input by CharToKeyEvents.
+//      that will faithfully represent the input by StringToInputRecords.
 // Arguments:
 // - string : a string to write to the console.
 // Return Value:
@@ -72,18 +72,14 @@ bool InteractDispatch::WriteString(const std::wstring_view string)
     if (!string.empty())
     {
         const auto codepage = _api.GetConsoleOutputCP();
-        std::deque<std::unique_ptr<IInputEvent>> keyEvents;
 
-        for (const auto& wch : string)
-        {
-            auto convertedEvents = CharToKeyEvents(wch, codepage);
-
-            std::move(convertedEvents.begin(),
-                      convertedEvents.end(),
-                      std::back_inserter(keyEvents));
-        }
+        // Pastes can easily be hundreds of kilobytes large, so we synthesize the
+        // key events straight into INPUT_RECORDs instead of one IInputEvent per key.
+        std::vector<INPUT_RECORD> records;
+        StringToInputRecords(string, codepage, records);
 
-        WriteInput(keyEvents);
+        const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        gci.GetActiveInputBuffer()->Write(records);
     }
     return true;
 }
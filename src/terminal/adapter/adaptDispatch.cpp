@@ -621,20 +621,9 @@ void AdaptDispatch::_ScrollRectVertically(TextBuffer& textBuffer, const til::rec
         else
         {
             // Otherwise we have to move the content up or down by copying the
-            // requested buffer range one cell at a time.
-            const auto srcOrigin = til::point{ scrollRect.left, top };
-            const auto dstOrigin = til::point{ scrollRect.left, top + actualDelta };
-            const auto srcView = Viewport::FromDimensions(srcOrigin, width, height);
-            const auto dstView = Viewport::FromDimensions(dstOrigin, width, height);
-            const auto walkDirection = Viewport::DetermineWalkDirection(srcView, dstView);
-            auto srcPos = srcView.GetWalkOrigin(walkDirection);
-            auto dstPos = dstView.GetWalkOrigin(walkDirection);
-            do
-            {
-                const auto current = OutputCell(*textBuffer.GetCellDataAt(srcPos));
-                textBuffer.WriteLine(OutputCellIterator({ &current, 1 }), dstPos);
-                srcView.WalkInBounds(srcPos, walkDirection);
-            } while (dstView.WalkInBounds(dstPos, walkDirection));
+            // requested buffer range one row span at a time.
+            const auto source = til::rect{ scrollRect.left, top, scrollRect.right, top + height };
+            textBuffer.CopyRectangle(source, { scrollRect.left, top + actualDelta });
         }
     }
 
@@ -663,27 +652,14 @@ void AdaptDispatch::_ScrollRectHorizontally(TextBuffer& textBuffer, const til::r
     if (absoluteDelta < scrollRect.width())
     {
         const auto left = delta > 0 ? scrollRect.left : (scrollRect.left + absoluteDelta);
-        const auto top = scrollRect.top;
         const auto width = scrollRect.width() - absoluteDelta;
-        const auto height = scrollRect.height();
         const auto actualDelta = delta > 0 ? absoluteDelta : -absoluteDelta;
 
-        const auto source = Viewport::FromDimensions({ left, top }, width, height);
-        const auto target = Viewport::Offset(source, { actualDelta, 0 });
-        const auto walkDirection = Viewport::DetermineWalkDirection(source, target);
-        auto sourcePos = source.GetWalkOrigin(walkDirection);
-        auto targetPos = target.GetWalkOrigin(walkDirection);
-        // Note that we read two cells from the source before we start writing
-        // to the target, so a two-cell DBCS character can't accidentally delete
-        // itself when moving one cell horizontally.
-        auto next = OutputCell(*textBuffer.GetCellDataAt(sourcePos));
-        do
-        {
-            const auto current = next;
-            source.WalkInBounds(sourcePos, walkDirection);
-            next = OutputCell(*textBuffer.GetCellDataAt(sourcePos));
-            textBuffer.WriteLine(OutputCellIterator({ &current, 1 }), targetPos);
-        } while (target.WalkInBounds(targetPos, walkDirection));
+        // CopyRectangle() snapshots each source row before writing to it, so a
+        // two-cell DBCS character can't accidentally delete itself when moving
+        // one cell horizontally.
+        const auto source = til::rect{ left, scrollRect.top, left + width, scrollRect.bottom };
+        textBuffer.CopyRectangle(source, { left + actualDelta, scrollRect.top });
     }
 
     // Columns revealed by the scroll are filled with standard erase attributes.
@@ -1228,28 +1204,10 @@ bool AdaptDispatch::CopyRectangularArea(const VTInt top, const VTInt left, const
     {
         // If the source is bigger than the available space at the destination
         // it needs to be clipped, so we only care about the destination size.
-        const auto srcView = Viewport::FromDimensions(srcRect.origin(), dstRect.size());
-        const auto dstView = Viewport::FromDimensions(dstRect.origin(), dstRect.size());
-        const auto walkDirection = Viewport::DetermineWalkDirection(srcView, dstView);
-        auto srcPos = srcView.GetWalkOrigin(walkDirection);
-        auto dstPos = dstView.GetWalkOrigin(walkDirection);
-        // Note that we read two cells from the source before we start writing
-        // to the target, so a two-cell DBCS character can't accidentally delete
-        // itself when moving one cell horizontally.
-        auto next = OutputCell(*textBuffer.GetCellDataAt(srcPos));
-        do
-        {
-            const auto current = next;
-            const auto currentSrcPos = srcPos;
-            srcView.WalkInBounds(srcPos, walkDirection);
-            next = OutputCell(*textBuffer.GetCellDataAt(srcPos));
-            // If the source position is offscreen (which can occur on double
-            // width lines), then we shouldn't copy anything to the destination.
-            if (currentSrcPos.x < textBuffer.GetLineWidth(currentSrcPos.y))
-            {
-                textBuffer.WriteLine(OutputCellIterator({ &current, 1 }), dstPos);
-            }
-        } while (dstView.WalkInBounds(dstPos, walkDirection));
+        const auto source = til::rect{ srcRect.origin(), dstRect.size() };
+        // If a source position is offscreen (which can occur on double
+        // width lines), then we shouldn't copy anything to the destination.
+        textBuffer.CopyRectangle(source, dstRect.origin(), true);
         _api.NotifyAccessibilityChange(dstRect);
     }
 
@@ -2407,7 +2365,7 @@ void AdaptDispatch::_DoLineFeed(TextBuffer& textBuffer, const bool withReturn, c
 
     // If the line was forced to wrap, set the wrap status.
     // When explicitly moving down a row, clear the wrap status.
-    textBuffer.GetRowByOffset(currentPosition.y).SetWrapForced(wrapForced);
+    textBuffer.SetWrapForced(currentPosition.y, wrapForced);
 
     // If a carriage return was requested, we move to the leftmost column or
     // the left margin, depending on whether we started within the margins.
@@ -2454,6 +2412,7 @@ void AdaptDispatch::_DoLineFeed(TextBuffer& textBuffer, const bool withReturn, c
         {
             const auto eraseAttributes = _GetEraseAttributes(textBuffer);
             textBuffer.GetRowByOffset(newPosition.y).Reset(eraseAttributes);
+            textBuffer.TriggerRedraw(Viewport::FromDimensions({ 0, newPosition.y }, { bufferWidth, 1 }));
         }
     }
     else
@@ -1968,6 +1968,21 @@ void StateMachine::ProcessString(const std::wstring_view string)
             break;
         }
 
+        // Colored output and TUI redraws consist mostly of simple CSI sequences
+        // (SGR, CUP, EL, ECH, ...), which we can dispatch without going through
+        // the state machine one character at a time. If that fails, we fall
+        // back to the general path below.
+        if (_state == VTStates::Ground)
+        {
+            if (const auto consumed = _TryDispatchCsi(string, i))
+            {
+                i += consumed;
+                _runOffset = i;
+                _runSize = 0;
+                continue;
+            }
+        }
+
         do
         {
             _runSize++;
@@ -2062,6 +2077,108 @@ void StateMachine::ProcessString(const std::wstring_view string)
     }
 }
 
+// Routine Description:
+// - A fast path for simple CSI sequences, like "\x1b[38;2;255;128;0m" (SGR) or
+//   the "\x1b[12;1H" (CUP), "\x1b[K" (EL) and "\x1b[5X" (ECH) that full-screen
+//   applications emit by the thousands when redrawing. If the string contains
+//   a complete 7-bit CSI at the given offset, whose parameters consist of
+//   nothing but digits and semicolons and whose final character is in the
+//   range 0x40-0x7E, its parameters are parsed in a tight loop and the
+//   sequence is dispatched right away.
+// - Anything unusual (private markers, intermediates, sub-parameters, embedded
+//   control characters, parameter overflow, a sequence that isn't complete
+//   yet, etc.) is left to the general state machine, which handles all of
+//   these cases exactly as before.
+// Arguments:
+// - string - The string that's being processed.
+// - offset - The offset of the character to start at.
+// Return Value:
+// - The number of characters that were consumed, or 0 if the fast path didn't apply.
+size_t StateMachine::_TryDispatchCsi(const std::wstring_view string, const size_t offset)
+{
+    // The input engine has its own rules for incomplete sequences and
+    // in VT52 mode "ESC [" isn't a CSI to begin with.
+    if (_isEngineForInput || !_parserMode.test(Mode::Ansi))
+    {
+        return 0;
+    }
+
+    // The shortest possible sequence is something like "\x1b[m".
+    // Pointer arithmetic is perfectly fine for our hot path.
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+    const auto beg = string.data() + offset;
+    const auto end = string.data() + string.size();
+    if (end - beg < 3 || beg[0] != AsciiChars::ESC || beg[1] != L'[')
+    {
+        return 0;
+    }
+
+    std::array<VTParameter, MAX_PARAMETER_COUNT> parameters;
+    size_t parameterCount = 0;
+    auto it = beg + 2;
+
+    const auto isFinal = [](const wchar_t wch) {
+        return wch >= L'@' && wch <= L'~'; // 0x40 - 0x7E
+    };
+
+    // This mirrors _ActionParam: "\x1b[m" has no parameters at all, while
+    // "\x1b[;m" has two omitted ones. Values are clamped to MAX_PARAMETER_VALUE.
+    if (!isFinal(*it))
+    {
+        for (;;)
+        {
+            VTInt value = 0;
+            auto hasValue = false;
+            for (; it != end && _isNumericParamValue(*it); ++it)
+            {
+                _AccumulateTo(*it, value);
+                hasValue = true;
+            }
+
+            // Too many parameters are rare enough that we let _ActionParam deal with them.
+            if (it == end || parameterCount == parameters.size())
+            {
+                return 0;
+            }
+
+            til::at(parameters, parameterCount++) = hasValue ? VTParameter{ value } : VTParameter{};
+
+            if (!_isParameterDelimiter(*it))
+            {
+                break;
+            }
+            ++it;
+        }
+
+        if (!isFinal(*it))
+        {
+            return 0;
+        }
+    }
+
+    const auto finalChar = *it;
+    const auto consumed = gsl::narrow_cast<size_t>(it + 1 - beg);
+#pragma warning(pop)
+
+    // The engine may want to flush the current sequence to the terminal (ConPTY)
+    // or ask whether this is the last character, so set up the same state the
+    // general path would have at the time of the dispatch.
+    _runOffset = offset;
+    _runSize = consumed;
+    _processingLastCharacter = offset + consumed >= string.size();
+
+    _trace.AddSequenceTrace(_CurrentRun());
+    _trace.TraceOnAction(L"CsiDispatch");
+    _trace.DispatchSequenceTrace(_SafeExecute([&]() {
+        return _engine->ActionCsiDispatch(VTID{ static_cast<uint64_t>(finalChar) }, { parameters.data(), parameterCount });
+    }));
+
+    _EnterGround();
+    _ExecuteCsiCompleteCallback();
+    return consumed;
+}
+
 // Routine Description:
 // - Determines whether the character being processed is the last in the
 //   current output fragment, or there are more still to come. Other parts
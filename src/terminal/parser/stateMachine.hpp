@@ -138,6 +138,8 @@ namespace Microsoft::Console::VirtualTerminal
 
         void _AccumulateTo(const wchar_t wch, VTInt& value) noexcept;
 
+        size_t _TryDispatchCsi(const std::wstring_view string, const size_t offset);
+
         template<typename TLambda>
         bool _SafeExecute(TLambda&& lambda);
 
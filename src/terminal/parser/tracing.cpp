@@ -85,6 +85,15 @@ void ParserTracing::AddSequenceTrace(const wchar_t wch)
     }
 }
 
+void ParserTracing::AddSequenceTrace(const std::wstring_view& sequence)
+{
+    // Don't waste time storing this if no one is listening.
+    if (TraceLoggingProviderEnabled(g_hConsoleVirtTermParserEventTraceProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE))
+    {
+        _sequenceTrace.append(sequence);
+    }
+}
+
 void ParserTracing::DispatchSequenceTrace(const bool fSuccess) noexcept
 {
     if (fSuccess)
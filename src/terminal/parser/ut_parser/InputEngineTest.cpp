@@ -279,6 +279,11 @@ class Microsoft::Console::VirtualTerminal::InputEngineTest
     TEST_METHOD(TestWin32InputParsing);
     TEST_METHOD(TestWin32InputOptionals);
 
+    TEST_METHOD(TestStringToInputRecords);
+    BEGIN_TEST_METHOD(PasteThroughput)
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD()
+
     friend class TestInteractDispatch;
 };
 
@@ -374,18 +379,12 @@ bool TestInteractDispatch::WindowManipulation(const DispatchTypes::WindowManipul
 
 bool TestInteractDispatch::WriteString(const std::wstring_view string)
 {
-    std::deque<std::unique_ptr<IInputEvent>> keyEvents;
-
-    for (const auto& wch : string)
-    {
-        // We're forcing the translation to CP_USA, so that it'll be constant
-        //  regardless of the CP the test is running in
-        auto convertedEvents = Microsoft::Console::Interactivity::CharToKeyEvents(wch, CP_USA);
-        std::move(convertedEvents.begin(),
-                  convertedEvents.end(),
-                  std::back_inserter(keyEvents));
-    }
+    // We're forcing the translation to CP_USA, so that it'll be constant
+    //  regardless of the CP the test is running in
+    std::vector<INPUT_RECORD> records;
+    Microsoft::Console::Interactivity::StringToInputRecords(string, CP_USA, records);
 
+    auto keyEvents = IInputEvent::Create(records);
     return WriteInput(keyEvents);
 }
 
@@ -1603,3 +1602,70 @@ void InputEngineTest::TestWin32InputOptionals()
         }
     }
 }
+
+void InputEngineTest::TestStringToInputRecords()
+{
+    // StringToInputRecords must produce exactly what CharToKeyEvents does for
+    // each individual character. This string contains controls, characters that
+    // require shift, characters outside of the keyboard layout, wide characters,
+    // and characters that share a slot in the lookup table ('A' and U+0141).
+    const std::wstring_view text{ L"abc ABC 123 !@# \r\n\t\x1b\x7f\u00e9\u00a0\u2502\u4e00\u0141A\u0141a" };
+
+    std::vector<INPUT_RECORD> expected;
+    for (const auto wch : text)
+    {
+        for (const auto& event : Microsoft::Console::Interactivity::CharToKeyEvents(wch, CP_USA))
+        {
+            expected.push_back(event->ToInputRecord());
+        }
+    }
+
+    // The records are supposed to be appended to whatever is in the vector already.
+    std::vector<INPUT_RECORD> actual(1);
+    Microsoft::Console::Interactivity::StringToInputRecords(text, CP_USA, actual);
+
+    VERIFY_ARE_EQUAL(expected.size() + 1, actual.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        VERIFY_ARE_EQUAL(expected[i], actual[i + 1]);
+    }
+}
+
+void InputEngineTest::PasteThroughput()
+{
+    // Simulates pasting 100KB of source code into a ConPTY session.
+    std::wstring text;
+    while (text.size() < 100 * 1024)
+    {
+        text.append(L"    if (Value != nullptr && Value->Count() > 0) { return Value->At(0); } // TODO: Handle #42\r");
+    }
+
+    const auto measure = [&](auto&& func) {
+        const auto beg = std::chrono::steady_clock::now();
+        func();
+        const auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(end - beg).count();
+    };
+
+    size_t perCharCount = 0;
+    const auto perCharMs = measure([&]() {
+        std::deque<std::unique_ptr<IInputEvent>> keyEvents;
+        for (const auto wch : text)
+        {
+            auto convertedEvents = Microsoft::Console::Interactivity::CharToKeyEvents(wch, CP_USA);
+            std::move(convertedEvents.begin(), convertedEvents.end(), std::back_inserter(keyEvents));
+        }
+        perCharCount = IInputEvent::ToInputRecords(keyEvents).size();
+    });
+
+    size_t batchCount = 0;
+    const auto batchMs = measure([&]() {
+        std::vector<INPUT_RECORD> records;
+        Microsoft::Console::Interactivity::StringToInputRecords(text, CP_USA, records);
+        batchCount = records.size();
+    });
+
+    VERIFY_ARE_EQUAL(perCharCount, batchCount);
+    Log::Comment(NoThrowString().Format(L"CharToKeyEvents: %.2f ms (%.2f MB/s)", perCharMs, text.size() * sizeof(wchar_t) / perCharMs / 1000.0));
+    Log::Comment(NoThrowString().Format(L"StringToInputRecords: %.2f ms (%.2f MB/s)", batchMs, text.size() * sizeof(wchar_t) / batchMs / 1000.0));
+}
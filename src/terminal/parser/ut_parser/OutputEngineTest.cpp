@@ -2028,6 +2028,107 @@ class StateMachineExternalTest final
         pDispatch->ClearState();
     }
 
+    // ProcessString parses simple CSI sequences without going through the
+    // state machine. This verifies that it produces the same result as
+    // feeding the very same string one character at a time.
+    void VerifyFastPath(const std::initializer_list<std::wstring_view> chunks)
+    {
+        auto stringDispatch = std::make_unique<StatefulDispatch>();
+        auto& stringResult = *stringDispatch;
+        StateMachine stringMach{ std::make_unique<OutputStateMachineEngine>(std::move(stringDispatch)) };
+
+        auto charDispatch = std::make_unique<StatefulDispatch>();
+        auto& charResult = *charDispatch;
+        StateMachine charMach{ std::make_unique<OutputStateMachineEngine>(std::move(charDispatch)) };
+
+        for (const auto chunk : chunks)
+        {
+            stringMach.ProcessString(chunk);
+            for (const auto wch : chunk)
+            {
+                charMach.ProcessCharacter(wch);
+            }
+        }
+
+        VERIFY_ARE_EQUAL(charResult._printString, stringResult._printString);
+        VERIFY_ARE_EQUAL(charResult._setGraphics, stringResult._setGraphics);
+        VERIFY_ARE_EQUAL(charResult._options.size(), stringResult._options.size());
+        for (size_t i = 0; i < charResult._options.size(); i++)
+        {
+            VERIFY_IS_TRUE(til::at(charResult._options, i) == til::at(stringResult._options, i));
+        }
+        VERIFY_ARE_EQUAL(charResult._cursorPosition, stringResult._cursorPosition);
+        VERIFY_ARE_EQUAL(charResult._cursorUp, stringResult._cursorUp);
+        VERIFY_ARE_EQUAL(charResult._cursorDistance, stringResult._cursorDistance);
+        VERIFY_ARE_EQUAL(charResult._line, stringResult._line);
+        VERIFY_ARE_EQUAL(charResult._column, stringResult._column);
+        VERIFY_ARE_EQUAL(charResult._eraseLine, stringResult._eraseLine);
+        VERIFY_ARE_EQUAL(charResult._eraseTypes.size(), stringResult._eraseTypes.size());
+        for (size_t i = 0; i < charResult._eraseTypes.size(); i++)
+        {
+            VERIFY_IS_TRUE(til::at(charResult._eraseTypes, i) == til::at(stringResult._eraseTypes, i));
+        }
+        VERIFY_ARE_EQUAL(charResult._modeTypes.size(), stringResult._modeTypes.size());
+        VERIFY_ARE_EQUAL(charResult._lineFeed, stringResult._lineFeed);
+    }
+
+    TEST_METHOD(TestSetGraphicsRenditionFastPath)
+    {
+        Log::Comment(L"Default, explicit and omitted parameters.");
+        VerifyFastPath({ L"\x1b[m" });
+        VerifyFastPath({ L"\x1b[0m" });
+        VerifyFastPath({ L"\x1b[;m" });
+        VerifyFastPath({ L"\x1b[1;;4m" });
+        VerifyFastPath({ L"\x1b[1;4;m" });
+
+        Log::Comment(L"Extended colors surrounded by text.");
+        VerifyFastPath({ L"A\x1b[38;5;123mB\x1b[48;2;255;128;0mC\x1b[mD" });
+
+        Log::Comment(L"Values larger than the maximum are clamped.");
+        VerifyFastPath({ L"\x1b[38;2;99999;65536;1234567m" });
+
+        Log::Comment(L"More parameters than supported.");
+        VerifyFastPath({ L"\x1b[1;2;3;4;5;6;7;8;9;1;2;3;4;5;6;7;8;9;1;2;3;4;5;6;7;8;9;1;2;3;4;5;6;7;8;9m" });
+
+        Log::Comment(L"Sequences the fast path must leave to the state machine.");
+        VerifyFastPath({ L"\x1b[?1m" });
+        VerifyFastPath({ L"\x1b[4:3m" });
+        VerifyFastPath({ L"\x1b[1 m" });
+        VerifyFastPath({ L"\x1b[1\x1b[4m" });
+        VerifyFastPath({ L"\x1b[1\x18m" });
+
+        Log::Comment(L"Sequences split across multiple writes.");
+        VerifyFastPath({ L"\x1b", L"[31m" });
+        VerifyFastPath({ L"\x1b[", L"31m" });
+        VerifyFastPath({ L"\x1b[3", L"1mX" });
+        VerifyFastPath({ L"X\x1b[31", L"m" });
+    }
+
+    TEST_METHOD(TestCsiFastPath)
+    {
+        Log::Comment(L"A typical TUI redraw: position, text, erase the rest of the line.");
+        VerifyFastPath({ L"\x1b[1;1Hhtop\x1b[K\x1b[2;1H\x1b[7mCPU\x1b[m\x1b[K\x1b[24;80H" });
+
+        Log::Comment(L"Default, omitted and clamped parameters.");
+        VerifyFastPath({ L"\x1b[H" });
+        VerifyFastPath({ L"\x1b[;5H" });
+        VerifyFastPath({ L"\x1b[5;H" });
+        VerifyFastPath({ L"\x1b[99999;99999H" });
+        VerifyFastPath({ L"\x1b[0K\x1b[1K\x1b[2K" });
+        VerifyFastPath({ L"\x1b[A\x1b[0A\x1b[12A" });
+
+        Log::Comment(L"Sequences the fast path must leave to the state machine.");
+        VerifyFastPath({ L"\x1b[?25l\x1b[?1049h" });
+        VerifyFastPath({ L"\x1b[>0c" });
+        VerifyFastPath({ L"\x1b[5\nA" });
+        VerifyFastPath({ L"\x1b[5\x7fA" });
+        VerifyFastPath({ L"\x1b[1;2\u4E00" });
+
+        Log::Comment(L"Sequences split across multiple writes.");
+        VerifyFastPath({ L"\x1b[10;", L"20H" });
+        VerifyFastPath({ L"abc\x1b[", L"K" });
+    }
+
     TEST_METHOD(TestDeviceStatusReport)
     {
         auto dispatch = std::make_unique<StatefulDispatch>();
@@ -17,8 +17,56 @@ class Utf8Utf16ConvertTests
     TEST_METHOD(TestU8ToU16Partials);
     TEST_METHOD(TestU16ToU8Partials);
     TEST_METHOD(TestU8ToU16OneByOne);
+    TEST_METHOD(TestU8ToU16MatchesPlatform);
+    TEST_METHOD(TestU16ToU8MatchesPlatform);
+
+    BEGIN_TEST_METHOD(ConversionThroughput)
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD()
 };
 
+// Builds a string that alternates between runs of ASCII of varying length (including
+// ones long enough for the vectorized fast path) and the given non-ASCII sequences.
+template<typename T>
+static std::basic_string<T> makeMixedString(const std::vector<std::basic_string<T>>& sequences, const size_t count)
+{
+    static constexpr std::string_view ascii{ "\x1b[38;2;1;2;3mThe quick brown fox jumps over the lazy dog 0123456789\r\n" };
+
+    std::basic_string<T> str;
+    uint32_t seed = 1;
+    const auto next = [&]() {
+        seed = seed * 1664525 + 1013904223;
+        return seed >> 16;
+    };
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto asciiLength = next() % 40;
+        const auto asciiOffset = next() % (ascii.size() - asciiLength);
+        for (size_t j = 0; j < asciiLength; ++j)
+        {
+            str.push_back(static_cast<T>(ascii[asciiOffset + j]));
+        }
+        str.append(sequences[next() % sequences.size()]);
+    }
+
+    return str;
+}
+
+static std::wstring platformU8U16(const std::string_view str)
+{
+    std::wstring out(str.size(), L'\0');
+    out.resize(MultiByteToWideChar(CP_UTF8, 0, str.data(), gsl::narrow_cast<int>(str.size()), out.data(), gsl::narrow_cast<int>(out.size())));
+    return out;
+}
+
+static std::string platformU16U8(const std::wstring_view str)
+{
+    std::string out(str.size() * 3, '\0');
+    out.resize(WideCharToMultiByte(CP_UTF8, 0, str.data(), gsl::narrow_cast<int>(str.size()), out.data(), gsl::narrow_cast<int>(out.size()), nullptr, nullptr));
+    return out;
+}
+
 void Utf8Utf16ConvertTests::TestU8ToU16()
 {
     const std::string u8String{
@@ -191,3 +239,138 @@ void Utf8Utf16ConvertTests::TestU8ToU16OneByOne()
     VERIFY_SUCCEEDED(til::u8u16(u8String1_4, u16Out1, state));
     VERIFY_ARE_EQUAL(u16StringComp1, u16Out1);
 }
+
+void Utf8Utf16ConvertTests::TestU8ToU16MatchesPlatform()
+{
+    const std::vector<std::string> valid{
+        "\xC3\xB6", // LATIN SMALL LETTER O WITH DIAERESIS
+        "\xD0\x96", // CYRILLIC CAPITAL LETTER ZHE
+        "\xE2\x94\x80", // BOX DRAWINGS LIGHT HORIZONTAL
+        "\xE4\xB8\xAD", // CJK UNIFIED IDEOGRAPH-4E2D
+        "\xF0\x9F\x93\xB7", // CAMERA
+    };
+    auto invalid = valid;
+    invalid.insert(invalid.end(), {
+                                      "\x80", // lone continuation byte
+                                      "\xC3", // truncated sequences
+                                      "\xE2\x94",
+                                      "\xF0\x9F\x93",
+                                      "\xC0\xAF", // overlong encoding
+                                      "\xED\xA0\x80", // encoded surrogate
+                                      "\xF5\x80\x80\x80", // beyond U+10FFFF
+                                      "\xFF",
+                                  });
+
+    Log::Comment(L"Valid and invalid input should be converted exactly like MultiByteToWideChar does.");
+    for (const auto& sequences : { valid, invalid })
+    {
+        const auto u8String = makeMixedString(sequences, 1000);
+        std::wstring u16Out;
+        VERIFY_SUCCEEDED(til::u8u16(u8String, u16Out));
+        VERIFY_ARE_EQUAL(platformU8U16(u8String), u16Out);
+    }
+
+    Log::Comment(L"Splitting valid input into arbitrary chunks shouldn't change the result.");
+    const auto u8String = makeMixedString(valid, 1000);
+    const auto expected = platformU8U16(u8String);
+    for (const size_t chunkSize : { 1, 7, 16, 33, 4096 })
+    {
+        til::u8state state;
+        std::wstring u16Out;
+        std::wstring u16Chunk;
+        for (size_t i = 0; i < u8String.size(); i += chunkSize)
+        {
+            VERIFY_SUCCEEDED(til::u8u16(std::string_view{ u8String }.substr(i, chunkSize), u16Chunk, state));
+            u16Out.append(u16Chunk);
+        }
+        VERIFY_ARE_EQUAL(expected, u16Out);
+    }
+}
+
+void Utf8Utf16ConvertTests::TestU16ToU8MatchesPlatform()
+{
+    const std::vector<std::wstring> valid{
+        L"\u00f6", // LATIN SMALL LETTER O WITH DIAERESIS
+        L"\u0416", // CYRILLIC CAPITAL LETTER ZHE
+        L"\u2500", // BOX DRAWINGS LIGHT HORIZONTAL
+        L"\u4e2d", // CJK UNIFIED IDEOGRAPH-4E2D
+        L"\xD83D\xDCF7", // CAMERA (surrogate pair)
+    };
+    auto invalid = valid;
+    invalid.insert(invalid.end(), {
+                                      L"\xD83D", // lone high surrogate
+                                      L"\xDCF7", // lone low surrogate
+                                      L"\xDCF7\xD83D", // reversed surrogate pair
+                                  });
+
+    Log::Comment(L"Valid and invalid input should be converted exactly like WideCharToMultiByte does.");
+    for (const auto& sequences : { valid, invalid })
+    {
+        const auto u16String = makeMixedString(sequences, 1000);
+        std::string u8Out;
+        VERIFY_SUCCEEDED(til::u16u8(u16String, u8Out));
+        VERIFY_ARE_EQUAL(platformU16U8(u16String), u8Out);
+    }
+
+    Log::Comment(L"Splitting valid input into arbitrary chunks shouldn't change the result.");
+    const auto u16String = makeMixedString(valid, 1000);
+    const auto expected = platformU16U8(u16String);
+    for (const size_t chunkSize : { 1, 7, 16, 33, 4096 })
+    {
+        til::u16state state;
+        std::string u8Out;
+        std::string u8Chunk;
+        for (size_t i = 0; i < u16String.size(); i += chunkSize)
+        {
+            VERIFY_SUCCEEDED(til::u16u8(std::wstring_view{ u16String }.substr(i, chunkSize), u8Chunk, state));
+            u8Out.append(u8Chunk);
+        }
+        VERIFY_ARE_EQUAL(expected, u8Out);
+    }
+}
+
+void Utf8Utf16ConvertTests::ConversionThroughput()
+{
+    // Typical terminal output: mostly VT sequences and ASCII text, with the occasional
+    // box drawing character, followed by text that's mostly non-ASCII (Cyrillic).
+    const auto u16Terminal = makeMixedString<wchar_t>({ L"\u2500", L"\u2502", L"\u00f6" }, 100000);
+    const auto u16Cyrillic = makeMixedString<wchar_t>({ std::wstring(20, L'\u0416') }, 100000);
+
+    const auto measure = [](const wchar_t* name, auto&& func) {
+        static constexpr auto iterations = 20;
+        size_t bytes = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (auto i = 0; i < iterations; ++i)
+        {
+            bytes += func();
+        }
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        Log::Comment(String().Format(L"%-32s %8.1f MB/s", name, bytes / elapsed / 1e6));
+    };
+
+    for (const auto& u16String : { u16Terminal, u16Cyrillic })
+    {
+        const auto u8String = platformU16U8(u16String);
+        std::string u8Out;
+        std::wstring u16Out;
+
+        measure(L"WideCharToMultiByte", [&]() {
+            return platformU16U8(u16String).size();
+        });
+        measure(L"til::u16u8", [&]() {
+            THROW_IF_FAILED(til::u16u8(u16String, u8Out));
+            return u8Out.size();
+        });
+        measure(L"MultiByteToWideChar", [&]() {
+            platformU8U16(u8String);
+            return u8String.size();
+        });
+        measure(L"til::u8u16", [&]() {
+            THROW_IF_FAILED(til::u8u16(u8String, u16Out));
+            return u8String.size();
+        });
+
+        VERIFY_ARE_EQUAL(u8String, u8Out);
+        VERIFY_ARE_EQUAL(u16String, u16Out);
+    }
+}
@@ -15,6 +15,59 @@ static constexpr long _RemoveAlpha(COLORREF color) noexcept
     return color & 0x00ffffff;
 }
 
+// Calls func(y, columnBegin, columnEnd, attr) for each attribute run covering the cells from first
+// to last (inclusive, in buffer order), clipped to the given bounds. Visits the runs in reverse if
+// backwards is true and stops as soon as func returns false. This allows us to check the attributes
+// of an entire run at once, instead of iterating over each cell with a TextBufferCellIterator.
+template<typename T>
+static void _ForEachAttributeRun(const TextBuffer& buffer, const til::point first, const til::point last, const Viewport& bounds, const bool backwards, T&& func)
+{
+    const auto width = buffer.GetSize().Width();
+    const auto top = std::max(first.y, bounds.Top());
+    const auto bottom = std::min(last.y, bounds.BottomInclusive());
+
+    for (auto i = top; i <= bottom; ++i)
+    {
+        const auto y = backwards ? bottom - (i - top) : i;
+        const auto rowBegin = std::max(y == first.y ? first.x : 0, bounds.Left());
+        const auto rowEnd = std::min(y == last.y ? last.x + 1 : width, bounds.RightExclusive());
+        if (rowBegin >= rowEnd)
+        {
+            continue;
+        }
+
+        const auto& attributes = buffer.GetRowByOffset(y).Attributes();
+        const auto& runs = attributes.runs();
+
+        if (!backwards)
+        {
+            til::CoordType runBegin = 0;
+            for (auto it = runs.begin(); it != runs.end() && runBegin < rowEnd; ++it)
+            {
+                const auto runEnd = runBegin + it->length;
+                if (runEnd > rowBegin && !func(y, std::max(runBegin, rowBegin), std::min(runEnd, rowEnd), it->value))
+                {
+                    return;
+                }
+                runBegin = runEnd;
+            }
+        }
+        else
+        {
+            til::CoordType runEnd = attributes.size();
+            for (auto it = runs.rbegin(); it != runs.rend() && runEnd > rowBegin; ++it)
+            {
+                const auto runBegin = runEnd - it->length;
+                if (runBegin < rowEnd && !func(y, std::max(runBegin, rowBegin), std::min(runEnd, rowEnd), it->value))
+                {
+                    return;
+                }
+                runEnd = runBegin;
+            }
+        }
+    }
+}
+
 // degenerate range constructor.
 #pragma warning(suppress : 26434) // WRL RuntimeClassInitialize base is a no-op and we need this for MakeAndInitialize
 HRESULT UiaTextRangeBase::RuntimeClassInitialize(_In_ Render::IRenderData* pData, _In_ IRawElementProviderSimple* const pProvider, _In_ std::wstring_view wordDelimiters) noexcept
@@ -500,42 +553,8 @@ try
     //       We'll do some post-processing to fix this on the way out.
     std::optional<til::point> resultFirstAnchor;
     std::optional<til::point> resultSecondAnchor;
-    const auto attemptUpdateAnchors = [=, &resultFirstAnchor, &resultSecondAnchor](const TextBufferCellIterator iter) {
-        const auto attrFound{ _verifyAttr(attributeId, val, iter->TextAttr()).value() };
-        if (attrFound)
-        {
-            // populate the first anchor if it's not populated.
-            // otherwise, populate the second anchor.
-            if (!resultFirstAnchor.has_value())
-            {
-                resultFirstAnchor = iter.Pos();
-                resultSecondAnchor = iter.Pos();
-            }
-            else
-            {
-                resultSecondAnchor = iter.Pos();
-            }
-        }
-        return attrFound;
-    };
 
-    // Start/End for the direction to perform the search in
-    // We need searchEnd to be exclusive. This allows the for-loop below to
-    // iterate up until the exclusive searchEnd, and not attempt to read the
-    // data at that position.
-    const auto searchStart{ searchBackwards ? inclusiveEnd : _start };
-    const auto searchEndInclusive{ searchBackwards ? _start : inclusiveEnd };
-    auto searchEndExclusive{ searchEndInclusive };
-    if (searchBackwards)
-    {
-        bufferSize.DecrementInBounds(searchEndExclusive, true);
-    }
-    else
-    {
-        bufferSize.IncrementInBounds(searchEndExclusive, true);
-    }
-
-    // Iterate from searchStart to searchEnd in the buffer.
+    // Iterate over the attribute runs from _start to inclusiveEnd in the search direction.
     // If we find the attribute we're looking for, we update resultFirstAnchor/SecondAnchor appropriately.
 #pragma warning(suppress : 26496) // TRANSITIONAL: false positive in VS 16.11
     auto viewportRange{ bufferSize };
@@ -547,28 +566,25 @@ try
         const auto height{ std::abs(inclusiveEnd.y - _start.y + 1) };
         viewportRange = Viewport::FromDimensions({ originX, originY }, width, height);
     }
-    auto iter{ buffer.GetCellDataAt(searchStart, viewportRange) };
-    const auto iterStep{ searchBackwards ? -1 : 1 };
-    for (; iter && iter.Pos() != searchEndExclusive; iter += iterStep)
-    {
-        if (!attemptUpdateAnchors(iter) && resultFirstAnchor.has_value() && resultSecondAnchor.has_value())
+    _ForEachAttributeRun(buffer, _start, inclusiveEnd, viewportRange, searchBackwards, [&](const til::CoordType y, const til::CoordType begin, const til::CoordType end, const TextAttribute& attr) {
+        if (!_verifyAttr(attributeId, val, attr).value())
         {
-            // Exit the loop early if...
-            // - the cell we're looking at doesn't have the attr we're looking for
-            // - the anchors have been populated
+            // Exit the loop early if the anchors have been populated.
             // This means that we've found a contiguous range where the text attribute was found.
             // No point in searching through the rest of the search space.
             // TLDR: keep updating the second anchor and make the range wider until the attribute changes.
-            break;
+            return !resultFirstAnchor.has_value();
         }
-    }
 
-    // Corner case: we couldn't actually move the searchEnd to make it exclusive
-    // (i.e. DecrementInBounds on Origin doesn't move it)
-    if (searchEndInclusive == searchEndExclusive)
-    {
-        attemptUpdateAnchors(iter);
-    }
+        // populate the first anchor if it's not populated.
+        // otherwise, populate the second anchor.
+        if (!resultFirstAnchor.has_value())
+        {
+            resultFirstAnchor = til::point{ searchBackwards ? end - 1 : begin, y };
+        }
+        resultSecondAnchor = til::point{ searchBackwards ? begin : end - 1, y };
+        return true;
+    });
 
     // If a result was found, populate ppRetVal with the UiaTextRange
     // representing the found selection anchors.
@@ -806,18 +822,19 @@ try
         const auto height{ std::abs(inclusiveEnd.y - _start.y + 1) };
         viewportRange = Viewport::FromDimensions({ originX, originY }, width, height);
     }
-    auto iter{ buffer.GetCellDataAt(_start, viewportRange) };
-    for (; iter && iter.Pos() != inclusiveEnd; ++iter)
+    auto mixed = false;
+    _ForEachAttributeRun(buffer, _start, inclusiveEnd, viewportRange, false, [&](const til::CoordType, const til::CoordType, const til::CoordType, const TextAttribute& attr) {
+        mixed = !_verifyAttr(attributeId, *pRetVal, attr).value();
+        return !mixed;
+    });
+    if (mixed)
     {
-        if (!_verifyAttr(attributeId, *pRetVal, iter->TextAttr()).value())
-        {
-            // The value of the specified attribute varies over the text range
-            // return UiaGetReservedMixedAttributeValue.
-            // Source: https://docs.microsoft.com/en-us/windows/win32/api/uiautomationcore/nf-uiautomationcore-itextrangeprovider-getattributevalue
-            pRetVal->vt = VT_UNKNOWN;
-            UiaTracing::TextRange::GetAttributeValue(*this, attributeId, *pRetVal, UiaTracing::AttributeType::Mixed);
-            return UiaGetReservedMixedAttributeValue(&pRetVal->punkVal);
-        }
+        // The value of the specified attribute varies over the text range
+        // return UiaGetReservedMixedAttributeValue.
+        // Source: https://docs.microsoft.com/en-us/windows/win32/api/uiautomationcore/nf-uiautomationcore-itextrangeprovider-getattributevalue
+        pRetVal->vt = VT_UNKNOWN;
+        UiaTracing::TextRange::GetAttributeValue(*this, attributeId, *pRetVal, UiaTracing::AttributeType::Mixed);
+        return UiaGetReservedMixedAttributeValue(&pRetVal->punkVal);
     }
 
     UiaTracing::TextRange::GetAttributeValue(*this, attributeId, *pRetVal);
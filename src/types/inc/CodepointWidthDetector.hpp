@@ -30,6 +30,8 @@ public:
 
 private:
     uint8_t _lookupGlyphWidth(char32_t codepoint, const std::wstring_view& glyph) noexcept;
+    static uint8_t _lookupStageTables(char32_t codepoint) noexcept;
+    static uint8_t _lookupRangeTable(char32_t codepoint) noexcept;
     uint8_t _checkFallbackViaCache(char32_t codepoint, const std::wstring_view& glyph) noexcept;
 
     std::unordered_map<char32_t, uint8_t> _fallbackCache;
@@ -7,7 +7,8 @@
 ################################################################################
 # This script generates the an array suitable for replacing the body of
 # src/types/CodepointWidthDetector.cpp from a Unicode UCD XML document[1]
-# compliant with UAX#42[2].
+# compliant with UAX#42[2]. It's followed by the same data in the form of a
+# three-stage lookup table, which is what CodepointWidthDetector actually uses.
 #
 # This script supports a quasi-mandatory "overrides" file, overrides.xml.
 # If you do not have overrides, supply the -NoOverrides parameter. This was
@@ -150,6 +151,40 @@ Class UnicodeRange : System.IComparable {
     }
 }
 
+# Stage Table Functions {{{
+Function Get-DeduplicatedBlocks([int[]]$Values, [int]$BlockSize) {
+    # Splits $Values into blocks of $BlockSize and returns the unique blocks
+    # concatenated, as well as the index of the unique block for each block.
+    $indices = [System.Collections.Generic.List[int]]::New($Values.Length / $BlockSize)
+    $blocks = [System.Collections.Generic.List[int]]::New()
+    $seen = @{}
+    For ($i = 0; $i -lt $Values.Length; $i += $BlockSize) {
+        $block = [int[]]$Values[$i..($i + $BlockSize - 1)]
+        $key = $block -join ","
+        $index = $seen[$key]
+        If ($null -eq $index) {
+            $index = $seen.Count
+            $seen[$key] = $index
+            $blocks.AddRange($block)
+        }
+        $indices.Add($index)
+    }
+    [PSCustomObject]@{ Indices = $indices.ToArray(); Blocks = $blocks.ToArray() }
+}
+
+Function Format-StageTable([string]$Name, [int[]]$Values) {
+    If (($Values | Measure-Object -Maximum).Maximum -gt 255) {
+        throw "$Name doesn't fit into uint8_t anymore; the block sizes need to be adjusted"
+    }
+    "    static constexpr std::array<uint8_t, {0}> {1}{{" -f $Values.Length, $Name
+    For ($i = 0; $i -lt $Values.Length; $i += 16) {
+        $line = $Values[$i..([Math]::Min($i + 15, $Values.Length - 1))] | ForEach-Object { "0x{0:x2}," -f $_ }
+        "        " + ($line -join " ")
+    }
+    "    };"
+}
+# }}}
+
 Class UnicodeRangeList : System.Collections.Generic.List[Object] {
     UnicodeRangeList([int]$Capacity) : base($Capacity) { }
 
@@ -274,3 +309,26 @@ ForEach($_ in $ranges) {
 "        UnicodeRange{{ 0x{0:x}, 0x{1:x}, {2} }},{3}" -f $_.Start, $_.End, [int]$isAmbiguous, $comment
 }
 "    };"
+
+# The values are those of the CodepointWidth enum in src/types/inc/convert.hpp (Ambiguous = 0, Narrow = 1, Wide = 2).
+$widths = [int[]]::New(0x110000)
+[Array]::Fill($widths, 1)
+ForEach($_ in $ranges) {
+    $w = $_.Width -eq [CodepointWidth]::Ambiguous ? 0 : 2
+    For ($i = $_.Start; $i -le $_.End; $i++) {
+        $widths[$i] = $w
+    }
+}
+
+$stage3 = Get-DeduplicatedBlocks $widths 16
+$stage2 = Get-DeduplicatedBlocks $stage3.Indices 64
+$stage1 = $stage2.Indices
+
+""
+"    // The same data as s_wideAndAmbiguousTable, but as a three-stage lookup table, indexed by:"
+"    //   s_stage3[s_stage2[s_stage1[cp >> 10] * 64 + ((cp >> 4) & 63)] * 16 + (cp & 15)]"
+"    // Each stage stores block indices into the next one. The values in s_stage3 are CodepointWidth values."
+"    // {0} (0x{0:X}) bytes total." -f ($stage1.Length + $stage2.Blocks.Length + $stage3.Blocks.Length)
+Format-StageTable "s_stage1" $stage1
+Format-StageTable "s_stage2" $stage2.Blocks
+Format-StageTable "s_stage3" $stage3.Blocks